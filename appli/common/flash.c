@@ -12,6 +12,7 @@
 #define FLASH_ADDRESS_BEGIN	0x70000
 #define FLASH_SIZE			0x10000
 #define FLASH_ADDRESS_END	(FLASH_ADDRESS_BEGIN+FLASH_SIZE)
+#define FLASH_PAGE_SIZE		0x1000
 
 
 uint32_t err_code;
@@ -81,5 +82,29 @@ void FLASHWRITER_erase(uint32_t address){
 	rc = nrf_fstorage_erase(&m_fs, FLASH_ADDRESS_BEGIN+address, 4, 0);
 }
 
+/*
+ * Ecriture sans effacement pralable : seuls des bits  1 peuvent passer  0.
+ * address doit tre multiple de 4.
+ */
+running_e FLASHWRITER_program(uint32_t address, uint32_t value)
+{
+	if(address < FLASH_SIZE)
+		rc = nrf_fstorage_write(&m_fs, FLASH_ADDRESS_BEGIN+address, &value, 4, 0);
+
+	running_e ret = END_ERROR;
+	if(FLASHWRITER_read(address) == value)
+		ret = END_OK;
+	return ret;
+}
+
+/*
+ * Efface la page (FLASH_PAGE_SIZE octets) qui contient address.
+ */
+void FLASHWRITER_erase_page(uint32_t address)
+{
+	if(address < FLASH_SIZE)
+		rc = nrf_fstorage_erase(&m_fs, FLASH_ADDRESS_BEGIN+(address & ~(FLASH_PAGE_SIZE-1)), 1, 0);
+}
+
 
 
@@ -18,6 +18,10 @@ running_e FLASHWRITER_write(uint32_t address, uint32_t value);
 
 void FLASHWRITER_erase(uint32_t address);
 
+running_e FLASHWRITER_program(uint32_t address, uint32_t value);
+
+void FLASHWRITER_erase_page(uint32_t address);
+
 
 
 #endif /* SRC_FLASHWRITER_H_ */
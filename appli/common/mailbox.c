@@ -0,0 +1,377 @@
+/*
+ * mailbox.c
+ *
+ *  Created on: 17 oct. 2026
+ */
+#include <string.h>
+#include "../config.h"
+#include "mailbox.h"
+#include "systick.h"
+#include "rf_dialog.h"
+#include "registry.h"
+#include "flash.h"
+
+#if USE_MAILBOX
+
+typedef struct
+{
+	bool_e used;
+	uint16_t seq;				//ordre d'arrive : les messages d'un mme objet lui sont dlivrs dans cet ordre
+	uint32_t recipient;
+	uint32_t time;				//[ms] instant de rception sur l'UART
+	bool_e in_ack;				//plac dans l'acquittement du pipe de son destinataire, en attente de son ACK
+	uint8_t size;
+	uint8_t datas[NRF_ESB_MAX_PAYLOAD_LENGTH];	//trame complte (entte complet)
+}mailbox_msg_t;
+
+static mailbox_msg_t msgs[MAILBOX_SLOTS_NB];
+static uint8_t msgs_nb = 0;
+static uint16_t next_seq = 0;
+static mailbox_stats_t stats;
+
+static mailbox_msg_t * MAILBOX_get_oldest(uint32_t device_id, bool_e any_device);
+static bool_e MAILBOX_is_sleeping(uint32_t device_id);
+
+#if USE_RF_ACK_PAYLOAD
+static uint32_t ack_pipe_owners[RF_DIALOG_PIPE_ACK_LAST + 1];		//objet auquel chaque pipe d'acquittement est attribu (0 : libre)
+static mailbox_msg_t * ack_in_flight[RF_DIALOG_PIPE_ACK_LAST + 1];	//message plac dans l'acquittement de ce pipe
+
+static uint8_t MAILBOX_get_ack_pipe(uint32_t device_id, bool_e assign);
+static void MAILBOX_place_in_ack(uint8_t pipe);
+static bool_e MAILBOX_flush_in_ack(rf_frame_t * frame);
+#endif
+
+#if USE_MAILBOX_FLASH_SPILL
+//Enregistrement en flash : ENTETE = [MAGIC ETAT SIZE 0xFF] (mot de poids fort en premier), puis la trame.
+//Une page efface ne contient que des 1 : l'ETAT passe de MAILBOX_FLASH_PENDING  MAILBOX_FLASH_DELIVERED sans effacement.
+#define MAILBOX_FLASH_MAGIC			0xA5
+#define MAILBOX_FLASH_PENDING		0xFF
+#define MAILBOX_FLASH_DELIVERED		0x00
+
+static uint8_t flash_write_index;		//premier enregistrement libre de la page
+static uint8_t flash_pending_nb;
+
+static void MAILBOX_flash_init(void);
+static bool_e MAILBOX_flash_store(mailbox_msg_t * msg);
+static void MAILBOX_flash_flush(uint32_t device_id);
+#endif
+
+void MAILBOX_init(void)
+{
+	for(uint8_t i = 0; i < MAILBOX_SLOTS_NB; i++)
+		msgs[i].used = FALSE;
+	msgs_nb = 0;
+	stats = (mailbox_stats_t){0};
+#if USE_RF_ACK_PAYLOAD
+	for(uint8_t pipe = 0; pipe <= RF_DIALOG_PIPE_ACK_LAST; pipe++)
+	{
+		ack_pipe_owners[pipe] = 0;
+		ack_in_flight[pipe] = NULL;
+	}
+#endif
+#if USE_MAILBOX_FLASH_SPILL
+	MAILBOX_flash_init();
+#endif
+}
+
+//Objet qui a annonc une radio endormie, et dont la fentre d'coute suivant sa dernire mission est passe.
+//Un objet qui a un pipe d'acquittement reoit toujours ses messages par ce biais.
+static bool_e MAILBOX_is_sleeping(uint32_t device_id)
+{
+	registry_entry_t * entry;
+#if USE_RF_ACK_PAYLOAD
+	if(MAILBOX_get_ack_pipe(device_id, FALSE) != RF_DIALOG_PIPE_FULL_HEADER)
+		return TRUE;
+#endif
+	entry = REGISTRY_find(device_id);
+	if(entry == NULL || !(entry->capabilities & RF_DIALOG_CAPABILITY_SLEEPY))
+		return FALSE;
+	return (SYSTICK_get_time_ms() - entry->last_seen > MAILBOX_AWAKE_WINDOW)?TRUE:FALSE;
+}
+
+//Le plus ancien message en attente pour device_id (ou pour n'importe quel objet), hors messages dj placs dans un acquittement.
+//Les messages prims sont abandonns au passage.
+static mailbox_msg_t * MAILBOX_get_oldest(uint32_t device_id, bool_e any_device)
+{
+	mailbox_msg_t * oldest = NULL;
+	uint32_t now = SYSTICK_get_time_ms();
+
+	for(uint8_t i = 0; i < MAILBOX_SLOTS_NB; i++)
+	{
+		if(!msgs[i].used || msgs[i].in_ack)
+			continue;
+		if(now - msgs[i].time > MAILBOX_MAX_AGE)
+		{
+			msgs[i].used = FALSE;
+			msgs_nb--;
+			stats.expired_nb++;
+			continue;
+		}
+		if(!any_device && msgs[i].recipient != device_id)
+			continue;
+		if(oldest == NULL || (int16_t)(msgs[i].seq - oldest->seq) < 0)
+			oldest = &msgs[i];
+	}
+	return oldest;
+}
+
+//Message du serveur (reu sur l'UART) pour un autre que nous. Renvoie TRUE s'il est gard : il ne doit alors pas tre relay maintenant.
+bool_e MAILBOX_store(rf_frame_t * frame)
+{
+	mailbox_msg_t * msg = NULL;
+#if USE_RF_ACK_PAYLOAD
+	uint8_t pipe;
+#endif
+
+	if(RF_DIALOG_IS_MULTICAST(frame->recipient) || frame->payload == NULL)
+		return FALSE;
+	if(!MAILBOX_is_sleeping(frame->recipient))
+		return FALSE;
+	for(uint8_t i = 0; i < MAILBOX_SLOTS_NB; i++)
+	{
+		if(!msgs[i].used)
+		{
+			msg = &msgs[i];
+			break;
+		}
+	}
+	if(msg == NULL)
+	{
+		//RAM pleine : le plus ancien message laisse sa place
+		msg = MAILBOX_get_oldest(0, TRUE);
+		if(msg == NULL)
+			return FALSE;	//impossible
+#if USE_MAILBOX_FLASH_SPILL
+		if(MAILBOX_flash_store(msg))
+			stats.spilled_nb++;
+		else
+#endif
+			stats.dropped_nb++;
+		msg->used = FALSE;
+		msgs_nb--;
+	}
+	msg->used = TRUE;
+	msg->in_ack = FALSE;
+	msg->seq = next_seq++;
+	msg->recipient = frame->recipient;
+	msg->time = SYSTICK_get_time_ms();
+	msg->size = MIN(frame->payload->length, NRF_ESB_MAX_PAYLOAD_LENGTH);
+	memcpy(msg->datas, frame->payload->data, msg->size);
+	msgs_nb++;
+	stats.stored_nb++;
+#if USE_RF_ACK_PAYLOAD
+	pipe = MAILBOX_get_ack_pipe(frame->recipient, FALSE);
+	if(pipe != RF_DIALOG_PIPE_FULL_HEADER && ack_in_flight[pipe] == NULL)
+		MAILBOX_place_in_ack(pipe);	//l'acquittement est prt : la prochaine trame de l'objet le recevra, sans attendre celle d'aprs
+#endif
+	return TRUE;
+}
+
+//Appele  chaque trame reue par radio : son metteur coute, on lui envoie ce qui l'attend (en priorit REPLY, juste aprs sa trame).
+//Sur son pipe d'acquittement, c'est l'acquittement de sa prochaine trame qui lui apporte le message suivant.
+void MAILBOX_flush(rf_frame_t * frame)
+{
+	mailbox_msg_t * msg;
+	uint32_t device_id = frame->emitter;
+
+#if USE_MAILBOX_FLASH_SPILL
+	if(flash_pending_nb)
+		MAILBOX_flash_flush(device_id);	//les messages recopis en flash sont les plus anciens
+#endif
+#if USE_RF_ACK_PAYLOAD
+	if(MAILBOX_flush_in_ack(frame))
+		return;
+#endif
+	while(msgs_nb)
+	{
+		msg = MAILBOX_get_oldest(device_id, FALSE);
+		if(msg == NULL)
+			break;
+		if(!SECRETARY_send_msg_with_priority(TX_PRIORITY_REPLY, msg->size, msg->datas))
+			break;	//file d'mission pleine : la suite attendra la prochaine trame de l'objet
+		msg->used = FALSE;
+		msgs_nb--;
+		stats.delivered_nb++;
+	}
+}
+
+void MAILBOX_get_stats(mailbox_stats_t * s)
+{
+	if(s != NULL)
+		*s = stats;
+}
+
+#if USE_RF_ACK_PAYLOAD
+//Pipe d'acquittement de device_id (RF_DIALOG_PIPE_FULL_HEADER : aucun). Si assign, un objet endormi qui n'en a pas en reoit un :
+//un pipe libre, sinon celui d'un objet silencieux depuis plus de MAILBOX_MAX_AGE. L'ancien propritaire dort : il n'apprend
+//la reprise qu' sa prochaine trame sur ce pipe (voir MAILBOX_flush_in_ack).
+static uint8_t MAILBOX_get_ack_pipe(uint32_t device_id, bool_e assign)
+{
+	registry_entry_t * entry;
+	registry_entry_t * owner;
+	uint8_t pipe;
+	uint8_t found = RF_DIALOG_PIPE_FULL_HEADER;
+
+	for(pipe = RF_DIALOG_PIPE_ACK_FIRST; pipe <= RF_DIALOG_PIPE_ACK_LAST; pipe++)
+		if(ack_pipe_owners[pipe] == device_id)
+			return pipe;
+	if(!assign)
+		return RF_DIALOG_PIPE_FULL_HEADER;
+	entry = REGISTRY_find(device_id);
+	if(entry == NULL || !(entry->capabilities & RF_DIALOG_CAPABILITY_SLEEPY))
+		return RF_DIALOG_PIPE_FULL_HEADER;
+	for(pipe = RF_DIALOG_PIPE_ACK_FIRST; pipe <= RF_DIALOG_PIPE_ACK_LAST && found == RF_DIALOG_PIPE_FULL_HEADER; pipe++)
+	{
+		owner = REGISTRY_find(ack_pipe_owners[pipe]);
+		if(ack_pipe_owners[pipe] == 0 || owner == NULL || SYSTICK_get_time_ms() - owner->last_seen > MAILBOX_MAX_AGE)
+			found = pipe;
+	}
+	if(found == RF_DIALOG_PIPE_FULL_HEADER)
+		return RF_DIALOG_PIPE_FULL_HEADER;	//tous les pipes sont pris : l'objet reoit ses messages dans sa fentre d'coute
+	if(ack_in_flight[found] != NULL)
+	{
+		ack_in_flight[found]->in_ack = FALSE;	//le message de l'ancien propritaire reste en attente
+		ack_in_flight[found] = NULL;
+	}
+	SECRETARY_set_ack_payload(found, 0, NULL);
+	ack_pipe_owners[found] = device_id;
+	return found;
+}
+
+//Place le plus ancien message en attente du propritaire du pipe dans l'acquittement de ce pipe (aucun : l'acquittement redevient vide).
+//La trame y est rpte jusqu' son remplacement : l'objet confirme sa rception par un ACK [MSG_CNT MSG_ID], qu'on lui demande.
+static void MAILBOX_place_in_ack(uint8_t pipe)
+{
+	mailbox_msg_t * msg;
+	uint8_t datas[NRF_ESB_MAX_PAYLOAD_LENGTH];
+
+	msg = MAILBOX_get_oldest(ack_pipe_owners[pipe], FALSE);
+	if(msg == NULL || msg->size <= BYTE_POS_DATASIZE)
+	{
+		SECRETARY_set_ack_payload(pipe, 0, NULL);
+		return;
+	}
+	msg->in_ack = TRUE;
+	ack_in_flight[pipe] = msg;
+	memcpy(datas, msg->datas, msg->size);
+	datas[BYTE_POS_DATASIZE] |= DATASIZE_FLAG_ACK_REQUEST;	//avant le scellement : le drapeau est couvert par le MIC
+	SECRETARY_set_ack_payload(pipe, msg->size, datas);
+}
+
+//Renvoie TRUE si l'objet reoit ses messages par son pipe d'acquittement (la remise normale n'a alors pas lieu).
+static bool_e MAILBOX_flush_in_ack(rf_frame_t * frame)
+{
+	mailbox_msg_t * msg;
+	uint8_t pipe;
+
+	pipe = MAILBOX_get_ack_pipe(frame->emitter, TRUE);
+	if(pipe == RF_DIALOG_PIPE_FULL_HEADER)
+	{
+		if(frame->payload != NULL && frame->payload->pipe >= RF_DIALOG_PIPE_ACK_FIRST && frame->payload->pipe <= RF_DIALOG_PIPE_ACK_LAST)
+			RF_DIALOG_send_msg_id_to_object(frame->emitter, ACK_PIPE_IS, 1, &pipe);	//son pipe a t repris pendant son silence : il n'en a plus
+		return FALSE;
+	}
+	msg = ack_in_flight[pipe];
+	if(msg != NULL && frame->msg_id == ACK && frame->datasize >= 2
+			&& frame->datas[0] == msg->datas[BYTE_POS_MSG_CNT] && frame->datas[1] == msg->datas[BYTE_POS_MSG_ID])
+	{
+		//l'objet a bien reu le message plac dans l'acquittement : le suivant prend sa place
+		msg->used = FALSE;
+		ack_in_flight[pipe] = NULL;
+		msgs_nb--;
+		stats.delivered_nb++;
+		MAILBOX_place_in_ack(pipe);
+	}
+	if(frame->payload == NULL || frame->payload->pipe != pipe)
+	{
+		//l'objet ne connait pas (encore) son pipe, ou met sur un pipe repris pendant son silence : on le lui indique, juste aprs sa trame
+		RF_DIALOG_send_msg_id_to_object(frame->emitter, ACK_PIPE_IS, 1, &pipe);
+		return FALSE;
+	}
+	if(ack_in_flight[pipe] == NULL)
+		MAILBOX_place_in_ack(pipe);
+	return TRUE;
+}
+#endif
+
+#if USE_MAILBOX_FLASH_SPILL
+static uint32_t MAILBOX_flash_record_address(uint8_t index)
+{
+	return MAILBOX_FLASH_ADDRESS + (uint32_t)index * MAILBOX_FLASH_RECORD_SIZE;
+}
+
+//Retrouve la position d'criture et le nombre de messages en attente (conservs  travers un reset de la station).
+static void MAILBOX_flash_init(void)
+{
+	uint32_t header;
+
+	flash_write_index = 0;
+	flash_pending_nb = 0;
+	for(uint8_t i = 0; i < MAILBOX_FLASH_RECORDS_NB; i++)
+	{
+		header = FLASHWRITER_read(MAILBOX_flash_record_address(i));
+		if((header >> 24) != MAILBOX_FLASH_MAGIC)
+			break;
+		flash_write_index = i + 1;
+		if(((header >> 16) & 0xFF) == MAILBOX_FLASH_PENDING)
+			flash_pending_nb++;
+	}
+}
+
+static bool_e MAILBOX_flash_store(mailbox_msg_t * msg)
+{
+	uint32_t address;
+	uint32_t word;
+
+	if(flash_write_index >= MAILBOX_FLASH_RECORDS_NB)
+	{
+		if(flash_pending_nb)
+			return FALSE;	//page pleine de messages non dlivrs
+		FLASHWRITER_erase_page(MAILBOX_FLASH_ADDRESS);	//tout a t dlivr : on recommence au dbut de la page
+		flash_write_index = 0;
+	}
+	address = MAILBOX_flash_record_address(flash_write_index);
+	for(uint8_t i = 0; i < NRF_ESB_MAX_PAYLOAD_LENGTH; i += 4)
+	{
+		memcpy(&word, &msg->datas[i], 4);
+		FLASHWRITER_program(address + 4 + i, word);
+	}
+	//l'entte est crit en dernier : un enregistrement interrompu n'est pas pris pour un message
+	FLASHWRITER_program(address, ((uint32_t)MAILBOX_FLASH_MAGIC << 24) | ((uint32_t)MAILBOX_FLASH_PENDING << 16) | ((uint32_t)msg->size << 8) | 0xFF);
+	flash_write_index++;
+	flash_pending_nb++;
+	return TRUE;
+}
+
+static void MAILBOX_flash_flush(uint32_t device_id)
+{
+	uint8_t datas[NRF_ESB_MAX_PAYLOAD_LENGTH];
+	uint32_t address;
+	uint32_t header;
+	uint32_t word;
+	uint8_t size;
+
+	for(uint8_t i = 0; i < flash_write_index && flash_pending_nb; i++)
+	{
+		address = MAILBOX_flash_record_address(i);
+		header = FLASHWRITER_read(address);
+		if(((header >> 16) & 0xFF) != MAILBOX_FLASH_PENDING)
+			continue;
+		for(uint8_t j = 0; j < NRF_ESB_MAX_PAYLOAD_LENGTH; j += 4)
+		{
+			word = FLASHWRITER_read(address + 4 + j);
+			memcpy(&datas[j], &word, 4);
+		}
+		if(U32FROMU8(datas[BYTE_POS_RECIPIENTS], datas[BYTE_POS_RECIPIENTS+1], datas[BYTE_POS_RECIPIENTS+2], datas[BYTE_POS_RECIPIENTS+3]) != device_id)
+			continue;
+		size = MIN((header >> 8) & 0xFF, NRF_ESB_MAX_PAYLOAD_LENGTH);
+		if(!SECRETARY_send_msg_with_priority(TX_PRIORITY_REPLY, size, datas))
+			return;
+		FLASHWRITER_program(address, header & ~((uint32_t)0xFF << 16));	//ETAT -> MAILBOX_FLASH_DELIVERED
+		flash_pending_nb--;
+		stats.delivered_nb++;
+	}
+}
+#endif
+
+#endif
@@ -0,0 +1,57 @@
+/*
+ * mailbox.h
+ *
+ *  Created on: 17 oct. 2026
+ */
+
+#ifndef APPLI_COMMON_MAILBOX_H_
+#define APPLI_COMMON_MAILBOX_H_
+
+#include "../config.h"
+#include "macro_types.h"
+#include "secretary.h"
+
+/*
+ * Bote aux lettres (station de base) pour les objets dont la radio dort (RF_DIALOG_CAPABILITY_SLEEPY, annonce par RECENT_RESET).
+ * 	Un message du serveur pour un tel objet, qui n'a rien mis depuis plus de MAILBOX_AWAKE_WINDOW, n'est pas relay :
+ * 	il est gard (trame complte, telle que reue sur l'UART) et envoy juste aprs la prochaine trame reue de l'objet
+ * 	(ou son RECENT_RESET). L'objet doit donc couter pendant MAILBOX_AWAKE_WINDOW aprs chacune de ses missions.
+ * 	Avec OBJECT_RADIO_SLEEPS, la secrtaire de l'objet s'en charge : sa radio est ensuite teinte jusqu' sa prochaine mission
+ * 	(elle se rveille aussi autour de l'chance de chaque beacon, voir timeslot.h ; les CHANNEL_SET ne sont entendus que dans ces fentres).
+ * 	La RAM occupe est borne (MAILBOX_SLOTS_NB messages, tous objets confondus). Quand elle est pleine, le message le plus
+ * 	ancien est recopi dans une page de flash si USE_MAILBOX_FLASH_SPILL (sinon il est perdu).
+ *
+ * 	Si USE_RF_ACK_PAYLOAD, l'objet endormi reoit aussi un pipe d'acquittement (ACK_PIPE_IS, 5 objets au plus). Il y met ses trames
+ * 	vers la station en demandant l'acquittement ESB, et la station place son plus ancien message en attente dans cet acquittement :
+ * 	commande et tlmtrie s'changent dans la mme transaction radio, et l'objet peut se rendormir ds l'acquittement reu.
+ * 	Un message ainsi plac porte DATASIZE_FLAG_ACK_REQUEST : il est rpt dans chaque acquittement du pipe jusqu' ce que
+ * 	l'objet en renvoie l'ACK [MSG_CNT MSG_ID]. Il est alors dlivr, et le suivant prend sa place.
+ */
+
+#define MAILBOX_SLOTS_NB			16
+#define MAILBOX_MAX_AGE				(3600*1000)	//[ms] un message non dlivr au bout de ce dlai est abandonn (RAM seulement)
+#define MAILBOX_AWAKE_WINDOW		50			//[ms] dure d'coute d'un objet endormi aprs chacune de ses missions
+
+#define MAILBOX_FLASH_ADDRESS		0x4000		//page de la zone FLASHWRITER, hors des 4 pages effaces par FLASHWRITER_erase() (paramtres)
+#define MAILBOX_FLASH_PAGE_SIZE		0x1000
+#define MAILBOX_FLASH_RECORD_SIZE	(4+NRF_ESB_MAX_PAYLOAD_LENGTH+4)	//[ENTETE(4) TRAME(32) BOURRAGE(4)] : 40 octets
+#define MAILBOX_FLASH_RECORDS_NB	(MAILBOX_FLASH_PAGE_SIZE/MAILBOX_FLASH_RECORD_SIZE)
+
+typedef struct
+{
+	uint32_t stored_nb;
+	uint32_t delivered_nb;
+	uint32_t expired_nb;
+	uint32_t dropped_nb;		//RAM pleine, sans place en flash
+	uint32_t spilled_nb;		//recopis en flash
+}mailbox_stats_t;
+
+void MAILBOX_init(void);
+
+bool_e MAILBOX_store(rf_frame_t * frame);
+
+void MAILBOX_flush(rf_frame_t * frame);
+
+void MAILBOX_get_stats(mailbox_stats_t * stats);
+
+#endif /* APPLI_COMMON_MAILBOX_H_ */
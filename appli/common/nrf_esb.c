@@ -179,6 +179,9 @@ static volatile uint32_t            m_wait_for_ack_timeout_us;
 
 static volatile uint32_t            m_radio_shorts_common = _RADIO_SHORTS_COMMON;
 
+// Per-pipe acknowledgment payloads (PRX), independent of the TX FIFO (see nrf_esb_set_ack_payload).
+static nrf_esb_payload_t            m_ack_payloads[NRF_ESB_PIPE_COUNT];
+
 // These function pointers are changed dynamically, depending on protocol configuration and state.
 static void (*on_radio_disabled)(void) = 0;
 static void (*on_radio_end)(void) = 0;
@@ -813,7 +816,17 @@ static void on_radio_disabled_rx(void)
         {
             case NRF_ESB_PROTOCOL_ESB_DPL:
                 {
-                    if (m_tx_fifo.count > 0 &&
+                    // The payload of the pipe goes out in every acknowledgment until it is replaced:
+                    // the PTX may have lost any of them, only the application knows when it got through.
+                    if (m_ack_payloads[NRF_RADIO->RXMATCH].length > 0)
+                    {
+                        update_rf_payload_format(m_ack_payloads[NRF_RADIO->RXMATCH].length);
+                        m_tx_payload_buffer[0] = m_ack_payloads[NRF_RADIO->RXMATCH].length;
+                        memcpy(&m_tx_payload_buffer[2],
+                               m_ack_payloads[NRF_RADIO->RXMATCH].data,
+                               m_ack_payloads[NRF_RADIO->RXMATCH].length);
+                    }
+                    else if (m_tx_fifo.count > 0 &&
                         (m_tx_fifo.p_payload[m_tx_fifo.exit_point]->pipe == NRF_RADIO->RXMATCH)
                        )
                     {
@@ -1130,6 +1143,29 @@ uint32_t nrf_esb_write_payload(nrf_esb_payload_t const * p_payload)
 }
 
 
+/* Sets the payload sent in the acknowledgments of the packets received on this pipe (length 0: none),
+ * until it is replaced. Unlike payloads written to the TX FIFO with
+ * nrf_esb_write_payload, each pipe has its own payload, so a pending payload never blocks the other pipes. */
+uint32_t nrf_esb_set_ack_payload(uint8_t pipe, uint8_t const * p_data, uint8_t length)
+{
+    VERIFY_TRUE(m_esb_initialized, NRF_ERROR_INVALID_STATE);
+    VERIFY_TRUE(pipe < NRF_ESB_PIPE_COUNT, NRF_ERROR_INVALID_PARAM);
+    VERIFY_TRUE(length <= NRF_ESB_MAX_PAYLOAD_LENGTH, NRF_ERROR_INVALID_LENGTH);
+
+    DISABLE_RF_IRQ();
+
+    if (length > 0)
+    {
+        memcpy(m_ack_payloads[pipe].data, p_data, length);
+    }
+    m_ack_payloads[pipe].length = length;
+
+    ENABLE_RF_IRQ();
+
+    return NRF_SUCCESS;
+}
+
+
 uint32_t nrf_esb_read_rx_payload(nrf_esb_payload_t * p_payload)
 {
     VERIFY_TRUE(m_esb_initialized, NRF_ERROR_INVALID_STATE);
@@ -29,6 +29,7 @@ typedef enum
 	PARAM_PLUVIOMETRY,
 	PARAM_SCREEN_COLOR,
 	PARAM_MODE,
+	PARAM_GROUPS,		//masque des groupes (RF_GROUP_MASK) dont l'objet est membre
 
 	PARAM_32_BITS_NB,	//avant ce define, tout les paramtres tiennent sur 32 bits.
 
@@ -0,0 +1,230 @@
+/*
+ * registry.c
+ *
+ *  Created on: 17 oct. 2026
+ */
+#include "../config.h"
+#include "registry.h"
+#include "systick.h"
+#include "rf_dialog.h"
+#include "parameters.h"
+
+#if USE_REGISTRY
+
+#define REGISTRY_MASK	(REGISTRY_SIZE-1)
+
+static registry_entry_t entries[REGISTRY_SIZE];
+
+static uint32_t REGISTRY_hash(uint32_t device_id);
+static registry_entry_t * REGISTRY_lookup(uint32_t device_id, bool_e create);
+
+void REGISTRY_init(void)
+{
+	for(uint8_t i = 0; i < REGISTRY_SIZE; i++)
+		entries[i] = (registry_entry_t){0};
+}
+
+//Les identifiants diffrent parfois seulement par leurs octets de poids fort (DEVICEID) ou de poids faible (OBJECT_ID) : on les mlange.
+static uint32_t REGISTRY_hash(uint32_t device_id)
+{
+	device_id ^= device_id >> 16;
+	device_id *= 0x45D9F3B;
+	device_id ^= device_id >> 16;
+	return device_id & REGISTRY_MASK;
+}
+
+static registry_entry_t * REGISTRY_lookup(uint32_t device_id, bool_e create)
+{
+	uint32_t index = REGISTRY_hash(device_id);
+	registry_entry_t * entry;
+	registry_entry_t * victim = NULL;
+	uint32_t now;
+
+	if(device_id == 0)
+		return NULL;
+	for(uint8_t i = 0; i < REGISTRY_MAX_PROBES; i++)
+	{
+		entry = &entries[(index + i) & REGISTRY_MASK];
+		if(entry->device_id == device_id)
+			return entry;
+		if(entry->device_id == 0)
+		{
+			victim = entry;
+			break;	//les entres ne sont jamais supprimes : une case libre termine la recherche
+		}
+		if(victim == NULL || (int32_t)(entry->last_seen - victim->last_seen) < 0)
+			victim = entry;
+	}
+	if(!create || victim == NULL)
+		return NULL;
+
+	now = SYSTICK_get_time_ms();
+	*victim = (registry_entry_t){0};
+	victim->device_id = device_id;
+	victim->first_seen = now;
+	return victim;
+}
+
+registry_entry_t * REGISTRY_find(uint32_t device_id)
+{
+	return REGISTRY_lookup(device_id, FALSE);
+}
+
+//Appele pour chaque trame reue par radio.
+registry_entry_t * REGISTRY_update(rf_frame_t * frame)
+{
+	registry_entry_t * entry;
+	uint8_t gap;
+
+	entry = REGISTRY_lookup(frame->emitter, TRUE);
+	if(entry == NULL)
+		return NULL;
+	if(frame->recipient == RF_DIALOG_get_my_base_station_id())
+	{
+		//les trames vers un autre destinataire (diffusion, groupe...) suivent leur propre compteur : seul le ntre rvle des pertes
+		if(entry->msg_cnt_known)
+		{
+			gap = frame->msg_cnt - entry->msg_cnt - 1;	//0 pour la trame attendue, 255 pour une rmission
+			if(gap != 0xFF && gap < REGISTRY_MAX_MSG_CNT_GAP)
+				entry->missed_nb += gap;
+		}
+		entry->msg_cnt = frame->msg_cnt;
+		entry->msg_cnt_known = TRUE;
+	}
+	entry->last_seen = SYSTICK_get_time_ms();
+	entry->rssi = frame->payload->rssi;
+	entry->rx_nb++;
+	return entry;
+}
+
+//Le rang-ime objet connu (dans l'ordre de la table), pour que le serveur puisse parcourir le registre.
+registry_entry_t * REGISTRY_get_by_rank(uint8_t rank)
+{
+	for(uint8_t i = 0; i < REGISTRY_SIZE; i++)
+	{
+		if(entries[i].device_id != 0)
+		{
+			if(rank == 0)
+				return &entries[i];
+			rank--;
+		}
+	}
+	return NULL;
+}
+
+//RECENT_RESET : DATAS = [FIRMWARE_VERSION(2) CAPABILITIES(4)] (facultatif). Les valeurs en cache sont oublies.
+void REGISTRY_report_reset(rf_frame_t * frame)
+{
+	registry_entry_t * entry;
+
+	entry = REGISTRY_lookup(frame->emitter, TRUE);
+	if(entry == NULL)
+		return;
+	if(entry->reset_nb < 0xFF)
+		entry->reset_nb++;
+	if(frame->datasize >= 6)
+	{
+		entry->firmware_version = U16FROMU8(frame->datas[0], frame->datas[1]);
+		entry->capabilities = U32FROMU8(frame->datas[2], frame->datas[3], frame->datas[4], frame->datas[5]);
+	}
+	for(uint8_t i = 0; i < REGISTRY_PARAMS_NB; i++)
+		entry->params[i].param_id = PARAM_UNKNOW;
+}
+
+void REGISTRY_cache_parameter(uint32_t device_id, uint8_t param_id, uint32_t value)
+{
+	registry_entry_t * entry;
+	registry_param_t * slot = NULL;
+
+	entry = REGISTRY_lookup(device_id, TRUE);
+	if(entry == NULL || param_id == PARAM_UNKNOW)
+		return;
+	for(uint8_t i = 0; i < REGISTRY_PARAMS_NB; i++)
+	{
+		if(entry->params[i].param_id == param_id)
+		{
+			slot = &entry->params[i];
+			break;
+		}
+		if(slot == NULL || (slot->param_id != PARAM_UNKNOW && (entry->params[i].param_id == PARAM_UNKNOW || (int32_t)(entry->params[i].time - slot->time) < 0)))
+			slot = &entry->params[i];	//case libre, sinon la plus ancienne
+	}
+	slot->param_id = param_id;
+	slot->value = value;
+	slot->time = SYSTICK_get_time_ms();
+}
+
+//Renvoie TRUE (et la valeur) si une valeur rcente du paramtre est connue.
+bool_e REGISTRY_get_cached_parameter(uint32_t device_id, uint8_t param_id, uint32_t * value)
+{
+	registry_entry_t * entry;
+
+	entry = REGISTRY_find(device_id);
+	if(entry == NULL || param_id == PARAM_UNKNOW)
+		return FALSE;
+	for(uint8_t i = 0; i < REGISTRY_PARAMS_NB; i++)
+	{
+		if(entry->params[i].param_id == param_id && SYSTICK_get_time_ms() - entry->params[i].time < REGISTRY_PARAM_MAX_AGE)
+		{
+			*value = entry->params[i].value;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+//REGISTRY_IS : [DEVICE_ID(4) AGE_S(2) RSSI RX_NB(4) MISSED_NB(2) RESET_NB FIRMWARE_VERSION(2) CAPABILITIES(4)] ; renvoie la taille.
+uint8_t REGISTRY_build_entry(registry_entry_t * entry, uint8_t * datas)
+{
+	uint32_t age_s;
+	uint8_t size = 0;
+
+	if(entry == NULL)
+		return 0;
+	age_s = (SYSTICK_get_time_ms() - entry->last_seen) / 1000;
+	if(age_s > 0xFFFF)
+		age_s = 0xFFFF;
+	datas[size++] = entry->device_id >> 24;
+	datas[size++] = entry->device_id >> 16;
+	datas[size++] = entry->device_id >> 8;
+	datas[size++] = entry->device_id;
+	datas[size++] = age_s >> 8;
+	datas[size++] = age_s;
+	datas[size++] = entry->rssi;
+	datas[size++] = entry->rx_nb >> 24;
+	datas[size++] = entry->rx_nb >> 16;
+	datas[size++] = entry->rx_nb >> 8;
+	datas[size++] = entry->rx_nb;
+	datas[size++] = entry->missed_nb >> 8;
+	datas[size++] = entry->missed_nb;
+	datas[size++] = entry->reset_nb;
+	datas[size++] = entry->firmware_version >> 8;
+	datas[size++] = entry->firmware_version;
+	datas[size++] = entry->capabilities >> 24;
+	datas[size++] = entry->capabilities >> 16;
+	datas[size++] = entry->capabilities >> 8;
+	datas[size++] = entry->capabilities;
+	return size;
+}
+
+//Demande du serveur  destination d'un objet : PARAMETER_ASK dont la valeur rcente est en cache.
+//Renvoie TRUE si la rponse a t faite sur l'UART (la demande n'a alors pas  tre relaye par radio).
+bool_e REGISTRY_answer_for_object(rf_frame_t * frame)
+{
+	uint32_t value;
+	uint8_t datas[5];
+
+	if(frame->msg_id != PARAMETER_ASK || frame->datasize < 1)
+		return FALSE;
+	if(!REGISTRY_get_cached_parameter(frame->recipient, frame->datas[0], &value))
+		return FALSE;
+	datas[0] = frame->datas[0];
+	datas[1] = (value >> 24) & 0xFF;
+	datas[2] = (value >> 16) & 0xFF;
+	datas[3] = (value >> 8) & 0xFF;
+	datas[4] = value & 0xFF;
+	SECRETARY_send_to_uart(frame->emitter, frame->recipient, PARAMETER_IS, 5, datas);
+	return TRUE;
+}
+
+#endif
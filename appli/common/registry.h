@@ -0,0 +1,71 @@
+/*
+ * registry.h
+ *
+ *  Created on: 17 oct. 2026
+ */
+
+#ifndef APPLI_COMMON_REGISTRY_H_
+#define APPLI_COMMON_REGISTRY_H_
+
+#include "../config.h"
+#include "macro_types.h"
+#include "secretary.h"
+
+/*
+ * Registre des objets (station de base).
+ * 	Une entre par identifiant d'objet (adresse d'metteur), retrouve par hachage : l'identifiant donne directement
+ * 	la case de dpart, suivie d'au plus REGISTRY_MAX_PROBES cases. Mise  jour  chaque trame reue, en temps constant.
+ * 	Si toutes ces cases sont prises, l'entre la plus anciennement vue parmi elles est remplace.
+ * 	Le registre garde : dernire rception, RSSI, MSG_CNT (et trames manques d'aprs ses sauts), resets, version et capacits
+ * 	annonces par RECENT_RESET, et les dernires valeurs de paramtres reues (PARAMETER_IS).
+ * 	Il permet de rpondre au serveur sans passer par la radio : REGISTRY_ASK, et PARAMETER_ASK dont la valeur est en cache.
+ */
+
+#define REGISTRY_SIZE				32		//doit tre une puissance de 2 !
+#define REGISTRY_MAX_PROBES			4
+#define REGISTRY_PARAMS_NB			4		//valeurs de paramtres gardes par objet (les plus rcemment reues)
+#define REGISTRY_PARAM_MAX_AGE		60000	//[ms] au-del, une valeur en cache n'est plus servie au serveur
+#define REGISTRY_MAX_MSG_CNT_GAP	64		//un saut de MSG_CNT plus grand est attribu  un redmarrage de l'objet, pas  des pertes
+
+typedef struct
+{
+	uint8_t param_id;			//PARAM_UNKNOW : emplacement libre
+	uint32_t value;
+	uint32_t time;				//[ms] instant de rception
+}registry_param_t;
+
+typedef struct
+{
+	uint32_t device_id;			//0 : emplacement libre
+	uint32_t first_seen;		//[ms]
+	uint32_t last_seen;			//[ms]
+	uint8_t rssi;				//[-dBm] dernire trame reue
+	uint8_t msg_cnt;			//dernier MSG_CNT reu sur une trame adresse  la station (le compteur est propre  chaque destinataire)
+	bool_e msg_cnt_known;
+	uint32_t rx_nb;
+	uint16_t missed_nb;			//trames manques d'aprs les sauts de MSG_CNT
+	uint8_t reset_nb;
+	uint16_t firmware_version;
+	uint32_t capabilities;		//RF_DIALOG_CAPABILITY_...
+	registry_param_t params[REGISTRY_PARAMS_NB];
+}registry_entry_t;
+
+void REGISTRY_init(void);
+
+registry_entry_t * REGISTRY_update(rf_frame_t * frame);
+
+registry_entry_t * REGISTRY_find(uint32_t device_id);
+
+registry_entry_t * REGISTRY_get_by_rank(uint8_t rank);
+
+void REGISTRY_report_reset(rf_frame_t * frame);
+
+void REGISTRY_cache_parameter(uint32_t device_id, uint8_t param_id, uint32_t value);
+
+bool_e REGISTRY_get_cached_parameter(uint32_t device_id, uint8_t param_id, uint32_t * value);
+
+uint8_t REGISTRY_build_entry(registry_entry_t * entry, uint8_t * datas);
+
+bool_e REGISTRY_answer_for_object(rf_frame_t * frame);
+
+#endif /* APPLI_COMMON_REGISTRY_H_ */
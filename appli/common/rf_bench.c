@@ -0,0 +1,406 @@
+/*
+ * rf_bench.c
+ *
+ *  Created on: 17 oct. 2026
+ */
+#include "../config.h"
+#include "rf_bench.h"
+#include "rf_dialog.h"
+#include "parameters.h"
+#include "systick.h"
+#include "timebase.h"
+
+#if USE_RF_BENCH
+
+#define RF_BENCH_UPLINK_CLASSES_NB	RF_BENCH_CLASS_POLL	//classes mises par les objets
+
+typedef struct
+{
+	uint32_t address;			//0 : emplacement libre
+	uint32_t last_seen;			//[ms]
+	bool_e seq_known[RF_BENCH_UPLINK_CLASSES_NB];
+	uint16_t next_seq[RF_BENCH_UPLINK_CLASSES_NB];
+	bool_e poll_pending;
+	uint32_t poll_time;			//[ms]
+	uint32_t poll_time_us;
+}rf_bench_peer_t;
+
+typedef struct
+{
+	uint32_t sent_nb;
+	uint32_t received_nb;
+	uint32_t lost_nb;
+	uint32_t bytes_nb;
+	uint32_t latency_nb;
+	uint64_t latency_sum;
+	uint32_t latency_max;
+	uint32_t latency_bins[RF_BENCH_LATENCY_BINS_NB];
+}rf_bench_class_stats_t;
+
+static const char * class_names[RF_BENCH_CLASS_NB] = {"telemetry", "burst", "alert", "poll"};
+
+static rf_bench_config_t config;
+static uint32_t random_state;
+//objet
+static uint16_t seqs[RF_BENCH_UPLINK_CLASSES_NB];
+static uint32_t next_telemetry_time;
+static uint32_t next_burst_time;
+static uint32_t next_alert_time;
+//station
+static rf_bench_peer_t peers[RF_BENCH_PEERS_NB];
+static rf_bench_class_stats_t class_stats[RF_BENCH_CLASS_NB];
+static uint8_t poll_index = 0;
+static uint32_t next_poll_time;
+static uint32_t next_report_time;
+static rf_dialog_handler_t previous_parameter_is_handler = NULL;
+static rf_dialog_handler_t previous_event_handler = NULL;
+
+static uint32_t RF_BENCH_next_period(uint32_t period);
+static void RF_BENCH_send(rf_bench_class_e class, uint8_t size);
+static void RF_BENCH_process_polls(void);
+static rf_bench_peer_t * RF_BENCH_find_peer(uint32_t address, bool_e create);
+static void RF_BENCH_add_latency(rf_bench_class_stats_t * stats, uint32_t latency_us);
+static uint8_t RF_BENCH_bin_of(uint32_t latency_us);
+static uint32_t RF_BENCH_bin_value(uint8_t bin);
+static uint32_t RF_BENCH_percentile(rf_bench_class_stats_t * stats, uint8_t percent);
+static void RF_BENCH_handle_traffic(rf_frame_t * frame);
+static void RF_BENCH_handle_event(rf_frame_t * frame);
+static void RF_BENCH_handle_parameter_is(rf_frame_t * frame);
+
+void RF_BENCH_init(void)
+{
+	rf_bench_config_t default_config = {RF_BENCH_TELEMETRY_PERIOD, RF_BENCH_TELEMETRY_SIZE, RF_BENCH_BURST_PERIOD, RF_BENCH_BURST_LENGTH, RF_BENCH_ALERT_PERIOD, RF_BENCH_POLL_PERIOD};
+
+	random_state = 0x9E3779B9 ^ (OBJECT_ID * 0x85EBCA6B) ^ SYSTICK_get_time_us();	//objets dsynchroniss
+	if(random_state == 0)
+		random_state = 1;
+	for(uint8_t c = 0; c < RF_BENCH_UPLINK_CLASSES_NB; c++)
+		seqs[c] = 0;
+	RF_BENCH_reset_stats();
+	RF_BENCH_configure(&default_config);
+	next_report_time = SYSTICK_get_time_ms() + RF_BENCH_REPORT_PERIOD;
+
+	if(OBJECT_ID == OBJECT_BASE_STATION && previous_parameter_is_handler == NULL)
+	{
+		RF_DIALOG_register_handler(BENCH_TRAFFIC, &RF_BENCH_handle_traffic);
+		previous_parameter_is_handler = RF_DIALOG_register_handler(PARAMETER_IS, &RF_BENCH_handle_parameter_is);
+		previous_event_handler = RF_DIALOG_register_handler(EVENT_OCCURED, &RF_BENCH_handle_event);
+	}
+}
+
+//Les premires chances tombent au hasard dans la priode : les objets dmarrs ensemble ne gnrent pas leur trafic en mme temps.
+void RF_BENCH_configure(rf_bench_config_t const * new_config)
+{
+	uint32_t now = SYSTICK_get_time_ms();
+
+	config = *new_config;
+	if(config.telemetry_size < RF_BENCH_HEADER_SIZE)
+		config.telemetry_size = RF_BENCH_HEADER_SIZE;
+	if(config.telemetry_size > MAX_DATA_SIZE)
+		config.telemetry_size = MAX_DATA_SIZE;
+	next_telemetry_time = now + RF_BENCH_next_period(config.telemetry_period) % (config.telemetry_period + 1);
+	next_burst_time = now + RF_BENCH_next_period(config.burst_period) % (config.burst_period + 1);
+	next_alert_time = now + RF_BENCH_next_period(config.alert_period) % (config.alert_period + 1);
+	next_poll_time = now + config.poll_period;
+}
+
+void RF_BENCH_reset_stats(void)
+{
+	for(uint8_t i = 0; i < RF_BENCH_PEERS_NB; i++)
+		peers[i] = (rf_bench_peer_t){0};
+	for(uint8_t c = 0; c < RF_BENCH_CLASS_NB; c++)
+		class_stats[c] = (rf_bench_class_stats_t){0};
+}
+
+//Priode avec une gigue de +/-RF_BENCH_JITTER_PERCENT % (xorshift32).
+static uint32_t RF_BENCH_next_period(uint32_t period)
+{
+	uint32_t jitter = period * RF_BENCH_JITTER_PERCENT / 100;
+
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 17;
+	random_state ^= random_state << 5;
+	if(jitter == 0)
+		return period;
+	return period - jitter + random_state % (2*jitter + 1);
+}
+
+void RF_BENCH_process_main(void)
+{
+	uint32_t now = SYSTICK_get_time_ms();
+
+	if(OBJECT_ID == OBJECT_BASE_STATION)
+	{
+		RF_BENCH_process_polls();
+		if(RF_BENCH_REPORT_PERIOD && (int32_t)(now - next_report_time) >= 0)
+		{
+			next_report_time = now + RF_BENCH_REPORT_PERIOD;
+			RF_BENCH_print_report();
+		}
+		return;
+	}
+
+	if(config.telemetry_period && (int32_t)(now - next_telemetry_time) >= 0)
+	{
+		next_telemetry_time += RF_BENCH_next_period(config.telemetry_period);
+		if((int32_t)(now - next_telemetry_time) >= 0)
+			next_telemetry_time = now + RF_BENCH_next_period(config.telemetry_period);	//retard : on ne rattrape pas les messages manqus
+		RF_BENCH_send(RF_BENCH_CLASS_TELEMETRY, config.telemetry_size);
+	}
+	if(config.burst_period && (int32_t)(now - next_burst_time) >= 0)
+	{
+		next_burst_time += RF_BENCH_next_period(config.burst_period);
+		if((int32_t)(now - next_burst_time) >= 0)
+			next_burst_time = now + RF_BENCH_next_period(config.burst_period);
+		for(uint8_t i = 0; i < config.burst_length; i++)
+			RF_BENCH_send(RF_BENCH_CLASS_BURST, config.telemetry_size);
+	}
+	if(config.alert_period && (int32_t)(now - next_alert_time) >= 0)
+	{
+		next_alert_time += RF_BENCH_next_period(config.alert_period);
+		if((int32_t)(now - next_alert_time) >= 0)
+			next_alert_time = now + RF_BENCH_next_period(config.alert_period);
+		RF_BENCH_send(RF_BENCH_CLASS_ALERT, RF_BENCH_HEADER_SIZE);
+	}
+}
+
+//Objet : BENCH_TRAFFIC = [CLASS SEQ(2) TIME_US(4) BOURRAGE...] vers la station de base.
+static void RF_BENCH_send(rf_bench_class_e class, uint8_t size)
+{
+	uint8_t datas[MAX_DATA_SIZE];
+	uint32_t now_us = TIMEBASE_get_time_us();
+
+	datas[0] = class;
+	datas[1] = (seqs[class] >> 8) & 0xFF;
+	datas[2] = seqs[class] & 0xFF;
+	datas[3] = (now_us >> 24) & 0xFF;
+	datas[4] = (now_us >> 16) & 0xFF;
+	datas[5] = (now_us >> 8) & 0xFF;
+	datas[6] = now_us & 0xFF;
+	for(uint8_t i = RF_BENCH_HEADER_SIZE; i < size; i++)
+		datas[i] = i;
+	if(class == RF_BENCH_CLASS_ALERT)
+	{
+		if(RF_DIALOG_send_event(EVENT_BENCH, size, datas, NULL))
+			seqs[class]++;	//sans emplacement fiable libre, l'alerte n'a pas exist : elle ne compte pas comme perdue
+		return;
+	}
+	seqs[class]++;
+	RF_DIALOG_send_msg_id_to_basestation(BENCH_TRAFFIC, size, datas);
+}
+
+//Station : une interrogation par priode, chaque objet entendu  son tour.
+static void RF_BENCH_process_polls(void)
+{
+	uint32_t now = SYSTICK_get_time_ms();
+	rf_bench_peer_t * peer;
+	uint8_t param = PARAM_MY_BASE_STATION_ID;
+
+	for(uint8_t i = 0; i < RF_BENCH_PEERS_NB; i++)
+	{
+		if(peers[i].poll_pending && now - peers[i].poll_time > RF_BENCH_POLL_TIMEOUT)
+		{
+			peers[i].poll_pending = FALSE;
+			class_stats[RF_BENCH_CLASS_POLL].lost_nb++;
+		}
+	}
+
+	if(config.poll_period == 0 || (int32_t)(now - next_poll_time) < 0)
+		return;
+	next_poll_time += config.poll_period;
+	if((int32_t)(now - next_poll_time) >= 0)
+		next_poll_time = now + config.poll_period;
+
+	for(uint8_t i = 0; i < RF_BENCH_PEERS_NB; i++)
+	{
+		peer = &peers[(poll_index + i) % RF_BENCH_PEERS_NB];
+		if(peer->address != 0 && !peer->poll_pending)
+		{
+			poll_index = (poll_index + i + 1) % RF_BENCH_PEERS_NB;
+			peer->poll_pending = TRUE;
+			peer->poll_time = now;
+			peer->poll_time_us = SYSTICK_get_time_us();
+			class_stats[RF_BENCH_CLASS_POLL].sent_nb++;
+			RF_DIALOG_send_msg_id_to_object((recipient_e)peer->address, PARAMETER_ASK, 1, &param);
+			return;
+		}
+	}
+}
+
+//Objet d'adresse address. Si create, il est ajout s'il est inconnu,  la place du plus anciennement entendu si la table est pleine.
+static rf_bench_peer_t * RF_BENCH_find_peer(uint32_t address, bool_e create)
+{
+	rf_bench_peer_t * victim = NULL;
+
+	for(uint8_t i = 0; i < RF_BENCH_PEERS_NB; i++)
+	{
+		if(peers[i].address == address)
+			return &peers[i];
+		if(victim == NULL || (victim->address != 0 && (peers[i].address == 0 || (int32_t)(peers[i].last_seen - victim->last_seen) < 0)))
+			victim = &peers[i];
+	}
+	if(!create || victim == NULL)
+		return NULL;
+	*victim = (rf_bench_peer_t){0};
+	victim->address = address;
+	return victim;
+}
+
+static void RF_BENCH_handle_traffic(rf_frame_t * frame)
+{
+	rf_bench_peer_t * peer;
+	rf_bench_class_stats_t * stats;
+	uint8_t class;
+	uint16_t seq;
+	uint16_t gap = 0;
+
+	if(frame->source != MSG_SOURCE_RF || frame->datasize < RF_BENCH_HEADER_SIZE || frame->datas[0] >= RF_BENCH_UPLINK_CLASSES_NB)
+		return;
+	class = frame->datas[0];
+	seq = U16FROMU8(frame->datas[1], frame->datas[2]);
+	stats = &class_stats[class];
+	peer = RF_BENCH_find_peer(frame->emitter, TRUE);
+	if(peer != NULL)
+	{
+		peer->last_seen = SYSTICK_get_time_ms();
+		if(peer->seq_known[class])
+		{
+			gap = (uint16_t)(seq - peer->next_seq[class]);
+			if(gap >= 0x8000)
+				return;	//dj reu (doublon relay)
+		}
+		peer->seq_known[class] = TRUE;
+		peer->next_seq[class] = seq + 1;
+	}
+	stats->lost_nb += gap;
+	stats->sent_nb += gap + 1;
+	stats->received_nb++;
+	stats->bytes_nb += frame->datasize;
+#if RF_BENCH_ONE_WAY_LATENCY
+	RF_BENCH_add_latency(stats, TIMEBASE_get_time_us() - U32FROMU8(frame->datas[3], frame->datas[4], frame->datas[5], frame->datas[6]));
+#endif
+}
+
+//Station : alerte du banc, EVENT_OCCURED = [EVENT_BENCH CLASS SEQ(2) TIME_US(4)], compte comme un BENCH_TRAFFIC.
+static void RF_BENCH_handle_event(rf_frame_t * frame)
+{
+	rf_frame_t traffic;
+
+	if(frame->datasize >= 1 && frame->datas[0] == EVENT_BENCH)
+	{
+		traffic = *frame;
+		traffic.datas = &frame->datas[1];
+		traffic.datasize = frame->datasize - 1;
+		if(traffic.datasize >= 1 && traffic.datas[0] == RF_BENCH_CLASS_ALERT)
+			RF_BENCH_handle_traffic(&traffic);
+	}
+	else if(previous_event_handler != NULL)
+		previous_event_handler(frame);
+}
+
+static void RF_BENCH_handle_parameter_is(rf_frame_t * frame)
+{
+	rf_bench_peer_t * peer;
+	rf_bench_class_stats_t * stats = &class_stats[RF_BENCH_CLASS_POLL];
+
+	if(frame->source == MSG_SOURCE_RF && frame->datasize >= 1 && frame->datas[0] == PARAM_MY_BASE_STATION_ID)
+	{
+		peer = RF_BENCH_find_peer(frame->emitter, FALSE);
+		if(peer != NULL && peer->poll_pending)
+		{
+			peer->poll_pending = FALSE;
+			stats->received_nb++;
+			stats->bytes_nb += frame->datasize;
+			RF_BENCH_add_latency(stats, SYSTICK_get_time_us() - peer->poll_time_us);
+		}
+	}
+	if(previous_parameter_is_handler != NULL)
+		previous_parameter_is_handler(frame);
+}
+
+//Classes de l'histogramme : valeur exacte en-dessous de 4us, puis 4 classes par octave.
+static uint8_t RF_BENCH_bin_of(uint32_t latency_us)
+{
+	uint8_t msb;
+	uint32_t bin;
+
+	if(latency_us < 4)
+		return latency_us;
+	msb = 31 - __builtin_clz(latency_us);
+	bin = 4*(msb - 1) + ((latency_us >> (msb - 2)) & 3);
+	return (bin >= RF_BENCH_LATENCY_BINS_NB) ? (RF_BENCH_LATENCY_BINS_NB - 1) : bin;
+}
+
+//Milieu de la classe bin [us]
+static uint32_t RF_BENCH_bin_value(uint8_t bin)
+{
+	uint8_t shift;
+
+	if(bin < 4)
+		return bin;
+	shift = bin/4 - 1;
+	return ((4 + bin%4) << shift) + ((1 << shift) >> 1);
+}
+
+static void RF_BENCH_add_latency(rf_bench_class_stats_t * stats, uint32_t latency_us)
+{
+	stats->latency_nb++;
+	stats->latency_sum += latency_us;
+	if(latency_us > stats->latency_max)
+		stats->latency_max = latency_us;
+	stats->latency_bins[RF_BENCH_bin_of(latency_us)]++;
+}
+
+static uint32_t RF_BENCH_percentile(rf_bench_class_stats_t * stats, uint8_t percent)
+{
+	uint32_t count = 0;
+
+	if(stats->latency_nb == 0)
+		return 0;
+	for(uint8_t bin = 0; bin < RF_BENCH_LATENCY_BINS_NB; bin++)
+	{
+		count += stats->latency_bins[bin];
+		if((uint64_t)count * 100 >= (uint64_t)stats->latency_nb * percent)
+			return MIN(RF_BENCH_bin_value(bin), stats->latency_max);
+	}
+	return stats->latency_max;
+}
+
+void RF_BENCH_get_report(rf_bench_class_e class, rf_bench_report_t * report)
+{
+	rf_bench_class_stats_t * stats;
+
+	if(class >= RF_BENCH_CLASS_NB || report == NULL)
+		return;
+	stats = &class_stats[class];
+	report->sent_nb = stats->sent_nb;
+	report->received_nb = stats->received_nb;
+	report->lost_nb = stats->lost_nb;
+	report->bytes_nb = stats->bytes_nb;
+	report->latency_nb = stats->latency_nb;
+	report->latency_avg = stats->latency_nb ? (uint32_t)(stats->latency_sum / stats->latency_nb) : 0;
+	report->latency_p50 = RF_BENCH_percentile(stats, 50);
+	report->latency_p99 = RF_BENCH_percentile(stats, 99);
+	report->latency_max = stats->latency_max;
+}
+
+void RF_BENCH_print_report(void)
+{
+	rf_bench_report_t report;
+
+	for(rf_bench_class_e c = 0; c < RF_BENCH_CLASS_NB; c++)
+	{
+		RF_BENCH_get_report(c, &report);
+		if(report.sent_nb == 0)
+			continue;
+		debug_printf("bench %s: sent %d received %d lost %d bytes %d", class_names[c], report.sent_nb, report.received_nb, report.lost_nb, report.bytes_nb);
+		if(report.latency_nb)
+			debug_printf(" latency[us] avg %d p50 %d p99 %d max %d", report.latency_avg, report.latency_p50, report.latency_p99, report.latency_max);
+		debug_printf("\n");
+	}
+#if USE_RF_SECURE
+	RF_SECURE_print_stats();	//cot de la protection des trames,  comparer aux mmes mesures sans elle
+#endif
+}
+
+#endif
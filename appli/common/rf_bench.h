@@ -0,0 +1,95 @@
+/*
+ * rf_bench.h
+ *
+ *  Created on: 17 oct. 2026
+ */
+
+#ifndef APPLI_COMMON_RF_BENCH_H_
+#define APPLI_COMMON_RF_BENCH_H_
+
+#include "../config.h"
+#include "macro_types.h"
+#include "secretary.h"
+
+/*
+ * Banc de mesure de charge du rseau (USE_RF_BENCH).
+ * 	Chaque objet gnre du trafic synthtique vers la station de base : des messages BENCH_TRAFFIC = [CLASS SEQ(2) TIME_US(4) BOURRAGE...]
+ * 	de tlmtrie priodique (gigue de +/-RF_BENCH_JITTER_PERCENT %) et des rafales de plusieurs messages dposs d'un coup.
+ * 	Les alertes portent le mme contenu dans un EVENT_OCCURED = [EVENT_BENCH CLASS SEQ(2) TIME_US(4)], envoy par RF_DIALOG_send_event :
+ * 	leur latence, mesure au milieu du reste du trafic, est celle du chemin prioritaire des alertes.
+ * 	La station de base interroge  son tour chaque objet entendu (PARAMETER_ASK) et mesure le temps de rponse (PARAMETER_IS).
+ * 	Par classe de message, la station compte les messages reus, les pertes (trous dans les SEQ de chaque objet), les octets utiles,
+ * 	et tient un histogramme logarithmique de la latence (4 classes par octave) dont sont tirs p50 et p99.
+ * 	La latence des classes montantes est TIME_US de la rception moins TIME_US de l'mission, dats sur le temps rseau (voir timebase.h) :
+ * 	elle n'a de sens qu'une fois les objets synchroniss (RF_BENCH_ONE_WAY_LATENCY). Celle des interrogations est un aller-retour.
+ * 	Les pertes des derniers messages d'un objet ne sont dcouvertes qu'au message suivant.
+ */
+
+#ifndef RF_BENCH_TELEMETRY_PERIOD
+	#define RF_BENCH_TELEMETRY_PERIOD	1000	//[ms] 0 : pas de tlmtrie
+#endif
+#ifndef RF_BENCH_TELEMETRY_SIZE
+	#define RF_BENCH_TELEMETRY_SIZE		12		//[octets] datas de chaque message (au moins RF_BENCH_HEADER_SIZE)
+#endif
+#ifndef RF_BENCH_BURST_PERIOD
+	#define RF_BENCH_BURST_PERIOD		0		//[ms] 0 : pas de rafale
+#endif
+#ifndef RF_BENCH_BURST_LENGTH
+	#define RF_BENCH_BURST_LENGTH		4		//messages par rafale
+#endif
+#ifndef RF_BENCH_ALERT_PERIOD
+	#define RF_BENCH_ALERT_PERIOD		0		//[ms] 0 : pas d'alerte
+#endif
+#ifndef RF_BENCH_POLL_PERIOD
+	#define RF_BENCH_POLL_PERIOD		0		//[ms] station : une interrogation d'objet par priode, chacun  son tour ; 0 : aucune
+#endif
+#ifndef RF_BENCH_ONE_WAY_LATENCY
+	#define RF_BENCH_ONE_WAY_LATENCY	0		//1 si les objets sont synchroniss avant de gnrer leur trafic (USE_TIMEBASE)
+#endif
+#define RF_BENCH_REPORT_PERIOD		10000	//[ms] station : rapport priodique sur debug_printf (0 : aucun)
+#define RF_BENCH_JITTER_PERCENT		10
+#define RF_BENCH_HEADER_SIZE		7		//[CLASS SEQ(2) TIME_US(4)]
+#define RF_BENCH_PEERS_NB			64		//objets suivis par la station
+#define RF_BENCH_POLL_TIMEOUT		2000	//[ms] au-del, l'interrogation est perdue
+#define RF_BENCH_LATENCY_BINS_NB	96		//4 classes par octave : jusqu' 2^24 us
+
+typedef enum
+{
+	RF_BENCH_CLASS_TELEMETRY = 0,
+	RF_BENCH_CLASS_BURST,
+	RF_BENCH_CLASS_ALERT,
+	RF_BENCH_CLASS_POLL,		//seule classe descendante, la dernire
+	RF_BENCH_CLASS_NB
+}rf_bench_class_e;
+
+typedef struct
+{
+	uint32_t telemetry_period;	//[ms]
+	uint8_t telemetry_size;		//[octets]
+	uint32_t burst_period;		//[ms]
+	uint8_t burst_length;
+	uint32_t alert_period;		//[ms]
+	uint32_t poll_period;		//[ms]
+}rf_bench_config_t;
+
+typedef struct
+{
+	uint32_t sent_nb;			//mis (dduit des SEQ reus pour les classes montantes)
+	uint32_t received_nb;
+	uint32_t lost_nb;
+	uint32_t bytes_nb;			//datas reues
+	uint32_t latency_nb;		//mesures de latence
+	uint32_t latency_avg;		//[us]
+	uint32_t latency_p50;		//[us]  25% prs (histogramme)
+	uint32_t latency_p99;		//[us]
+	uint32_t latency_max;		//[us]
+}rf_bench_report_t;
+
+void RF_BENCH_init(void);
+void RF_BENCH_process_main(void);
+void RF_BENCH_configure(rf_bench_config_t const * config);
+void RF_BENCH_reset_stats(void);
+void RF_BENCH_get_report(rf_bench_class_e class, rf_bench_report_t * report);
+void RF_BENCH_print_report(void);
+
+#endif /* APPLI_COMMON_RF_BENCH_H_ */
@@ -0,0 +1,267 @@
+/*
+ * rf_channel.c
+ *
+ *  Created on: 17 oct. 2026
+ */
+#include "../config.h"
+#include "rf_channel.h"
+#include "systick.h"
+#include "secretary.h"
+#include "rf_dialog.h"
+
+//Canaux candidats : entre les canaux Wi-Fi 1, 6 et 11 (2412, 2437, 2462 MHz, 22 MHz de large) et au-dessus. Canal n = 2400+n MHz.
+static const uint8_t candidates[RF_CHANNEL_CANDIDATES_NB] = RF_CHANNEL_CANDIDATES;
+
+static rf_channel_stats_t stats[RF_CHANNEL_CANDIDATES_NB];
+static uint8_t channel_set[RF_CHANNEL_CANDIDATES_NB];	//indices dans candidates[], du meilleur au moins bon
+static uint8_t channel_set_nb;
+static uint8_t current;									//indice dans channel_set[] du canal de travail
+static uint32_t last_time;								//[ms] station : dernire diffusion du jeu ; objet : dernire trame reue de la station
+static uint32_t last_scan_time;							//[ms] station : dernire mesure du bruit ; objet : dernier changement de canal pendant la recherche
+static uint32_t eval_start_time;						//[ms]
+static uint32_t eval_delivered_nb;
+static uint32_t eval_lost_nb;
+static bool_e scan_done = FALSE;
+static bool_e fast_bitrate = FALSE;						//dbit du rseau : 2Mbps (TRUE) ou 1Mbps
+
+static void RF_CHANNEL_process_base_station(void);
+static void RF_CHANNEL_process_object(void);
+static void RF_CHANNEL_switch(uint8_t new_current);
+static uint8_t RF_CHANNEL_find_candidate(uint8_t channel);
+
+void RF_CHANNEL_init(void)
+{
+	for(uint8_t i = 0; i < RF_CHANNEL_CANDIDATES_NB; i++)
+	{
+		stats[i] = (rf_channel_stats_t){0};
+		stats[i].channel = candidates[i];
+		channel_set[i] = i;
+	}
+	channel_set_nb = RF_CHANNEL_CANDIDATES_NB;	//tant qu'aucun jeu n'est connu, un objet cherche la station sur tous les candidats
+	current = 0;
+	last_time = SYSTICK_get_time_ms();
+	last_scan_time = last_time;
+	eval_start_time = last_time;
+	eval_delivered_nb = 0;
+	eval_lost_nb = 0;
+	scan_done = FALSE;
+	fast_bitrate = FALSE;
+}
+
+uint8_t RF_CHANNEL_get_channel(void)
+{
+	return candidates[channel_set[current]];
+}
+
+void RF_CHANNEL_process_main(void)
+{
+	if(!USE_RF_CHANNEL_AGILITY)
+		return;
+	if(OBJECT_ID == OBJECT_BASE_STATION)
+		RF_CHANNEL_process_base_station();
+	else
+		RF_CHANNEL_process_object();
+}
+
+//Appele pour chaque trame reue (traite en tache de fond).
+void RF_CHANNEL_report_rx(uint32_t emitter)
+{
+	stats[channel_set[current]].rx_nb++;
+	if(OBJECT_ID != OBJECT_BASE_STATION && emitter == BASE_STATION_EMITTER_ID)
+		last_time = SYSTICK_get_time_ms();	//la station est bien sur notre canal
+}
+
+//Appele  l'acquittement d'un message fiable (delivered = TRUE) ou  l'expiration de chaque attente d'acquittement.
+void RF_CHANNEL_report_tx_result(bool_e delivered)
+{
+	if(delivered)
+	{
+		stats[channel_set[current]].delivered_nb++;
+		eval_delivered_nb++;
+	}
+	else
+	{
+		stats[channel_set[current]].lost_nb++;
+		eval_lost_nb++;
+	}
+}
+
+bool_e RF_CHANNEL_get_stats(uint8_t candidate_index, rf_channel_stats_t * stats_out)
+{
+	if(candidate_index >= RF_CHANNEL_CANDIDATES_NB || stats_out == NULL)
+		return FALSE;
+	*stats_out = stats[candidate_index];
+	return TRUE;
+}
+
+//Objet : jeu de canaux diffus par la station.
+void RF_CHANNEL_channel_set_received(uint8_t current_index, uint8_t nb, uint8_t * channels, uint8_t flags)
+{
+	uint8_t index;
+	uint8_t set_nb = 0;
+	uint8_t new_set[RF_CHANNEL_CANDIDATES_NB];
+
+	if(OBJECT_ID == OBJECT_BASE_STATION || nb == 0 || current_index >= nb)
+		return;
+	for(uint8_t i = 0; i < nb && set_nb < RF_CHANNEL_CANDIDATES_NB; i++)
+	{
+		index = RF_CHANNEL_find_candidate(channels[i]);
+		if(index == RF_CHANNEL_CANDIDATES_NB)
+		{
+			if(i == current_index)
+				return;	//canal de travail inconnu de nos candidats : jeu ignor
+			continue;
+		}
+		if(i == current_index)
+			current_index = set_nb;
+		new_set[set_nb++] = index;
+	}
+	for(uint8_t i = 0; i < set_nb; i++)
+		channel_set[i] = new_set[i];
+	channel_set_nb = set_nb;
+	last_time = SYSTICK_get_time_ms();
+	if(((flags & RF_CHANNEL_FLAG_2MBPS)?TRUE:FALSE) != fast_bitrate)
+		RF_CHANNEL_set_2mbps(!fast_bitrate);
+	if(candidates[channel_set[current_index]] != SECRETARY_get_rf_channel())
+		RF_CHANNEL_switch(current_index);
+	else
+		current = current_index;
+}
+
+static uint8_t RF_CHANNEL_find_candidate(uint8_t channel)
+{
+	for(uint8_t i = 0; i < RF_CHANNEL_CANDIDATES_NB; i++)
+	{
+		if(candidates[i] == channel)
+			return i;
+	}
+	return RF_CHANNEL_CANDIDATES_NB;
+}
+
+static void RF_CHANNEL_switch(uint8_t new_current)
+{
+	current = new_current;
+	eval_start_time = SYSTICK_get_time_ms();
+	eval_delivered_nb = 0;
+	eval_lost_nb = 0;
+	SECRETARY_set_rf_channel(candidates[channel_set[current]]);
+}
+
+static void RF_CHANNEL_announce(void)
+{
+	uint8_t channels[RF_CHANNEL_CANDIDATES_NB];	//avant le premier tri, le jeu compte tous les candidats
+	for(uint8_t i = 0; i < channel_set_nb; i++)
+		channels[i] = candidates[channel_set[i]];
+	RF_DIALOG_send_channel_set(current, channel_set_nb, channels, fast_bitrate?RF_CHANNEL_FLAG_2MBPS:0);
+}
+
+bool_e RF_CHANNEL_is_2mbps(void)
+{
+	return fast_bitrate;
+}
+
+//Station : le nouveau dbit est annonc ( l'ancien dbit) avant d'tre appliqu. Objet : dbit annonc, ou essay pendant la recherche.
+void RF_CHANNEL_set_2mbps(bool_e fast)
+{
+	fast_bitrate = fast;
+#if USE_RF_CHANNEL_AGILITY
+	if(OBJECT_ID == OBJECT_BASE_STATION)
+	{
+		RF_CHANNEL_announce();
+		last_time = SYSTICK_get_time_ms();
+	}
+#endif
+	SECRETARY_set_bitrate(fast?NRF_ESB_BITRATE_2MBPS:NRF_ESB_BITRATE_1MBPS);
+}
+
+//Station : mesure du bruit sur tous les candidats, puis tri du jeu de canaux.
+static bool_e RF_CHANNEL_scan(void)
+{
+	uint8_t working_channel;
+	uint8_t tmp;
+
+	for(uint8_t i = 0; i < RF_CHANNEL_CANDIDATES_NB; i++)
+	{
+		if(!SECRETARY_measure_channel_noise(candidates[i], &stats[i].noise))
+			return FALSE;	//radio occupe, on ressaiera au prochain passage
+	}
+
+	working_channel = channel_set[current];
+	for(uint8_t i = 0; i < RF_CHANNEL_CANDIDATES_NB; i++)
+		channel_set[i] = i;
+	for(uint8_t i = 1; i < RF_CHANNEL_CANDIDATES_NB; i++)	//tri par insertion, du plus calme au plus bruyant
+	{
+		for(uint8_t j = i; j > 0 && stats[channel_set[j]].noise > stats[channel_set[j-1]].noise; j--)
+		{
+			tmp = channel_set[j];
+			channel_set[j] = channel_set[j-1];
+			channel_set[j-1] = tmp;
+		}
+	}
+	channel_set_nb = RF_CHANNEL_SET_NB;
+
+	//on ne quitte le canal de travail que s'il est nettement plus bruyant que le meilleur (hystrsis), ou s'il n'est plus dans le jeu.
+	for(uint8_t i = 0; i < channel_set_nb; i++)
+	{
+		if(channel_set[i] == working_channel && stats[channel_set[0]].noise < stats[working_channel].noise + RF_CHANNEL_NOISE_HYSTERESIS)
+		{
+			current = i;
+			return TRUE;
+		}
+	}
+	current = 0;
+	if(scan_done)
+		RF_CHANNEL_announce();	//prvient les objets sur l'ancien canal
+	RF_CHANNEL_switch(0);
+	return TRUE;
+}
+
+static void RF_CHANNEL_process_base_station(void)
+{
+	uint32_t now = SYSTICK_get_time_ms();
+	uint8_t new_current;
+
+	if(!scan_done || now - last_scan_time >= RF_CHANNEL_SCAN_PERIOD)
+	{
+		if(RF_CHANNEL_scan())
+		{
+			scan_done = TRUE;
+			last_scan_time = now;
+		}
+	}
+
+	if(now - eval_start_time >= RF_CHANNEL_EVAL_PERIOD)
+	{
+		if(eval_lost_nb >= RF_CHANNEL_MIN_LOST_NB && eval_lost_nb*100 > (eval_delivered_nb + eval_lost_nb)*RF_CHANNEL_MAX_LOSS)
+		{
+			//trop de pertes : on passe au canal suivant du jeu, aprs avoir prvenu les objets.
+			new_current = (current + 1) % channel_set_nb;
+			current = new_current;
+			RF_CHANNEL_announce();
+			RF_CHANNEL_switch(new_current);
+			last_time = now;
+		}
+		eval_start_time = now;
+		eval_delivered_nb = 0;
+		eval_lost_nb = 0;
+	}
+
+	if(now - last_time >= RF_CHANNEL_ANNOUNCE_PERIOD)
+	{
+		last_time = now;
+		RF_CHANNEL_announce();
+	}
+}
+
+static void RF_CHANNEL_process_object(void)
+{
+	uint32_t now = SYSTICK_get_time_ms();
+	if(now - last_time >= RF_CHANNEL_LOST_TIMEOUT && now - last_scan_time >= RF_CHANNEL_HUNT_DWELL)
+	{
+		//station perdue : on essaye le canal suivant du jeu, en y restant le temps d'entendre une diffusion.
+		last_scan_time = now;
+		if((current + 1) % channel_set_nb == 0)
+			RF_CHANNEL_set_2mbps(!fast_bitrate);	//tour complet sans entendre la station : elle a peut-tre chang de dbit
+		RF_CHANNEL_switch((current + 1) % channel_set_nb);
+	}
+}
@@ -0,0 +1,64 @@
+/*
+ * rf_channel.h
+ *
+ *  Created on: 17 oct. 2026
+ */
+
+#ifndef APPLI_COMMON_RF_CHANNEL_H_
+#define APPLI_COMMON_RF_CHANNEL_H_
+
+#include "../config.h"
+#include "macro_types.h"
+
+/*
+ * Agilit de frquence.
+ * 	La station de base mesure priodiquement le bruit (RSSI) sur les canaux candidats et en dduit un jeu de canaux,
+ * 	classs du plus calme au plus bruyant. Elle diffuse rgulirement ce jeu (CHANNEL_SET) avec l'indice du canal de travail.
+ * 	Elle passe au canal suivant du jeu lorsque la perte de messages fiables dpasse RF_CHANNEL_MAX_LOSS.
+ * 	Un objet qui n'entend plus la station pendant RF_CHANNEL_LOST_TIMEOUT parcourt le jeu de canaux jusqu' la retrouver.
+ * 	Le dbit du rseau (choisi par rf_link) est diffus avec le jeu ; l'objet qui cherche la station alterne de dbit  chaque tour du jeu.
+ */
+
+#define RF_CHANNEL_CANDIDATES_NB	8
+#define RF_CHANNEL_CANDIDATES		{2, 24, 25, 49, 50, 75, 80, 90}
+#define RF_CHANNEL_SET_NB			4		//nombre de canaux retenus et diffuss (au plus RF_CHANNEL_CANDIDATES_NB)
+
+#define RF_CHANNEL_SCAN_PERIOD		60000	//[ms] priode de mesure du bruit par la station (chaque mesure bloque la radio ~2ms)
+#define RF_CHANNEL_NOISE_HYSTERESIS	6		//[dB] cart de bruit justifiant de quitter le canal de travail
+#define RF_CHANNEL_EVAL_PERIOD		10000	//[ms] fentre d'valuation des pertes
+#define RF_CHANNEL_MIN_LOST_NB		4		//pertes minimales dans la fentre avant de changer de canal
+#define RF_CHANNEL_MAX_LOSS			30		//[%] taux de perte au-del duquel la station change de canal
+#define RF_CHANNEL_ANNOUNCE_PERIOD	1000	//[ms] priode de diffusion du jeu de canaux
+#define RF_CHANNEL_LOST_TIMEOUT		3500	//[ms] silence de la station au-del duquel un objet part  sa recherche
+#define RF_CHANNEL_HUNT_DWELL		1200	//[ms] dure d'coute de chaque canal pendant la recherche (> RF_CHANNEL_ANNOUNCE_PERIOD)
+
+#define RF_CHANNEL_FLAG_2MBPS		0x01	//octet FLAGS de CHANNEL_SET : rseau  2Mbps (1Mbps sinon)
+
+typedef struct
+{
+	uint8_t channel;
+	uint8_t noise;			//[-dBm] dernier bruit mesur (plus la valeur est grande, plus le canal est calme)
+	uint32_t rx_nb;			//trames reues sur ce canal
+	uint32_t delivered_nb;	//messages fiables acquitts
+	uint32_t lost_nb;		//attentes d'acquittement expires
+}rf_channel_stats_t;
+
+void RF_CHANNEL_init(void);
+
+void RF_CHANNEL_process_main(void);
+
+uint8_t RF_CHANNEL_get_channel(void);
+
+void RF_CHANNEL_report_rx(uint32_t emitter);
+
+void RF_CHANNEL_report_tx_result(bool_e delivered);
+
+void RF_CHANNEL_channel_set_received(uint8_t current_index, uint8_t nb, uint8_t * channels, uint8_t flags);
+
+bool_e RF_CHANNEL_is_2mbps(void);
+
+void RF_CHANNEL_set_2mbps(bool_e fast);
+
+bool_e RF_CHANNEL_get_stats(uint8_t candidate_index, rf_channel_stats_t * stats);
+
+#endif /* APPLI_COMMON_RF_CHANNEL_H_ */
@@ -4,15 +4,133 @@
  *  Created on: 10 fvr. 2021
  *      Author: Guillaume  & Thomas
  */
+#include <string.h>
 #include "../config.h"
 #include "secretary.h"
 #include "rf_dialog.h"
 #include "parameters.h"
+#include "systick.h"
+#include "timeslot.h"
+#include "timebase.h"
+#include "rf_channel.h"
+#include "rf_link.h"
+#include "rf_stats.h"
+#include "registry.h"
+#include "rf_relay.h"
+#include "rf_ping.h"
 //Reception e transmission RF
 
 static uint32_t my_device_id = -1;	//constitu de 3 octets d'identifiant unique et 1 octet d'OBJECT_ID
+static uint32_t random_state = 0;	//tirage des dlais de rmission des alertes
 static uint32_t my_base_station_id = 0xFFFFFFFF;
-static uint8_t index_msg_cnt = 0;
+
+//Compteurs de messages, un par destinataire (indexs par les bits de poids faible de l'adresse du destinataire).
+//Ils permettent au destinataire de dtecter les pertes et les doublons, et d'acquitter un message prcis.
+#define MSG_CNT_TABLE_SIZE	32
+static uint8_t msg_cnt_per_recipient[MSG_CNT_TABLE_SIZE];
+//Les adresses multicast (diffusion, groupes) ont leurs propres compteurs : partags avec ceux des objets, ils y creuseraient des trous
+//que le destinataire prendrait pour des pertes.
+#define MSG_CNT_MULTICAST_TABLE_SIZE	8
+static uint8_t msg_cnt_per_multicast[MSG_CNT_MULTICAST_TABLE_SIZE];
+
+#if OBJECT_ID == OBJECT_BASE_STATION
+//Adresses courtes distribues : short_addresses[n] est l'adresse complte de l'objet d'adresse courte n (0 : adresse libre).
+static uint32_t short_addresses[RF_DIALOG_SHORT_ADDRESSES_NB];
+static uint8_t short_address_to_revoke = SHORT_ADDRESS_NONE;
+#else
+static uint8_t my_short_address = SHORT_ADDRESS_NONE;
+static uint32_t last_join_time;		//[ms]
+static volatile uint32_t my_groups = 0;	//masque des groupes dont nous sommes membres (copie de PARAM_GROUPS)
+#endif
+
+//Messages envoys en mode fiable, en attente de leur ACK.
+typedef struct
+{
+	bool_e used;
+	uint32_t recipient;
+	uint8_t msg_cnt;
+	msg_id_e msg_id;
+	uint8_t frame[NRF_ESB_MAX_PAYLOAD_LENGTH];	//trame complte, rmise telle quelle (mme MSG_CNT)
+	uint8_t frame_size;
+	uint8_t pipe;
+	tx_priority_e priority;
+	uint8_t retries_remaining;
+	uint32_t timeout;							//[ms] dlai d'attente de l'ACK pour l'essai en cours
+	uint32_t last_try_time;						//[ms]
+	uint32_t first_try_time;					//[ms] pour la mesure de latence
+	rf_dialog_delivery_callback_t callback;
+}reliable_slot_t;
+
+static reliable_slot_t reliable_slots[RF_DIALOG_RELIABLE_SLOTS_NB];
+
+//Bloc en cours d'mission par morceaux. Un seul transfert sortant  la fois.
+typedef struct
+{
+	bool_e pending;
+	uint32_t recipient;
+	uint32_t emitter;
+	uint8_t xfer_id;
+	msg_id_e msg_id;
+	uint8_t fragment_nb;
+	uint8_t next_fragment;
+	uint16_t size;
+	tx_priority_e priority;
+	uint8_t datas[RF_DIALOG_BLOCK_MAX_SIZE];
+}fragmented_tx_t;
+
+static fragmented_tx_t fragmented_tx;
+
+//Blocs en cours de rassemblage, identifis par (metteur, XFER_ID).
+typedef struct
+{
+	bool_e used;
+	uint32_t emitter;
+	uint8_t xfer_id;
+	uint8_t msg_id;
+	uint8_t fragment_nb;
+	uint32_t received_mask;						//bit i : morceau i reu
+	uint16_t size;
+	uint32_t last_fragment_time;				//[ms]
+	uint8_t datas[RF_DIALOG_BLOCK_MAX_SIZE+1];	//+1 : le bloc est termin par un 0, ce qui facilite le traitement des textes
+}reassembly_slot_t;
+
+static reassembly_slot_t reassembly_slots[RF_DIALOG_REASSEMBLY_SLOTS_NB];
+
+static void RF_DIALOG_send_msg(uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint8_t datasize, uint8_t * datas, tx_priority_e priority);
+static void RF_DIALOG_send_frame(uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint8_t datasize, uint8_t * datas, tx_priority_e priority);
+static uint8_t RF_DIALOG_build_frame(uint8_t * frame, uint8_t * pipe, uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint8_t datasize, uint8_t * datas);
+static uint8_t RF_DIALOG_next_msg_cnt(uint32_t recipient);
+static bool_e RF_DIALOG_get_short_addresses(uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint8_t * short_recipient, uint8_t * short_emitter);
+static bool_e RF_DIALOG_expand_short_addresses(rf_frame_t * frame, uint8_t short_recipient, uint8_t short_emitter);
+static void RF_DIALOG_process_short_address(void);
+static bool_e RF_DIALOG_send_msg_reliable(uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint8_t datasize, uint8_t * datas, rf_dialog_delivery_callback_t callback);
+static void RF_DIALOG_reply_with_priority(rf_frame_t * frame, msg_id_e msg_id, uint8_t datasize, uint8_t * datas, tx_priority_e priority);
+static void RF_DIALOG_ack_if_requested(rf_frame_t * frame);
+static void RF_DIALOG_process_ack(rf_frame_t * frame);
+static void RF_DIALOG_process_reliable_slots(void);
+static bool_e RF_DIALOG_send_block(uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint16_t size, uint8_t * datas);
+static void RF_DIALOG_process_fragmented_tx(void);
+static void RF_DIALOG_process_reassembly_timeouts(void);
+static void RF_DIALOG_dispatch(rf_frame_t * frame);
+
+#if USE_RF_DIALOG_PACKING
+//Messages de tlmtrie en attente d'tre regroups dans une mme trame PACKED_MSGS.
+typedef struct
+{
+	bool_e pending;
+	uint32_t recipient;
+	uint32_t emitter;
+	uint8_t datas[COMPACT_MAX_DATA_SIZE];	//suite de [MSG_ID DATASIZE DATAS...]
+	uint8_t size;
+	uint8_t capacity;				//FRAME_MAX_DATA_SIZE, ou COMPACT_FRAME_MAX_DATA_SIZE si le destinataire nous a donn une adresse courte
+	uint8_t msg_nb;
+	uint32_t first_msg_time;		//[ms] instant d'arrive du premier message du groupe
+}packed_msgs_t;
+
+static packed_msgs_t packed_msgs;
+
+static bool_e RF_DIALOG_pack_msg(uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint8_t datasize, uint8_t * datas);
+#endif
 
 void RF_DIALOG_init(void)
 {
@@ -20,11 +138,85 @@ void RF_DIALOG_init(void)
 	my_base_station_id = PARAMETERS_get(PARAM_MY_BASE_STATION_ID);
 }
 
+//xorshift32, amorc par l'identifiant unique de la puce : deux objets de mme type ne tirent pas les mmes valeurs.
+static uint32_t RF_DIALOG_random(void)
+{
+	if(random_state == 0)
+		random_state = (NRF_FICR->DEVICEID[0] ^ 0x9E3779B9) | 1;
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 17;
+	random_state ^= random_state << 5;
+	return random_state;
+}
+
 uint32_t RF_DIALOG_get_my_base_station_id(void)
 {
 	return my_base_station_id;
 }
 
+#if OBJECT_ID != OBJECT_BASE_STATION
+static void RF_DIALOG_groups_updated(int32_t groups)
+{
+	my_groups = (uint32_t)groups & 0x00FFFFFF;
+}
+#endif
+
+//L'appartenance aux groupes est un paramtre sauvegard en flash, que la station (ou le serveur) peut crire avec PARAMETER_WRITE.
+void RF_DIALOG_init_groups(void)
+{
+#if OBJECT_ID != OBJECT_BASE_STATION
+	PARAMETERS_enable(PARAM_GROUPS, 0, TRUE, &RF_DIALOG_groups_updated, NULL);
+	RF_DIALOG_groups_updated(PARAMETERS_get(PARAM_GROUPS));
+#endif
+}
+
+//Objet : renvoie TRUE si une trame adresse  recipient nous concerne (adresse propre, diffusion ou groupe dont nous sommes membre).
+bool_e RF_DIALOG_is_for_me(uint32_t recipient)
+{
+#if OBJECT_ID != OBJECT_BASE_STATION
+	if(recipient == OBJECT_ID || recipient == RF_BROADCAST_OBJECTS)
+		return TRUE;
+	switch(recipient & RF_GROUP_PREFIX_MASK)
+	{
+		case RF_GROUP_MASK_PREFIX:
+			return (recipient & my_groups)?TRUE:FALSE;
+		case RF_GROUP_TYPE_PREFIX:
+			return ((recipient & 0xFF) == OBJECT_ID)?TRUE:FALSE;
+		default:
+			return FALSE;
+	}
+#else
+	return recipient == my_base_station_id || recipient == 0xFFFFFFFF;
+#endif
+}
+
+//Objet : annonce  la station de base notre redmarrage, avec la version du firmware et ses capacits (voir registry.h).
+void RF_DIALOG_send_recent_reset(void)
+{
+	uint32_t capabilities = RF_DIALOG_CAPABILITY_GROUPS;
+	uint8_t datas[6];
+
+	if(USE_RF_DIALOG_COMPACT_HEADER)
+		capabilities |= RF_DIALOG_CAPABILITY_COMPACT_HEADER;
+	if(USE_RF_DIALOG_PACKING)
+		capabilities |= RF_DIALOG_CAPABILITY_PACKING;
+	if(USE_TIMESLOT)
+		capabilities |= RF_DIALOG_CAPABILITY_TIMESLOT;
+	if(USE_RF_CHANNEL_AGILITY)
+		capabilities |= RF_DIALOG_CAPABILITY_CHANNEL_AGILITY;
+	if(USE_RF_LINK_ADAPTATION)
+		capabilities |= RF_DIALOG_CAPABILITY_LINK_ADAPTATION;
+	if(OBJECT_RADIO_SLEEPS)
+		capabilities |= RF_DIALOG_CAPABILITY_SLEEPY;
+	datas[0] = (FIRMWARE_VERSION >> 8) & 0xFF;
+	datas[1] = FIRMWARE_VERSION & 0xFF;
+	datas[2] = (capabilities >> 24) & 0xFF;
+	datas[3] = (capabilities >> 16) & 0xFF;
+	datas[4] = (capabilities >> 8) & 0xFF;
+	datas[5] = capabilities & 0xFF;
+	RF_DIALOG_send_msg_id_to_basestation(RECENT_RESET, 6, datas);
+}
+
 
 static callback_fun_t callback_pong = NULL;
 
@@ -33,227 +225,1003 @@ void RF_DIALOG_set_callback_pong(callback_fun_t new_callback)
 	callback_pong = new_callback;
 }
 
-void RF_DIALOG_process_rx_object(nrf_esb_payload_t * payload){
+callback_fun_t RF_DIALOG_get_callback_pong(void)
+{
+	return callback_pong;
+}
 
-	uint8_t msg_id;
-	uint32_t recipient;
-	uint32_t emitter;
-	if(payload->length > BYTE_POS_DATASIZE && payload->length <= NRF_ESB_MAX_PAYLOAD_LENGTH)
+static void RF_DIALOG_handle_ack(rf_frame_t * frame);
+static void RF_DIALOG_handle_ping(rf_frame_t * frame);
+static void RF_DIALOG_handle_pong(rf_frame_t * frame);
+static void RF_DIALOG_handle_fragment(rf_frame_t * frame);
+static void RF_DIALOG_handle_stats_ask(rf_frame_t * frame);
+static void RF_DIALOG_handle_ping_start(rf_frame_t * frame);
+#if OBJECT_ID == OBJECT_BASE_STATION
+static void RF_DIALOG_handle_i_have_no_server_id(rf_frame_t * frame);
+static void RF_DIALOG_handle_short_address_ask(rf_frame_t * frame);
+#if USE_REGISTRY
+static void RF_DIALOG_handle_recent_reset(rf_frame_t * frame);
+static void RF_DIALOG_handle_parameter_is(rf_frame_t * frame);
+static void RF_DIALOG_handle_registry_ask(rf_frame_t * frame);
+#endif
+#else
+static void RF_DIALOG_handle_short_address_is(rf_frame_t * frame);
+static void RF_DIALOG_handle_channel_set(rf_frame_t * frame);
+static void RF_DIALOG_handle_link_tx_power(rf_frame_t * frame);
+static void RF_DIALOG_handle_ack_pipe_is(rf_frame_t * frame);
+static void RF_DIALOG_handle_short_address_revoked(rf_frame_t * frame);
+static void RF_DIALOG_handle_beacon(rf_frame_t * frame);
+static void RF_DIALOG_handle_ask_for_software_reset(rf_frame_t * frame);
+static void RF_DIALOG_handle_parameter_ask(rf_frame_t * frame);
+static void RF_DIALOG_handle_parameter_write(rf_frame_t * frame);
+#endif
+
+//Table d'aiguillage des messages reus, indexe par MSG_ID (accs direct).
+//Les entres NULL sont ignores ; un objet peut y accrocher ses propres traitements avec RF_DIALOG_register_handler().
+static rf_dialog_handler_t handlers[256] =
+{
+	[ACK]						= &RF_DIALOG_handle_ack,
+	[PING]						= &RF_DIALOG_handle_ping,
+	[PONG]						= &RF_DIALOG_handle_pong,
+	[FRAGMENT]					= &RF_DIALOG_handle_fragment,
+	[STATS_ASK]					= &RF_DIALOG_handle_stats_ask,
+	[PING_START]				= &RF_DIALOG_handle_ping_start,
+#if OBJECT_ID == OBJECT_BASE_STATION
+	//ASK_FOR_SOFTWARE_RESET : la station ne peut pas recevoir un software reset d'un objet, on ignore ce message.
+	[I_HAVE_NO_SERVER_ID]		= &RF_DIALOG_handle_i_have_no_server_id,
+	[SHORT_ADDRESS_ASK]			= &RF_DIALOG_handle_short_address_ask,
+#if USE_REGISTRY
+	[RECENT_RESET]				= &RF_DIALOG_handle_recent_reset,
+	[PARAMETER_IS]				= &RF_DIALOG_handle_parameter_is,
+	[REGISTRY_ASK]				= &RF_DIALOG_handle_registry_ask,
+#endif
+#else
+	[SHORT_ADDRESS_IS]			= &RF_DIALOG_handle_short_address_is,
+	[CHANNEL_SET]				= &RF_DIALOG_handle_channel_set,
+	[LINK_TX_POWER]				= &RF_DIALOG_handle_link_tx_power,
+	[ACK_PIPE_IS]				= &RF_DIALOG_handle_ack_pipe_is,
+	[SHORT_ADDRESS_REVOKED]		= &RF_DIALOG_handle_short_address_revoked,
+	[BEACON]					= &RF_DIALOG_handle_beacon,
+	[ASK_FOR_SOFTWARE_RESET]	= &RF_DIALOG_handle_ask_for_software_reset,
+	[PARAMETER_ASK]				= &RF_DIALOG_handle_parameter_ask,
+	[PARAMETER_WRITE]			= &RF_DIALOG_handle_parameter_write,
+#endif
+};
+
+//Installe handler pour les messages msg_id reus (NULL pour les ignorer). Renvoie le traitement prcdent, que le nouveau peut chaner.
+rf_dialog_handler_t RF_DIALOG_register_handler(msg_id_e msg_id, rf_dialog_handler_t handler)
+{
+	rf_dialog_handler_t previous;
+	previous = handlers[(uint8_t)msg_id];
+	handlers[(uint8_t)msg_id] = handler;
+	return previous;
+}
+
+//Dcode l'entte (complet ou compact, selon le pipe de rception) une seule fois. Aucune recopie : frame->datas pointe dans la payload.
+//Renvoie FALSE si la trame est mal forme, ou si elle est compacte et ne nous est pas destine.
+bool_e RF_DIALOG_frame_view(rf_frame_t * frame, nrf_esb_payload_t * payload)
+{
+	uint8_t datasize;
+	uint8_t header_size;
+
+	if(payload->length > NRF_ESB_MAX_PAYLOAD_LENGTH)
+		return FALSE;
+	frame->payload = payload;
+	frame->source = MSG_SOURCE_RF;
+	if(payload->pipe == RF_DIALOG_PIPE_COMPACT_HEADER)
+	{
+		if(payload->length < BYTE_POS_COMPACT_DATAS)
+			return FALSE;
+		if(!RF_DIALOG_expand_short_addresses(frame, payload->data[BYTE_POS_COMPACT_RECIPIENT], payload->data[BYTE_POS_COMPACT_EMITTER]))
+			return FALSE;
+		frame->msg_cnt = payload->data[BYTE_POS_COMPACT_MSG_CNT];
+		frame->msg_id = payload->data[BYTE_POS_COMPACT_MSG_ID];
+		datasize = payload->data[BYTE_POS_COMPACT_DATASIZE];
+		header_size = BYTE_POS_COMPACT_DATAS;
+		frame->relay_ttl = RF_RELAY_TTL_NONE;	//une trame compacte n'est jamais relaye
+	}
+	else
 	{
-		recipient = U32FROMU8( payload->data[BYTE_POS_RECIPIENTS],  payload->data[BYTE_POS_RECIPIENTS+1],  payload->data[BYTE_POS_RECIPIENTS+2],  payload->data[BYTE_POS_RECIPIENTS+3]);
-		emitter = U32FROMU8( payload->data[BYTE_POS_EMITTER],  payload->data[BYTE_POS_EMITTER+1],  payload->data[BYTE_POS_EMITTER+2],  payload->data[BYTE_POS_EMITTER+3]);
-		msg_id = payload->data[BYTE_POS_MSG_ID];
+		if(payload->length < BYTE_POS_DATAS)
+			return FALSE;
+		frame->recipient = U32FROMU8( payload->data[BYTE_POS_RECIPIENTS],  payload->data[BYTE_POS_RECIPIENTS+1],  payload->data[BYTE_POS_RECIPIENTS+2],  payload->data[BYTE_POS_RECIPIENTS+3]);
+		frame->emitter = U32FROMU8( payload->data[BYTE_POS_EMITTER],  payload->data[BYTE_POS_EMITTER+1],  payload->data[BYTE_POS_EMITTER+2],  payload->data[BYTE_POS_EMITTER+3]);
+		frame->msg_cnt = payload->data[BYTE_POS_MSG_CNT];
+		frame->msg_id = payload->data[BYTE_POS_MSG_ID];
+		datasize = payload->data[BYTE_POS_DATASIZE];
+		header_size = BYTE_POS_DATAS;
+		frame->relay_ttl = (datasize & DATASIZE_RELAY_TTL_MASK) >> DATASIZE_RELAY_TTL_SHIFT;
+	}
+	frame->ack_requested = (datasize & DATASIZE_FLAG_ACK_REQUEST)?TRUE:FALSE;
+	frame->datas = &payload->data[header_size];
+	frame->datasize = datasize & DATASIZE_MASK;
+	if(frame->datasize > payload->length - header_size)
+		frame->datasize = payload->length - header_size;	//trame tronque : les handlers ne lisent jamais au-del de la payload
+	return TRUE;
+}
 
-		switch(msg_id){
-			case RECENT_RESET :{//objet demarre (rf dialog init)
-				break;
-			}
-			case ASK_FOR_SOFTWARE_RESET :{//demande de la station de reset l'objet
-				NVIC_SystemReset();
-				break;
-			}
-			case PING :{
-				RF_DIALOG_send_msg_id_to_basestation(PONG,0,NULL);
-				break;
-			}
-			case PONG :{
+void RF_DIALOG_process_rx(rf_frame_t * frame)
+{
+	RF_DIALOG_ack_if_requested(frame);
+	RF_DIALOG_dispatch(frame);
+}
 
-				if(callback_pong != NULL)
-					callback_pong();
-				break;
-			}
-			case EVENT_OCCURED :{
-				break;
-			}
-			case PARAMETER_IS :{
-				//objet rpond demande ask  la base
+static void RF_DIALOG_dispatch(rf_frame_t * frame)
+{
+	rf_dialog_handler_t handler;
+	handler = handlers[frame->msg_id];
+	if(handler != NULL)
+		handler(frame);
+}
 
-				break;
-			}
-			case PARAMETER_ASK :{
-				param_id_e param;
-				uint8_t datas[5];
-				uint32_t value;
-				param = payload->data[BYTE_POS_DATAS];
-				value = PARAMETERS_get(param);
-				datas[0] = param;
-				datas[1] = (value>>24)&0xFF;
-				datas[2] = (value>>16)&0xFF;
-				datas[3] = (value>>8)&0xFF;
-				datas[4] = (value>>0)&0xFF;
-				RF_DIALOG_send_msg_id_to_basestation(PARAMETER_IS,5,datas);
-				break;
-			}
-			case PARAMETER_WRITE :{
-				// la base impose un parametre a l'objet
-				param_id_e param;
-				uint32_t value;
-				param = payload->data[BYTE_POS_DATAS];
-				value = U32FROMU8( payload->data[BYTE_POS_DATAS+1],  payload->data[BYTE_POS_DATAS+2],  payload->data[BYTE_POS_DATAS+3],  payload->data[BYTE_POS_DATAS+4]);
-				if(param < PARAM_32_BITS_NB)
-					PARAMETERS_update(param, value);
-				else
-					PARAMETERS_update_custom(param, &payload->data[BYTE_POS_DATAS+1]);
+//Rponse  l'metteur d'une trame reue : prioritaire sur la tlmtrie.
+static void RF_DIALOG_reply(rf_frame_t * frame, msg_id_e msg_id, uint8_t datasize, uint8_t * datas)
+{
+	RF_DIALOG_reply_with_priority(frame, msg_id, datasize, datas, TX_PRIORITY_REPLY);
+}
 
-				break;
-			}
-			case I_HAVE_NO_SERVER_ID :{
-				//RF_DIALOG_send_msg_id_to_basestation(I_HAVE_NO_SERVER_ID,0,NULL);
-				break;
-			}
+static void RF_DIALOG_reply_with_priority(rf_frame_t * frame, msg_id_e msg_id, uint8_t datasize, uint8_t * datas, tx_priority_e priority)
+{
+	if(OBJECT_ID == OBJECT_BASE_STATION)
+		RF_DIALOG_send_msg(frame->emitter, BASE_STATION_EMITTER_ID, msg_id, datasize, datas, priority);
+	else
+		RF_DIALOG_send_msg(my_base_station_id, OBJECT_ID, msg_id, datasize, datas, priority);
+}
+
+static void RF_DIALOG_handle_ack(rf_frame_t * frame)
+{
+	RF_DIALOG_process_ack(frame);
+}
 
-			case YOUR_SERVER_ID_IS :{
-				//server=server_id;
+static void RF_DIALOG_handle_ping(rf_frame_t * frame)
+{
+	//l'emmeteur du PING est le destinataire du PONG, qui lui renvoie ses datas (horodatage, voir rf_ping.h).
+	if(frame->source == MSG_SOURCE_UART)
+		SECRETARY_send_to_uart(frame->emitter, frame->recipient, PONG, frame->datasize, frame->datas);
+	else
+		RF_DIALOG_reply(frame, PONG, frame->datasize, frame->datas);
+}
+
+static void RF_DIALOG_handle_pong(rf_frame_t * frame)
+{
+	RF_PING_pong_received(frame);
+	if(callback_pong != NULL)
+		callback_pong();
+}
+
+static void RF_DIALOG_handle_ping_start(rf_frame_t * frame)
+{
+	RF_PING_start_received(frame);
+}
+
+//Page de statistiques demande (voir rf_stats.h) : rponse sur l'UART si la demande en vient, sinon  l'metteur, par morceaux si elle ne tient pas dans une trame.
+static void RF_DIALOG_handle_stats_ask(rf_frame_t * frame)
+{
+	uint8_t datas[RF_STATS_PAGE_MAX_SIZE];
+	uint8_t size;
+
+	if(frame->datasize < 2)
+		return;
+	size = RF_STATS_build_page(frame->datas[0], frame->datas[1], datas);
+	if(frame->source == MSG_SOURCE_UART)
+		SECRETARY_send_to_uart(frame->emitter, frame->recipient, STATS_IS, size, datas);
+	else if(OBJECT_ID == OBJECT_BASE_STATION)
+		RF_DIALOG_send_block_to_object(frame->emitter, STATS_IS, size, datas);
+	else
+		RF_DIALOG_send_block_to_basestation(STATS_IS, size, datas);
+}
+
+//Range le morceau dans son bloc. Une fois tous les morceaux reus, le bloc est trait comme un message MSG_ID ordinaire.
+static void RF_DIALOG_handle_fragment(rf_frame_t * frame)
+{
+	reassembly_slot_t * slot = NULL;
+	uint8_t xfer_id, index, fragment_nb, msg_id;
+	uint8_t size;
+	uint32_t now = SYSTICK_get_time_ms();
+	rf_frame_t block;
+
+	if(frame->datasize <= RF_DIALOG_FRAGMENT_HEADER_SIZE)
+		return;
+	xfer_id = frame->datas[0];
+	index = frame->datas[1];
+	fragment_nb = frame->datas[2];
+	msg_id = frame->datas[3];
+	size = frame->datasize - RF_DIALOG_FRAGMENT_HEADER_SIZE;
+	if(fragment_nb < 2 || fragment_nb > RF_DIALOG_FRAGMENT_MAX_NB || index >= fragment_nb)
+		return;
+	if(size == 0 || size > RF_DIALOG_FRAGMENT_DATA_SIZE || index*RF_DIALOG_FRAGMENT_DATA_SIZE + size > RF_DIALOG_BLOCK_MAX_SIZE)
+		return;	//une trame compacte peut porter plus qu'un morceau : le bloc dborderait de slot->datas
+	if(index < fragment_nb - 1 && size != RF_DIALOG_FRAGMENT_DATA_SIZE)
+		return;	//seul le dernier morceau peut tre incomplet
+
+	for(uint8_t i = 0; i < RF_DIALOG_REASSEMBLY_SLOTS_NB; i++)
+	{
+		if(reassembly_slots[i].used && reassembly_slots[i].emitter == frame->emitter && reassembly_slots[i].xfer_id == xfer_id)
+		{
+			slot = &reassembly_slots[i];
+			break;
+		}
+	}
+	if(slot == NULL)
+	{
+		for(uint8_t i = 0; i < RF_DIALOG_REASSEMBLY_SLOTS_NB; i++)
+		{
+			if(!reassembly_slots[i].used)
+			{
+				slot = &reassembly_slots[i];
 				break;
 			}
+		}
+		if(slot == NULL)
+			return;	//tous les emplacements sont occups : l'metteur devra recommencer son transfert
+		slot->used = TRUE;
+		slot->emitter = frame->emitter;
+		slot->xfer_id = xfer_id;
+		slot->msg_id = msg_id;
+		slot->fragment_nb = fragment_nb;
+		slot->received_mask = 0;
+		slot->size = 0;
+	}
+	if(slot->fragment_nb != fragment_nb || slot->msg_id != msg_id)
+		return;
 
-			default:
-				break;
+	slot->last_fragment_time = now;
+	if(slot->received_mask & (1UL << index))
+		return;	//morceau dj reu
+	slot->received_mask |= 1UL << index;
+	memcpy(&slot->datas[index*RF_DIALOG_FRAGMENT_DATA_SIZE], &frame->datas[RF_DIALOG_FRAGMENT_HEADER_SIZE], size);
+	if(index == fragment_nb - 1)
+		slot->size = index*RF_DIALOG_FRAGMENT_DATA_SIZE + size;
+
+	if(slot->received_mask == (1UL << fragment_nb) - 1)
+	{
+		slot->datas[slot->size] = 0;
+		block = *frame;
+		block.msg_id = slot->msg_id;
+		block.datas = slot->datas;
+		block.datasize = slot->size;
+		block.ack_requested = FALSE;
+		RF_DIALOG_dispatch(&block);
+		slot->used = FALSE;
+	}
+}
+
+//Traduit les adresses courtes d'une trame compacte en adresses compltes. Renvoie FALSE si la trame ne nous est pas destine ou vient d'un inconnu.
+static bool_e RF_DIALOG_expand_short_addresses(rf_frame_t * frame, uint8_t short_recipient, uint8_t short_emitter)
+{
+#if OBJECT_ID == OBJECT_BASE_STATION
+	if(short_recipient != SHORT_ADDRESS_BASE_STATION)
+		return FALSE;
+	if(short_emitter == SHORT_ADDRESS_BASE_STATION || short_emitter >= RF_DIALOG_SHORT_ADDRESSES_NB || short_addresses[short_emitter] == 0)
+	{
+		if(short_emitter != SHORT_ADDRESS_BASE_STATION && short_emitter != SHORT_ADDRESS_NONE)
+			short_address_to_revoke = short_emitter;	//adresse que nous n'avons pas (ou plus, aprs un reset) attribue : l'objet doit en redemander une
+		return FALSE;
+	}
+	frame->recipient = my_base_station_id;
+	frame->emitter = short_addresses[short_emitter];
+#else
+	if(my_short_address == SHORT_ADDRESS_NONE || short_recipient != my_short_address || short_emitter != SHORT_ADDRESS_BASE_STATION)
+		return FALSE;
+	frame->recipient = OBJECT_ID;
+	frame->emitter = BASE_STATION_EMITTER_ID;
+#endif
+	return TRUE;
+}
+
+//Adresse complte de l'objet d'adresse courte short_address (0 si inconnue). Station de base seulement ; appelable sous IT.
+uint32_t RF_DIALOG_get_address_from_short_address(uint8_t short_address)
+{
+#if OBJECT_ID == OBJECT_BASE_STATION
+	if(short_address != SHORT_ADDRESS_BASE_STATION && short_address < RF_DIALOG_SHORT_ADDRESSES_NB)
+		return short_addresses[short_address];
+#endif
+	return 0;
+}
+
+//Renvoie TRUE (et les adresses courtes) si la trame peut partir avec l'entte compact.
+static bool_e RF_DIALOG_get_short_addresses(uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint8_t * short_recipient, uint8_t * short_emitter)
+{
+#if USE_RF_DIALOG_COMPACT_HEADER
+	if(msg_id == SHORT_ADDRESS_ASK || msg_id == SHORT_ADDRESS_IS)
+		return FALSE;	//la jonction se fait toujours avec l'entte complet
+#if OBJECT_ID == OBJECT_BASE_STATION
+	if(emitter != BASE_STATION_EMITTER_ID || recipient == 0)
+		return FALSE;
+	if(RF_RELAY_is_relayed(recipient))
+		return FALSE;	//les relais n'entendent que l'entte complet
+	for(uint8_t i = 1; i < RF_DIALOG_SHORT_ADDRESSES_NB; i++)
+	{
+		if(short_addresses[i] == recipient)
+		{
+			*short_recipient = i;
+			*short_emitter = SHORT_ADDRESS_BASE_STATION;
+			return TRUE;
 		}
 	}
+	return FALSE;
+#else
+	if(my_short_address == SHORT_ADDRESS_NONE || emitter != OBJECT_ID || recipient != my_base_station_id)
+		return FALSE;
+	if(SECRETARY_get_ack_pipe() != RF_DIALOG_PIPE_FULL_HEADER)
+		return FALSE;	//les trames mises sur le pipe d'acquittement gardent l'entte complet
+	if(RF_RELAY_is_relay_mode())
+		return FALSE;	//les relais n'entendent que l'entte complet
+	*short_recipient = SHORT_ADDRESS_BASE_STATION;
+	*short_emitter = my_short_address;
+	return TRUE;
+#endif
+#else
+	return FALSE;
+#endif
 }
 
-void RF_DIALOG_process_rx_basestation(nrf_esb_payload_t * payload){
+//Place disponible pour les datas d'une trame de emitter vers recipient.
+static uint8_t RF_DIALOG_get_max_data_size(uint32_t recipient, uint32_t emitter)
+{
+	uint8_t short_recipient;
+	uint8_t short_emitter;
+	return RF_DIALOG_get_short_addresses(recipient, emitter, PACKED_MSGS, &short_recipient, &short_emitter)?COMPACT_FRAME_MAX_DATA_SIZE:FRAME_MAX_DATA_SIZE;
+}
 
-	uint8_t msg_id;
-	uint32_t recipient;
-	uint32_t emitter;
-	if(payload->length > BYTE_POS_DATASIZE && payload->length <= NRF_ESB_MAX_PAYLOAD_LENGTH)
+//Objet : demande priodique d'une adresse courte tant qu'il n'en a pas. Station : signale les adresses courtes inconnues.
+static void RF_DIALOG_process_short_address(void)
+{
+#if USE_RF_DIALOG_COMPACT_HEADER
+#if OBJECT_ID == OBJECT_BASE_STATION
+	uint8_t short_address;
+	if(short_address_to_revoke != SHORT_ADDRESS_NONE)
 	{
-		recipient = U32FROMU8( payload->data[BYTE_POS_RECIPIENTS],  payload->data[BYTE_POS_RECIPIENTS+1],  payload->data[BYTE_POS_RECIPIENTS+2],  payload->data[BYTE_POS_RECIPIENTS+3]);
-		emitter = U32FROMU8( payload->data[BYTE_POS_EMITTER],  payload->data[BYTE_POS_EMITTER+1],  payload->data[BYTE_POS_EMITTER+2],  payload->data[BYTE_POS_EMITTER+3]);
+		short_address = short_address_to_revoke;
+		short_address_to_revoke = SHORT_ADDRESS_NONE;
+		RF_DIALOG_send_msg(RF_BROADCAST_OBJECTS, BASE_STATION_EMITTER_ID, SHORT_ADDRESS_REVOKED, 1, &short_address, TX_PRIORITY_REPLY);
+	}
+#else
+	if(my_short_address == SHORT_ADDRESS_NONE && SYSTICK_get_time_ms() - last_join_time >= RF_DIALOG_JOIN_PERIOD)
+	{
+		last_join_time = SYSTICK_get_time_ms();
+		RF_DIALOG_send_msg(my_base_station_id, OBJECT_ID, SHORT_ADDRESS_ASK, 0, NULL, TX_PRIORITY_REPLY);
+	}
+#endif
+#endif
+}
 
-		msg_id = payload->data[BYTE_POS_MSG_ID];
+#if OBJECT_ID == OBJECT_BASE_STATION
+//Attribue (ou rappelle) l'adresse courte de l'metteur.
+static void RF_DIALOG_handle_short_address_ask(rf_frame_t * frame)
+{
+	uint8_t short_address = SHORT_ADDRESS_NONE;
+	uint8_t free_address = SHORT_ADDRESS_NONE;
+	for(uint8_t i = 1; i < RF_DIALOG_SHORT_ADDRESSES_NB; i++)
+	{
+		if(short_addresses[i] == frame->emitter)
+		{
+			short_address = i;
+			break;
+		}
+		if(short_addresses[i] == 0 && free_address == SHORT_ADDRESS_NONE)
+			free_address = i;
+	}
+	if(short_address == SHORT_ADDRESS_NONE)
+	{
+		if(free_address == SHORT_ADDRESS_NONE || frame->emitter == 0)
+			return;	//plus d'adresse courte disponible : l'objet continue avec l'entte complet
+		short_address = free_address;
+		short_addresses[short_address] = frame->emitter;
+	}
+	RF_DIALOG_reply(frame, SHORT_ADDRESS_IS, 1, &short_address);
+}
 
-		switch(msg_id){
-			case RECENT_RESET :{//objet demarre (rf dialog init)
-				//RF_DIALOG_send_msg_id_to_object(PARAMETER_ASK,/*datasize*/,/*data*/);
-				//TODO grer cet vnement de RESET d'objet dans une autre couche logicielle... pour voir s'il faut envoyer des messages sauvegards "long terme" pour cet objet.
-				break;
-			}
-			case ASK_FOR_SOFTWARE_RESET :{
-				/* la station ne peut pas recevoir un software reset d'un objet, on ignore ce message.*/
-				break;
-			}
-			case PING :{
-				//l'emmeteur du PING est le destinataire du PONG.
-				RF_DIALOG_send_msg_id_to_object(emitter, PONG,0,NULL);
-				break;
-			}
-			case PONG :{
+static void RF_DIALOG_handle_i_have_no_server_id(rf_frame_t * frame)
+{
+	uint8_t basestation[4];
+	basestation[0] = (my_base_station_id>>24)&0xFF;
+	basestation[1] = (my_base_station_id>>16)&0xFF;
+	basestation[2] = (my_base_station_id>>8)&0xFF;
+	basestation[3] = (my_base_station_id>>0)&0xFF;
+	RF_DIALOG_reply(frame, YOUR_SERVER_ID_IS, 4, basestation);
+	//TODO remplacer le FFFFFFFF par notre identifiant, en tant que basestation
+}
 
-				if(callback_pong != NULL)
-					callback_pong();
-				break;
-			}
-			case EVENT_OCCURED :{
-				/* traitement d'un vnement  dfinir*/
+#if USE_REGISTRY
+static void RF_DIALOG_handle_recent_reset(rf_frame_t * frame)
+{
+	if(frame->source == MSG_SOURCE_RF)
+		REGISTRY_report_reset(frame);
+}
 
-				break;
-			}
-			case PARAMETER_IS :{
-				/* parameter = value*/
+//Les PARAMETER_IS des objets restent transmis au serveur ; la station en garde la dernire valeur.
+static void RF_DIALOG_handle_parameter_is(rf_frame_t * frame)
+{
+	if(frame->source == MSG_SOURCE_RF && frame->datasize >= 5)
+		REGISTRY_cache_parameter(frame->emitter, frame->datas[0], U32FROMU8(frame->datas[1], frame->datas[2], frame->datas[3], frame->datas[4]));
+}
 
-				break;
-			}
-			case PARAMETER_ASK :{
-				/* ne peut pas recevoir de parameter_ask*/
-				break;
-			}
-			case PARAMETER_WRITE :{
-				// la base impose un parametre a l'objet
-				break;
-			}
-			case I_HAVE_NO_SERVER_ID :{
-				uint8_t basestation[4];
-				basestation[0] = (my_base_station_id>>24)&0xFF;
-				basestation[1] = (my_base_station_id>>16)&0xFF;
-				basestation[2] = (my_base_station_id>>8)&0xFF;
-				basestation[3] = (my_base_station_id>>0)&0xFF;
-				RF_DIALOG_send_msg_id_to_object(emitter, YOUR_SERVER_ID_IS,4,basestation);
-				//TODO remplacer le FFFFFFFF par notre identifiant, en tant que basestation
-				break;
-			}
+//REGISTRY_ASK = [DEVICE_ID(4)] : cet objet ; [RANK] : le RANK-ime objet du registre. Rponse REGISTRY_IS vide si aucun.
+static void RF_DIALOG_handle_registry_ask(rf_frame_t * frame)
+{
+	registry_entry_t * entry = NULL;
+	uint8_t datas[MAX_DATA_SIZE];
+	uint8_t size;
 
-			case YOUR_SERVER_ID_IS :{
+	if(frame->datasize >= 4)
+		entry = REGISTRY_find(U32FROMU8(frame->datas[0], frame->datas[1], frame->datas[2], frame->datas[3]));
+	else if(frame->datasize >= 1)
+		entry = REGISTRY_get_by_rank(frame->datas[0]);
+	size = REGISTRY_build_entry(entry, datas);
+	if(frame->source == MSG_SOURCE_UART)
+		SECRETARY_send_to_uart(frame->emitter, frame->recipient, REGISTRY_IS, size, datas);
+	else
+		RF_DIALOG_reply(frame, REGISTRY_IS, size, datas);
+}
+#endif
+#else
+static void RF_DIALOG_handle_short_address_is(rf_frame_t * frame)
+{
+	if(frame->datasize >= 1 && frame->datas[0] != SHORT_ADDRESS_BASE_STATION && frame->datas[0] < RF_DIALOG_SHORT_ADDRESSES_NB && frame->datas[0] != my_short_address)
+	{
+		my_short_address = frame->datas[0];
+		SECRETARY_set_rx_short_address(my_short_address);
+	}
+}
 
-				break;
-			}
+static void RF_DIALOG_handle_channel_set(rf_frame_t * frame)
+{
+	uint8_t flags;
+	if(frame->datasize >= 2 && frame->datasize >= 2 + frame->datas[1])
+	{
+		flags = (frame->datasize > 2 + frame->datas[1])?frame->datas[2 + frame->datas[1]]:0;
+		RF_CHANNEL_channel_set_received(frame->datas[0], frame->datas[1], &frame->datas[2], flags);
+	}
+}
 
-			default:
-				break;
-		}
+static void RF_DIALOG_handle_link_tx_power(rf_frame_t * frame)
+{
+	if(frame->datasize >= 1)
+		RF_LINK_tx_power_received((int8_t)frame->datas[0]);
+}
+
+static void RF_DIALOG_handle_ack_pipe_is(rf_frame_t * frame)
+{
+	if(frame->datasize >= 1)
+		SECRETARY_set_ack_pipe(frame->datas[0]);
+}
+
+static void RF_DIALOG_handle_short_address_revoked(rf_frame_t * frame)
+{
+	if(frame->datasize >= 1 && frame->datas[0] == my_short_address)
+	{
+		my_short_address = SHORT_ADDRESS_NONE;
+		SECRETARY_set_rx_short_address(SHORT_ADDRESS_NONE);
+		last_join_time = SYSTICK_get_time_ms() - RF_DIALOG_JOIN_PERIOD;	//nouvelle demande sans attendre
+	}
+}
+
+static void RF_DIALOG_handle_beacon(rf_frame_t * frame)
+{
+	TIMESLOT_beacon_received(SECRETARY_get_rx_time_us());
+	TIMEBASE_beacon_received(frame, SECRETARY_get_rx_time_us());
+}
+
+static void RF_DIALOG_handle_ask_for_software_reset(rf_frame_t * frame)
+{
+	NVIC_SystemReset();	//demande de la station de reset l'objet
+}
+
+static void RF_DIALOG_handle_parameter_ask(rf_frame_t * frame)
+{
+	param_id_e param;
+	uint8_t datas[5];
+	uint32_t value;
+	if(frame->datasize < 1)
+		return;
+	param = frame->datas[0];
+	value = PARAMETERS_get(param);
+	datas[0] = param;
+	datas[1] = (value>>24)&0xFF;
+	datas[2] = (value>>16)&0xFF;
+	datas[3] = (value>>8)&0xFF;
+	datas[4] = (value>>0)&0xFF;
+	RF_DIALOG_reply(frame, PARAMETER_IS, 5, datas);
+}
+
+static void RF_DIALOG_handle_parameter_write(rf_frame_t * frame)
+{
+	// la base impose un parametre a l'objet
+	param_id_e param;
+	uint32_t value;
+	if(frame->datasize < 1)
+		return;
+	param = frame->datas[0];
+	if(param < PARAM_32_BITS_NB)
+	{
+		if(frame->datasize < 5)
+			return;
+		value = U32FROMU8( frame->datas[1],  frame->datas[2],  frame->datas[3],  frame->datas[4]);
+		PARAMETERS_update(param, value);
+	}
+	else
+		PARAMETERS_update_custom(param, &frame->datas[1]);
+}
+#endif
+
+//Classe de priorite d'emission par defaut de chaque type de message.
+tx_priority_e RF_DIALOG_get_default_priority(msg_id_e msg_id)
+{
+	tx_priority_e ret;
+	switch(msg_id)
+	{
+		case EVENT_OCCURED:
+		case BEACON:		//le beacon rythme les crneaux de tout le rseau : il ne doit pas attendre
+			ret = TX_PRIORITY_ALERT;
+			break;
+		case PARAMETER_IS:
+		case BENCH_TRAFFIC:
+			ret = TX_PRIORITY_TELEMETRY;
+			break;
+		default:
+			ret = TX_PRIORITY_REPLY;	//messages de controle et commandes
+			break;
 	}
+	return ret;
 }
 
 void RF_DIALOG_send_msg_id_to_basestation(msg_id_e msg_id, uint8_t datasize, uint8_t * datas)
 {
-	uint8_t msg_to_send[NRF_ESB_MAX_PAYLOAD_LENGTH];
-	uint8_t size = 0;
+	RF_DIALOG_send_msg(my_base_station_id, OBJECT_ID, msg_id, datasize, datas, RF_DIALOG_get_default_priority(msg_id));
+}
 
-	msg_to_send[BYTE_POS_RECIPIENTS]   = (my_base_station_id>>24)	&0xFF;
-	msg_to_send[BYTE_POS_RECIPIENTS+1] = (my_base_station_id>>16)	&0xFF;
-	msg_to_send[BYTE_POS_RECIPIENTS+2] = (my_base_station_id>>8)	&0xFF;
-	msg_to_send[BYTE_POS_RECIPIENTS+3] = (my_base_station_id>>0)	&0xFF;
 
-	msg_to_send[BYTE_POS_EMITTER]   = (OBJECT_ID >>24) & 0xFF;
-	msg_to_send[BYTE_POS_EMITTER+1] = (OBJECT_ID >>16) & 0xFF;
-	msg_to_send[BYTE_POS_EMITTER+2] = (OBJECT_ID >>8) & 0xFF;
-	msg_to_send[BYTE_POS_EMITTER+3] = (OBJECT_ID >>0) & 0xFF;
+void RF_DIALOG_send_msg_id_to_object(recipient_e obj_id,msg_id_e msg_id, uint8_t datasize, uint8_t * datas)
+{
+	RF_DIALOG_send_msg(obj_id, BASE_STATION_EMITTER_ID, msg_id, datasize, datas, RF_DIALOG_get_default_priority(msg_id));
+}
 
+//Station : une seule mission pour tous les membres du groupe (RF_GROUP_MASK, RF_GROUP_TYPE ou RF_BROADCAST_OBJECTS).
+void RF_DIALOG_send_msg_id_to_group(uint32_t group, msg_id_e msg_id, uint8_t datasize, uint8_t * datas)
+{
+	RF_DIALOG_send_msg(group, BASE_STATION_EMITTER_ID, msg_id, datasize, datas, RF_DIALOG_get_default_priority(msg_id));
+}
 
-	msg_to_send[BYTE_POS_MSG_CNT] = index_msg_cnt;
-	index_msg_cnt++;
+void RF_DIALOG_send_beacon(void)
+{
+	uint8_t datas[TIMEBASE_BEACON_DATAS_SIZE];
+	uint8_t datasize;
 
-	msg_to_send[BYTE_POS_MSG_ID] = msg_id;
+	datasize = TIMEBASE_get_beacon_datas(datas);
+	RF_DIALOG_send_msg(RF_BROADCAST_OBJECTS, BASE_STATION_EMITTER_ID, BEACON, datasize, datas, TX_PRIORITY_ALERT);
+}
 
-	datasize = MIN(datasize, MAX_DATA_SIZE);
-	msg_to_send[BYTE_POS_DATASIZE] = datasize;
+void RF_DIALOG_send_channel_set(uint8_t current_index, uint8_t nb, uint8_t * channels, uint8_t flags)
+{
+	uint8_t datas[MAX_DATA_SIZE];
+	if(nb + 3 > RF_DIALOG_get_max_data_size(RF_BROADCAST_OBJECTS, BASE_STATION_EMITTER_ID))
+		return;	//un message diffus n'est pas dcoup en morceaux
+	datas[0] = current_index;
+	datas[1] = nb;
+	for(uint8_t i = 0; i < nb; i++)
+		datas[2+i] = channels[i];
+	datas[2+nb] = flags;
+	RF_DIALOG_send_msg(RF_BROADCAST_OBJECTS, BASE_STATION_EMITTER_ID, CHANNEL_SET, 3 + nb, datas, TX_PRIORITY_ALERT);
+}
 
-	for(uint8_t i = 0; i<datasize; i++)
+//Envoi fiable : le message est rmis (au plus RF_DIALOG_MAX_RETRIES fois, avec un dlai doubl  chaque essai) tant que le destinataire ne l'a pas acquitt.
+//Les alertes (TX_PRIORITY_ALERT) suivent leurs propres rgles, voir RF_DIALOG_send_event.
+//callback (optionnelle) est appele  l'issue, depuis la tache de fond. Renvoie FALSE si aucun emplacement n'est disponible.
+bool_e RF_DIALOG_send_msg_id_to_basestation_reliable(msg_id_e msg_id, uint8_t datasize, uint8_t * datas, rf_dialog_delivery_callback_t callback)
+{
+	return RF_DIALOG_send_msg_reliable(my_base_station_id, OBJECT_ID, msg_id, datasize, datas, callback);
+}
+
+bool_e RF_DIALOG_send_msg_id_to_object_reliable(recipient_e obj_id, msg_id_e msg_id, uint8_t datasize, uint8_t * datas, rf_dialog_delivery_callback_t callback)
+{
+	return RF_DIALOG_send_msg_reliable(obj_id, BASE_STATION_EMITTER_ID, msg_id, datasize, datas, callback);
+}
+
+//Alerte vers la station de base : EVENT_OCCURED = [EVENT DATAS...], envoy en mode fiable sur le chemin rapide des alertes.
+//	Renvoie FALSE si aucun emplacement fiable n'est libre ou si l'alerte ne tient pas dans une trame (une alerte n'est pas dcoupe en morceaux).
+//	File TX_PRIORITY_ALERT, mise mme hors de notre crneau (voir SECRETARY_start_next_tx). Trame sans acquittement ESB : une perte
+//	n'est rattrape que par les ressais de l'envoi fiable.
+//	Emplacement fiable rserv, ressais sans backoff (RF_DIALOG_ALERT_ACK_TIMEOUT) : la latence est borne, mme rseau satur.
+//	La station acquitte en TX_PRIORITY_ALERT et traite la trame avant celles qui attendent dans sa FIFO de rception.
+bool_e RF_DIALOG_send_event(event_e event, uint8_t datasize, uint8_t * datas, rf_dialog_delivery_callback_t callback)
+{
+	uint8_t msg[MAX_DATA_SIZE];
+
+	if(1 + datasize > RF_DIALOG_get_max_data_size(my_base_station_id, OBJECT_ID))
+		return FALSE;
+	msg[0] = event;
+	for(uint8_t i = 0; i < datasize; i++)
+		msg[1+i] = datas[i];
+	return RF_DIALOG_send_msg_reliable(my_base_station_id, OBJECT_ID, EVENT_OCCURED, 1 + datasize, msg, callback);
+}
+
+//Envoi d'un bloc de taille quelconque (jusqu' RF_DIALOG_BLOCK_MAX_SIZE) : s'il ne tient pas dans une trame, il est dcoup en messages FRAGMENT.
+//Le bloc est recopi, datas peut tre rutilis ds le retour. Renvoie FALSE si le bloc est trop grand ou si un transfert est dj en cours.
+bool_e RF_DIALOG_send_block_to_basestation(msg_id_e msg_id, uint16_t size, uint8_t * datas)
+{
+	return RF_DIALOG_send_block(my_base_station_id, OBJECT_ID, msg_id, size, datas);
+}
+
+bool_e RF_DIALOG_send_block_to_object(recipient_e obj_id, msg_id_e msg_id, uint16_t size, uint8_t * datas)
+{
+	return RF_DIALOG_send_block(obj_id, BASE_STATION_EMITTER_ID, msg_id, size, datas);
+}
+
+static bool_e RF_DIALOG_send_block(uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint16_t size, uint8_t * datas)
+{
+	if(size <= RF_DIALOG_get_max_data_size(recipient, emitter))
 	{
-		msg_to_send[BYTE_POS_DATAS+i] = datas[i];
+		RF_DIALOG_send_msg(recipient, emitter, msg_id, size, datas, RF_DIALOG_get_default_priority(msg_id));
+		return TRUE;
 	}
+	if(size > RF_DIALOG_BLOCK_MAX_SIZE || fragmented_tx.pending)
+		return FALSE;
+
+	fragmented_tx.recipient = recipient;
+	fragmented_tx.emitter = emitter;
+	fragmented_tx.xfer_id++;
+	fragmented_tx.msg_id = msg_id;
+	fragmented_tx.size = size;
+	fragmented_tx.fragment_nb = (size + RF_DIALOG_FRAGMENT_DATA_SIZE - 1) / RF_DIALOG_FRAGMENT_DATA_SIZE;
+	fragmented_tx.next_fragment = 0;
+	fragmented_tx.priority = RF_DIALOG_get_default_priority(msg_id);
+	memcpy(fragmented_tx.datas, datas, size);
+	fragmented_tx.pending = TRUE;
+	RF_DIALOG_process_fragmented_tx();
+	return TRUE;
+}
 
+//Confie les morceaux suivants  la file d'mission, sans jamais l'occuper  plus de moiti pour laisser passer les autres messages.
+static void RF_DIALOG_process_fragmented_tx(void)
+{
+	uint8_t frame[NRF_ESB_MAX_PAYLOAD_LENGTH];
+	uint8_t datas[RF_DIALOG_FRAGMENT_HEADER_SIZE + RF_DIALOG_FRAGMENT_DATA_SIZE];	//= FRAME_MAX_DATA_SIZE, qui tient quel que soit l'entte
+	uint8_t frame_size;
+	uint8_t pipe;
+	uint8_t size;
+	uint16_t offset;
+	tx_queue_stats_t stats;
 
-	SECRETARY_send_msg(BYTE_POS_DATAS+datasize, msg_to_send);
+	while(fragmented_tx.pending)
+	{
+		SECRETARY_get_tx_queue_stats(fragmented_tx.priority, &stats);
+		if(stats.depth >= TX_QUEUE_SIZE/2)
+			break;	//on reprendra au prochain passage dans la tache de fond
+
+		offset = fragmented_tx.next_fragment * RF_DIALOG_FRAGMENT_DATA_SIZE;
+		size = (fragmented_tx.size - offset > RF_DIALOG_FRAGMENT_DATA_SIZE)?RF_DIALOG_FRAGMENT_DATA_SIZE:(fragmented_tx.size - offset);
+		datas[0] = fragmented_tx.xfer_id;
+		datas[1] = fragmented_tx.next_fragment;
+		datas[2] = fragmented_tx.fragment_nb;
+		datas[3] = fragmented_tx.msg_id;
+		memcpy(&datas[RF_DIALOG_FRAGMENT_HEADER_SIZE], &fragmented_tx.datas[offset], size);
+		frame_size = RF_DIALOG_build_frame(frame, &pipe, fragmented_tx.recipient, fragmented_tx.emitter, FRAGMENT, RF_DIALOG_FRAGMENT_HEADER_SIZE + size, datas);
+		SECRETARY_send_msg_on_pipe(fragmented_tx.priority, pipe, frame_size, frame);
+
+		fragmented_tx.next_fragment++;
+		if(fragmented_tx.next_fragment == fragmented_tx.fragment_nb)
+			fragmented_tx.pending = FALSE;
+	}
 }
 
+//Libre les blocs dont le rassemblage n'avance plus (morceau perdu).
+static void RF_DIALOG_process_reassembly_timeouts(void)
+{
+	uint32_t now = SYSTICK_get_time_ms();
+	for(uint8_t i = 0; i < RF_DIALOG_REASSEMBLY_SLOTS_NB; i++)
+	{
+		if(reassembly_slots[i].used && now - reassembly_slots[i].last_fragment_time >= RF_DIALOG_REASSEMBLY_TIMEOUT)
+			reassembly_slots[i].used = FALSE;
+	}
+}
 
-void RF_DIALOG_send_msg_id_to_object(recipient_e obj_id,msg_id_e msg_id, uint8_t datasize, uint8_t * datas){
-	uint8_t msg_to_send[NRF_ESB_MAX_PAYLOAD_LENGTH];
-		uint8_t size = 0;
+static bool_e RF_DIALOG_send_msg_reliable(uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint8_t datasize, uint8_t * datas, rf_dialog_delivery_callback_t callback)
+{
+	reliable_slot_t * slot = NULL;
+	uint32_t primask;
+	tx_priority_e priority;
+	uint8_t slots_nb;
 
-		msg_to_send[BYTE_POS_RECIPIENTS]   = (obj_id>>24)	&0xFF;
-		msg_to_send[BYTE_POS_RECIPIENTS+1] = (obj_id>>16)	&0xFF;
-		msg_to_send[BYTE_POS_RECIPIENTS+2] = (obj_id>>8)	&0xFF;
-		msg_to_send[BYTE_POS_RECIPIENTS+3] = (obj_id>>0)	&0xFF;
+	if(RF_DIALOG_IS_MULTICAST(recipient))
+		return FALSE;	//les membres d'un groupe n'acquittent pas
+	if(datasize > RF_DIALOG_get_max_data_size(recipient, emitter))
+		return FALSE;	//la trame est rmise telle quelle : elle ne peut pas tre dcoupe en morceaux
+	priority = RF_DIALOG_get_default_priority(msg_id);
+	if(priority == TX_PRIORITY_TELEMETRY)
+		priority = TX_PRIORITY_REPLY;		//un message fiable ne doit pas attendre derrire la tlmtrie
+	slots_nb = (priority == TX_PRIORITY_ALERT)?RF_DIALOG_RELIABLE_SLOTS_NB:(RF_DIALOG_RELIABLE_SLOTS_NB - 1);	//une alerte trouve toujours sa place
+	primask = __get_PRIMASK();
+	__disable_irq();
+	for(uint8_t i = 0; i < slots_nb; i++)
+	{
+		if(!reliable_slots[i].used)
+		{
+			slot = &reliable_slots[i];
+			slot->used = TRUE;
+			break;
+		}
+	}
+	__set_PRIMASK(primask);
 
-		msg_to_send[BYTE_POS_EMITTER]   = (0xFF >>24) & 0xFF;	//TODO grer l'identifiant unique station (autre que FFFFFFFF)
-		msg_to_send[BYTE_POS_EMITTER+1] = (0xFF >>16) & 0xFF;
-		msg_to_send[BYTE_POS_EMITTER+2] = (0xFF >>8) & 0xFF;
-		msg_to_send[BYTE_POS_EMITTER+3] = (0xFF >>0) & 0xFF;
+	if(slot == NULL)
+		return FALSE;
 
-		msg_to_send[BYTE_POS_MSG_CNT] = index_msg_cnt;
-		index_msg_cnt++;
+	slot->recipient = recipient;
+	slot->msg_id = msg_id;
+	slot->frame_size = RF_DIALOG_build_frame(slot->frame, &slot->pipe, recipient, emitter, msg_id, datasize, datas);
+	if(slot->pipe == RF_DIALOG_PIPE_COMPACT_HEADER)
+	{
+		slot->frame[BYTE_POS_COMPACT_DATASIZE] |= DATASIZE_FLAG_ACK_REQUEST;
+		slot->msg_cnt = slot->frame[BYTE_POS_COMPACT_MSG_CNT];
+	}
+	else
+	{
+		slot->frame[BYTE_POS_DATASIZE] |= DATASIZE_FLAG_ACK_REQUEST;
+		slot->msg_cnt = slot->frame[BYTE_POS_MSG_CNT];
+	}
+	slot->priority = priority;
+	slot->retries_remaining = (priority == TX_PRIORITY_ALERT)?RF_DIALOG_ALERT_MAX_RETRIES:RF_DIALOG_MAX_RETRIES;
+	slot->timeout = (priority == TX_PRIORITY_ALERT)?RF_DIALOG_ALERT_ACK_TIMEOUT:RF_DIALOG_ACK_TIMEOUT;
+	slot->callback = callback;
+	slot->last_try_time = SYSTICK_get_time_ms();
+	slot->first_try_time = slot->last_try_time;
 
-		msg_to_send[BYTE_POS_MSG_ID] = msg_id;
+	SECRETARY_send_msg_on_pipe(slot->priority, slot->pipe, slot->frame_size, slot->frame);
+	return TRUE;
+}
 
-		datasize = MIN(datasize, MAX_DATA_SIZE);
-		msg_to_send[BYTE_POS_DATASIZE] = datasize;
+//L'metteur 0xFF utilis par la station de base ne correspond pas  l'adresse  laquelle les objets la joignent.
+static bool_e RF_DIALOG_is_same_node(uint32_t address, uint32_t emitter)
+{
+	return address == emitter || (address == my_base_station_id && emitter == BASE_STATION_EMITTER_ID);
+}
 
-		for(uint8_t i = 0; i<datasize; i++)
+static void RF_DIALOG_ack_if_requested(rf_frame_t * frame)
+{
+	uint8_t datas[2];
+	if(frame->ack_requested && !RF_DIALOG_IS_MULTICAST(frame->recipient))	//tous les membres rpondraient en mme temps
+	{
+		datas[0] = frame->msg_cnt;
+		datas[1] = frame->msg_id;
+		//l'metteur rmet tant que l'ACK n'est pas arriv : il part sans attendre notre crneau (voir SECRETARY_start_next_tx)
+		RF_DIALOG_reply_with_priority(frame, ACK, 2, datas, TX_PRIORITY_ALERT);
+	}
+}
+
+void RF_DIALOG_ack_duplicate(rf_frame_t * frame)
+{
+	RF_DIALOG_ack_if_requested(frame);	//notre premier ACK a pu tre perdu : on acquitte de nouveau, sans retraiter le message.
+}
+
+static void RF_DIALOG_process_ack(rf_frame_t * frame)
+{
+	reliable_slot_t * slot;
+	rf_dialog_delivery_callback_t callback;
+
+	if(frame->datasize < 2)
+		return;
+
+	for(uint8_t i = 0; i < RF_DIALOG_RELIABLE_SLOTS_NB; i++)
+	{
+		slot = &reliable_slots[i];
+		if(slot->used && slot->msg_cnt == frame->datas[0] && slot->msg_id == frame->datas[1] && RF_DIALOG_is_same_node(slot->recipient, frame->emitter))
 		{
-			msg_to_send[BYTE_POS_DATAS+i] = datas[i];
+			callback = slot->callback;
+			slot->used = FALSE;
+			RF_CHANNEL_report_tx_result(TRUE);
+			RF_LINK_report_tx_result(slot->recipient, TRUE);
+			RF_STATS_report_reliable(slot->recipient, slot->msg_id, TRUE, SYSTICK_get_time_ms() - slot->first_try_time);
+			if(callback != NULL)
+				callback(slot->msg_id, TRUE);
+			break;
 		}
+	}
+}
+
+//Rmission des messages fiables dont l'ACK n'est pas arriv  temps, abandon une fois les essais puiss.
+static void RF_DIALOG_process_reliable_slots(void)
+{
+	reliable_slot_t * slot;
+	uint32_t now = SYSTICK_get_time_ms();
+
+	for(uint8_t i = 0; i < RF_DIALOG_RELIABLE_SLOTS_NB; i++)
+	{
+		slot = &reliable_slots[i];
+		if(!slot->used || now - slot->last_try_time < slot->timeout)
+			continue;
+
+		RF_CHANNEL_report_tx_result(FALSE);
+		RF_LINK_report_tx_result(slot->recipient, FALSE);
+		RF_STATS_report_reliable(slot->recipient, slot->msg_id, FALSE, 0);
+		if(slot->retries_remaining)
+		{
+			slot->retries_remaining--;
+			if(slot->priority == TX_PRIORITY_ALERT)	//pas de backoff, pour borner la latence ; un tirage spare deux alertes en collision
+				slot->timeout = RF_DIALOG_ALERT_ACK_TIMEOUT + RF_DIALOG_random() % RF_DIALOG_ALERT_ACK_TIMEOUT;
+			else	//backoff exponentiel, dcal selon l'objet pour que deux metteurs en collision ne rmettent pas ensemble.
+				slot->timeout = 2*slot->timeout + (OBJECT_ID % 4)*(RF_DIALOG_ACK_TIMEOUT/4);
+			slot->last_try_time = now;
+			SECRETARY_send_msg_on_pipe(slot->priority, slot->pipe, slot->frame_size, slot->frame);
+		}
+		else
+		{
+			slot->used = FALSE;
+			if(slot->callback != NULL)
+				slot->callback(slot->msg_id, FALSE);
+		}
+	}
+}
+
+static void RF_DIALOG_send_msg(uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint8_t datasize, uint8_t * datas, tx_priority_e priority)
+{
+#if USE_RF_DIALOG_PACKING
+	if(priority == TX_PRIORITY_TELEMETRY && RF_DIALOG_pack_msg(recipient, emitter, msg_id, datasize, datas))
+		return;	//le message partira dans une trame groupe.
+#endif
+	RF_DIALOG_send_frame(recipient, emitter, msg_id, datasize, datas, priority);
+}
+
+void RF_DIALOG_process_main(void)
+{
+	RF_DIALOG_process_reliable_slots();
+	RF_DIALOG_process_fragmented_tx();
+	RF_DIALOG_process_reassembly_timeouts();
+	RF_DIALOG_process_short_address();
+#if USE_RF_DIALOG_PACKING
+	if(packed_msgs.pending && SYSTICK_get_time_ms() - packed_msgs.first_msg_time >= RF_DIALOG_PACKING_WINDOW)
+		RF_DIALOG_flush_packed_msgs();
+#endif
+}
+
+#if USE_RF_DIALOG_PACKING
+//Ajoute le message au groupe en cours. Le groupe est envoy au pralable s'il concerne un autre destinataire ou s'il n'a plus la place.
+//Renvoie FALSE si le message est trop gros pour tre group : il doit alors tre envoy seul (le groupe prcdent est dj parti).
+static bool_e RF_DIALOG_pack_msg(uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint8_t datasize, uint8_t * datas)
+{
+	bool_e packed = FALSE;
+	uint32_t primask;
+
+	if(packed_msgs.pending && (packed_msgs.recipient != recipient || packed_msgs.emitter != emitter || packed_msgs.size + 2 + datasize > packed_msgs.capacity))
+		RF_DIALOG_flush_packed_msgs();
+
+	if(2 + datasize > RF_DIALOG_get_max_data_size(recipient, emitter))
+		return FALSE;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if(!packed_msgs.pending)
+	{
+		packed_msgs.pending = TRUE;
+		packed_msgs.recipient = recipient;
+		packed_msgs.emitter = emitter;
+		packed_msgs.size = 0;
+		packed_msgs.capacity = RF_DIALOG_get_max_data_size(recipient, emitter);
+		packed_msgs.msg_nb = 0;
+		packed_msgs.first_msg_time = SYSTICK_get_time_ms();
+	}
+	if(packed_msgs.recipient == recipient && packed_msgs.emitter == emitter && packed_msgs.size + 2 + datasize <= packed_msgs.capacity)
+	{
+		packed_msgs.datas[packed_msgs.size++] = msg_id;
+		packed_msgs.datas[packed_msgs.size++] = datasize;
+		for(uint8_t i = 0; i<datasize; i++)
+			packed_msgs.datas[packed_msgs.size++] = datas[i];
+		packed_msgs.msg_nb++;
+		packed = TRUE;
+	}
+	__set_PRIMASK(primask);
+
+	if(packed && packed_msgs.size + 2 > packed_msgs.capacity)
+		RF_DIALOG_flush_packed_msgs();	//plus aucun message ne pourra rentrer, inutile d'attendre.
+
+	return packed;
+}
+#endif
+
+//Envoie immdiatement le groupe de messages en attente (s'il y en a un).
+void RF_DIALOG_flush_packed_msgs(void)
+{
+#if USE_RF_DIALOG_PACKING
+	packed_msgs_t local;
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	local = packed_msgs;
+	packed_msgs.pending = FALSE;
+	__set_PRIMASK(primask);
+
+	if(!local.pending)
+		return;
 
+	if(local.msg_nb == 1)	//un seul message : inutile de payer l'entte du groupe.
+		RF_DIALOG_send_frame(local.recipient, local.emitter, local.datas[0], local.datas[1], &local.datas[2], TX_PRIORITY_TELEMETRY);
+	else if(local.size > RF_DIALOG_get_max_data_size(local.recipient, local.emitter))
+	{
+		//l'adresse courte a t perdue depuis la constitution du groupe, qui ne tient plus dans une trame : les messages partent un par un.
+		for(uint8_t index = 0; index + 2 <= local.size; index += 2 + local.datas[index+1])
+			RF_DIALOG_send_frame(local.recipient, local.emitter, local.datas[index], local.datas[index+1], &local.datas[index+2], TX_PRIORITY_TELEMETRY);
+	}
+	else
+		RF_DIALOG_send_frame(local.recipient, local.emitter, PACKED_MSGS, local.size, local.datas, TX_PRIORITY_TELEMETRY);
+#endif
+}
+
+static void RF_DIALOG_send_frame(uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint8_t datasize, uint8_t * datas, tx_priority_e priority)
+{
+	uint8_t msg_to_send[NRF_ESB_MAX_PAYLOAD_LENGTH];
+	uint8_t size;
+	uint8_t pipe;
+
+	if(datasize > RF_DIALOG_get_max_data_size(recipient, emitter))
+	{
+		//le message ne tient pas dans une trame (place rduite par la protection, voir rf_secure.h) : il part en morceaux.
+		//Si un transfert est dj en cours, il est abandonn plutt que tronqu.
+		RF_DIALOG_send_block(recipient, emitter, msg_id, datasize, datas);
+		return;
+	}
+
+	size = RF_DIALOG_build_frame(msg_to_send, &pipe, recipient, emitter, msg_id, datasize, datas);
+	SECRETARY_send_msg_on_pipe(priority, pipe, size, msg_to_send);
+}
+
+static uint8_t RF_DIALOG_next_msg_cnt(uint32_t recipient)
+{
+	if(RF_DIALOG_IS_MULTICAST(recipient))
+		return msg_cnt_per_multicast[recipient % MSG_CNT_MULTICAST_TABLE_SIZE]++;
+	return msg_cnt_per_recipient[recipient % MSG_CNT_TABLE_SIZE]++;
+}
+
+//Construit la trame dans msg_to_send (NRF_ESB_MAX_PAYLOAD_LENGTH octets) et renvoie sa taille.
+//L'entte compact est utilis ds que les deux extrmits ont une adresse courte : pipe indique alors RF_DIALOG_PIPE_COMPACT_HEADER.
+static uint8_t RF_DIALOG_build_frame(uint8_t * msg_to_send, uint8_t * pipe, uint32_t recipient, uint32_t emitter, msg_id_e msg_id, uint8_t datasize, uint8_t * datas)
+{
+	uint8_t short_recipient;
+	uint8_t short_emitter;
+
+	if(RF_DIALOG_get_short_addresses(recipient, emitter, msg_id, &short_recipient, &short_emitter))
+	{
+		*pipe = RF_DIALOG_PIPE_COMPACT_HEADER;
+		msg_to_send[BYTE_POS_COMPACT_RECIPIENT] = short_recipient;
+		msg_to_send[BYTE_POS_COMPACT_EMITTER] = short_emitter;
+		msg_to_send[BYTE_POS_COMPACT_MSG_CNT] = RF_DIALOG_next_msg_cnt(recipient);
+		msg_to_send[BYTE_POS_COMPACT_MSG_ID] = msg_id;
+		datasize = MIN(datasize, COMPACT_FRAME_MAX_DATA_SIZE);
+		msg_to_send[BYTE_POS_COMPACT_DATASIZE] = datasize;
+		for(uint8_t i = 0; i<datasize; i++)
+			msg_to_send[BYTE_POS_COMPACT_DATAS+i] = datas[i];
+		return BYTE_POS_COMPACT_DATAS+datasize;
+	}
+
+	*pipe = RF_DIALOG_PIPE_FULL_HEADER;
+	msg_to_send[BYTE_POS_RECIPIENTS]   = (recipient>>24)	&0xFF;
+	msg_to_send[BYTE_POS_RECIPIENTS+1] = (recipient>>16)	&0xFF;
+	msg_to_send[BYTE_POS_RECIPIENTS+2] = (recipient>>8)	&0xFF;
+	msg_to_send[BYTE_POS_RECIPIENTS+3] = (recipient>>0)	&0xFF;
+
+	msg_to_send[BYTE_POS_EMITTER]   = (emitter >>24) & 0xFF;
+	msg_to_send[BYTE_POS_EMITTER+1] = (emitter >>16) & 0xFF;
+	msg_to_send[BYTE_POS_EMITTER+2] = (emitter >>8) & 0xFF;
+	msg_to_send[BYTE_POS_EMITTER+3] = (emitter >>0) & 0xFF;
+
+	msg_to_send[BYTE_POS_MSG_CNT] = RF_DIALOG_next_msg_cnt(recipient);
+
+	msg_to_send[BYTE_POS_MSG_ID] = msg_id;
+
+	datasize = MIN(datasize, FRAME_MAX_DATA_SIZE);
+	msg_to_send[BYTE_POS_DATASIZE] = datasize;
+
+	for(uint8_t i = 0; i<datasize; i++)
+	{
+		msg_to_send[BYTE_POS_DATAS+i] = datas[i];
+	}
 
-		SECRETARY_send_msg(BYTE_POS_DATAS+datasize, msg_to_send);
+	return BYTE_POS_DATAS+datasize;
 }
 
 void RF_dialog_sample_bank(void) // C'EST UN EXEMPLE!!!!!
 {
-	RF_DIALOG_send_msg_id_to_basestation(RECENT_RESET, 0, NULL);
+	RF_DIALOG_send_recent_reset();
 	uint8_t param_id = 12;
 	RF_DIALOG_send_msg_id_to_basestation(PARAMETER_ASK, 1, &param_id);
 
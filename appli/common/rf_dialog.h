@@ -9,6 +9,8 @@
 #define APPLI_COMMON_RF_DIALOG_H_
 #include "appli/config.h"
 #include "nrf_esb.h"
+#include "secretary.h"
+#include "rf_secure.h"
 
 //Constitution d'un message.
 //				Master Group RECIPIENTS(6) MSG_ID DATASIZE DATAS
@@ -19,16 +21,66 @@
 #define BYTE_POS_MSG_CNT	(BYTE_POS_EMITTER+BYTE_QTY_RECIPIENTS)
 #define BYTE_POS_MSG_ID		(BYTE_POS_MSG_CNT+1)
 #define BYTE_POS_DATASIZE	(BYTE_POS_MSG_ID+1)
+	#define DATASIZE_MASK				(0x1F)	//les 5 bits de poids faible donnent la taille des datas
+	#define DATASIZE_RELAY_TTL_MASK		(0x60)	//TTL de relais (entte complet uniquement, voir rf_relay.h)
+	#define DATASIZE_RELAY_TTL_SHIFT	(5)
+	#define DATASIZE_FLAG_ACK_REQUEST	(0x80)	//l'metteur attend un message ACK en retour
 #define BYTE_POS_DATAS		(BYTE_POS_DATASIZE+1)
 #define MAX_DATA_SIZE		(32-BYTE_POS_DATAS)
 
+//Entte compact, utilis entre un objet et sa station de base une fois que celle-ci lui a attribu une adresse courte.
+//				RECIPIENT(1) EMITTER(1) MSG_CNT MSG_ID DATASIZE DATAS
+//Le format est indiqu par le pipe ESB d'mission : les trames de jonction et de diffusion gardent l'entte complet.
+#define RF_DIALOG_PIPE_FULL_HEADER		0
+#define RF_DIALOG_PIPE_COMPACT_HEADER	1
+//Pipes d'acquittement (entte complet) : la station en attribue un  chaque objet  la radio endormie (ACK_PIPE_IS).
+//L'objet y met ses trames vers la station en demandant l'acquittement ESB, qui lui apporte ses messages en attente (voir mailbox.h).
+//Leurs prfixes sont hors de la plage des adresses courtes (0xC0  0xDF).
+#define RF_DIALOG_PIPE_ACK_FIRST		3
+#define RF_DIALOG_PIPE_ACK_LAST			7
+#define RF_DIALOG_ACK_PIPE_PREFIX(pipe)	(0xA0 | (pipe))
+#define BYTE_POS_COMPACT_RECIPIENT	(0)
+#define BYTE_POS_COMPACT_EMITTER	(1)
+#define BYTE_POS_COMPACT_MSG_CNT	(2)
+#define BYTE_POS_COMPACT_MSG_ID		(3)
+#define BYTE_POS_COMPACT_DATASIZE	(4)
+#define BYTE_POS_COMPACT_DATAS		(5)
+#define COMPACT_MAX_DATA_SIZE		(32-BYTE_POS_COMPACT_DATAS)
+
+//Datas rellement transportes par une trame, une fois retire la place prise par la protection (voir rf_secure.h).
+//MAX_DATA_SIZE et COMPACT_MAX_DATA_SIZE restent la taille des tampons.
+#define FRAME_MAX_DATA_SIZE			(MAX_DATA_SIZE-RF_SECURE_OVERHEAD)
+#define COMPACT_FRAME_MAX_DATA_SIZE	(COMPACT_MAX_DATA_SIZE-RF_SECURE_COMPACT_OVERHEAD)
+
+#define SHORT_ADDRESS_BASE_STATION	(0x00)
+#define SHORT_ADDRESS_NONE			(0xFF)	//pas (encore) d'adresse courte : entte complet
+#define RF_DIALOG_SHORT_ADDRESSES_NB	32	//nombre d'adresses courtes distribues par la station de base (0 est la sienne)
+#define RF_DIALOG_JOIN_PERIOD		5000	//[ms] priode des demandes d'adresse courte d'un objet qui n'en a pas
+
 
 typedef enum{
-	RECENT_RESET 				= 0x02,
+	RECENT_RESET 				= 0x02,		//objet -> station, au dmarrage : DATAS = [FIRMWARE_VERSION(2) CAPABILITIES(4)] (RF_DIALOG_CAPABILITY_...)
 	ASK_FOR_SOFTWARE_RESET		= 0x03,
-	PING						= 0x16,
+	PING						= 0x16,		//DATAS = [] ou [SEQ(2) TIME_US(4)], renvoyes telles quelles dans le PONG
 	PONG						= 0x06,
-	EVENT_OCCURED				= 0x30,
+	ACK							= 0x07,		//acquittement d'un message envoy avec DATASIZE_FLAG_ACK_REQUEST : DATAS = [MSG_CNT MSG_ID] du message acquitt
+	BEACON						= 0x08,		//dbut de supertrame, mis par la station de base vers RF_BROADCAST_OBJECTS. DATAS = [] ou [SEQ TX_TIME_US(4)] (voir timebase.h)
+	FRAGMENT					= 0x09,		//morceau d'un bloc plus grand que MAX_DATA_SIZE : DATAS = [XFER_ID INDEX NB MSG_ID DATAS...]
+	SHORT_ADDRESS_ASK			= 0x0A,		//objet -> station : demande d'une adresse courte
+	SHORT_ADDRESS_IS			= 0x0B,		//station -> objet : DATAS = [SHORT_ADDRESS]
+	SHORT_ADDRESS_REVOKED		= 0x0C,		//station -> RF_BROADCAST_OBJECTS : DATAS = [SHORT_ADDRESS] inconnue de la station (aprs un reset), l'objet doit en redemander une
+	CHANNEL_SET					= 0x0D,		//station -> RF_BROADCAST_OBJECTS : DATAS = [INDEX NB CHANNEL... FLAGS] jeu de canaux, indice du canal de travail et dbit (RF_CHANNEL_FLAG_2MBPS)
+	LINK_TX_POWER				= 0x0E,		//station -> objet : DATAS = [TX_POWER] puissance d'mission  utiliser [dBm, sign]
+	STATS_ASK					= 0x0F,		//DATAS = [PAGE INDEX] demande d'une page de statistiques radio (voir rf_stats.h)
+	STATS_IS					= 0x10,		//DATAS = [PAGE INDEX ...] page de statistiques (envoye par morceaux si elle dpasse MAX_DATA_SIZE)
+	REGISTRY_ASK				= 0x11,		//-> station : DATAS = [DEVICE_ID(4)] ou [RANK] (parcours du registre, voir registry.h)
+	REGISTRY_IS					= 0x12,		//station -> : DATAS = [DEVICE_ID(4) AGE_S(2) RSSI RX_NB(4) MISSED_NB(2) RESET_NB FIRMWARE_VERSION(2) CAPABILITIES(4)], vide si inconnu
+	ACK_PIPE_IS					= 0x13,		//station -> objet : DATAS = [PIPE] pipe d'acquittement  utiliser (RF_DIALOG_PIPE_FULL_HEADER : aucun)
+	PING_START					= 0x14,		//DATAS = [TARGET(4) COUNT PERIOD_MS(2)] lance une srie de PING vers TARGET (voir rf_ping.h)
+	PING_REPORT					= 0x15,		//DATAS = [TARGET(4) SENT RECEIVED MIN_US(3) AVG_US(3) MAX_US(3) JITTER_US(3)] rsultat de la srie
+	EVENT_OCCURED				= 0x30,		//objet -> station : DATAS = [EVENT DATAS...] alerte (event_e), achemine en priorit (voir RF_DIALOG_send_event)
+	PACKED_MSGS					= 0x31,		//plusieurs messages regroups dans une seule trame : DATAS = [MSG_ID DATASIZE DATAS...]*
+	BENCH_TRAFFIC				= 0x32,		//objet -> station : DATAS = [CLASS SEQ(2) TIME_US(4) BOURRAGE...] trafic synthtique (voir rf_bench.h)
 	PARAMETER_IS				= 0x40,
 	PARAMETER_ASK				= 0x41,
 	PARAMETER_WRITE				= 0x42,
@@ -61,10 +113,78 @@ typedef enum{
 	NB				    = 25,
 }recipient_e;
 
+//Alertes portes par EVENT_OCCURED.
+typedef enum{
+	EVENT_FALL_DETECTED			= 0x01,
+	EVENT_ALARM_TRIGGERED		= 0x02,
+	EVENT_FIRE_DETECTED			= 0x03,
+	EVENT_BENCH					= 0xBE,		//trafic synthtique du banc de charge (voir rf_bench.h)
+}event_e;
+
+#define BASE_STATION_EMITTER_ID		(0xFF)	//identifiant d'metteur utilis par la station de base  TODO identifiant unique station
+#define RF_BROADCAST_OBJECTS		(0xFFFFFFFE)	//destinataire : tous les objets (0xFFFFFFFF dsigne la station de base)
+
+//Adresses de groupe : une seule trame (entte complet) atteint tous les membres, sans acquittement.
+//	RF_GROUP_MASK(groups) : objets membres d'au moins un des groupes de groups (24 groupes, appartenance fixe par PARAM_GROUPS).
+//	RF_GROUP_TYPE(type)   : tous les objets de ce type (OBJECT_ID).
+#define RF_GROUP_PREFIX_MASK		(0xFF000000)
+#define RF_GROUP_TYPE_PREFIX		(0xFD000000)
+#define RF_GROUP_MASK_PREFIX		(0xFE000000)
+#define RF_GROUP_TYPE(type)			(RF_GROUP_TYPE_PREFIX | ((type) & 0xFF))
+#define RF_GROUP_MASK(groups)		(RF_GROUP_MASK_PREFIX | ((groups) & 0x00FFFFFF))
+#define RF_DIALOG_IS_MULTICAST(recipient)	((recipient) == RF_BROADCAST_OBJECTS || ((recipient) & RF_GROUP_PREFIX_MASK) == RF_GROUP_TYPE_PREFIX || ((recipient) & RF_GROUP_PREFIX_MASK) == RF_GROUP_MASK_PREFIX)
+
+//Capacits annonces dans RECENT_RESET (fonctions compiles dans le firmware de l'objet).
+#define RF_DIALOG_CAPABILITY_COMPACT_HEADER		(1 << 0)
+#define RF_DIALOG_CAPABILITY_PACKING			(1 << 1)
+#define RF_DIALOG_CAPABILITY_TIMESLOT			(1 << 2)
+#define RF_DIALOG_CAPABILITY_CHANNEL_AGILITY	(1 << 3)
+#define RF_DIALOG_CAPABILITY_LINK_ADAPTATION	(1 << 4)
+#define RF_DIALOG_CAPABILITY_GROUPS				(1 << 5)
+#define RF_DIALOG_CAPABILITY_SLEEPY				(1 << 6)	//radio  l'coute seulement juste aprs nos missions : la station garde nos messages (voir mailbox.h)
+
+#define RF_DIALOG_RELIABLE_SLOTS_NB	5		//nombre de messages fiables pouvant tre en attente d'acquittement simultanment (le dernier est rserv aux alertes)
+#define RF_DIALOG_ACK_TIMEOUT		20		//[ms] dlai avant la premire retransmission (doubl  chaque nouvel essai)
+#define RF_DIALOG_MAX_RETRIES		3		//nombre maximum de retransmissions d'un message fiable
+#define RF_DIALOG_ALERT_ACK_TIMEOUT	8		//[ms] alertes (TX_PRIORITY_ALERT) : dlai entre deux essais, sans backoff (plus un tirage de 0  ce dlai)
+#define RF_DIALOG_ALERT_MAX_RETRIES	10
+
+#define RF_DIALOG_FRAGMENT_HEADER_SIZE	4	//[XFER_ID INDEX NB MSG_ID]
+#define RF_DIALOG_FRAGMENT_DATA_SIZE	(FRAME_MAX_DATA_SIZE - RF_DIALOG_FRAGMENT_HEADER_SIZE)
+#define RF_DIALOG_FRAGMENT_MAX_NB		24		//au plus 32 (masque des morceaux reus)
+#define RF_DIALOG_BLOCK_MAX_SIZE		(RF_DIALOG_FRAGMENT_MAX_NB*RF_DIALOG_FRAGMENT_DATA_SIZE)	//[octets] taille maximale d'un bloc fragment
+#define RF_DIALOG_REASSEMBLY_SLOTS_NB	2		//nombre de blocs pouvant tre en cours de rassemblage simultanment
+#define RF_DIALOG_REASSEMBLY_TIMEOUT	500		//[ms] un bloc incomplet est abandonn s'il ne reoit plus de morceau pendant ce dlai
+
+//Traitement d'un message reu, appel depuis la tache de fond.
+typedef void(*rf_dialog_handler_t)(rf_frame_t * frame);
+
+//Fonction appele  l'issue d'un envoi fiable : delivered vaut TRUE si le message a t acquitt, FALSE s'il a t abandonn.
+typedef void(*rf_dialog_delivery_callback_t)(msg_id_e msg_id, bool_e delivered);
+
 uint32_t RF_DIALOG_get_my_base_station_id(void);
+tx_priority_e RF_DIALOG_get_default_priority(msg_id_e msg_id);
 void RF_DIALOG_send_msg_id_to_basestation(msg_id_e msg_id, uint8_t datasize, uint8_t * datas);
 void RF_DIALOG_send_msg_id_to_object(recipient_e obj_id,msg_id_e msg_id, uint8_t datasize, uint8_t * datas);
-void RF_DIALOG_process_rx_basestation(nrf_esb_payload_t * payload);
-void RF_DIALOG_process_rx_object(nrf_esb_payload_t * payload);
+void RF_DIALOG_send_msg_id_to_group(uint32_t group, msg_id_e msg_id, uint8_t datasize, uint8_t * datas);
+void RF_DIALOG_init_groups(void);
+void RF_DIALOG_send_recent_reset(void);
+bool_e RF_DIALOG_is_for_me(uint32_t recipient);
+bool_e RF_DIALOG_send_msg_id_to_basestation_reliable(msg_id_e msg_id, uint8_t datasize, uint8_t * datas, rf_dialog_delivery_callback_t callback);
+bool_e RF_DIALOG_send_msg_id_to_object_reliable(recipient_e obj_id, msg_id_e msg_id, uint8_t datasize, uint8_t * datas, rf_dialog_delivery_callback_t callback);
+bool_e RF_DIALOG_send_event(event_e event, uint8_t datasize, uint8_t * datas, rf_dialog_delivery_callback_t callback);
+bool_e RF_DIALOG_send_block_to_basestation(msg_id_e msg_id, uint16_t size, uint8_t * datas);
+bool_e RF_DIALOG_send_block_to_object(recipient_e obj_id, msg_id_e msg_id, uint16_t size, uint8_t * datas);
+rf_dialog_handler_t RF_DIALOG_register_handler(msg_id_e msg_id, rf_dialog_handler_t handler);
+void RF_DIALOG_set_callback_pong(callback_fun_t new_callback);
+callback_fun_t RF_DIALOG_get_callback_pong(void);
+bool_e RF_DIALOG_frame_view(rf_frame_t * frame, nrf_esb_payload_t * payload);
+void RF_DIALOG_process_rx(rf_frame_t * frame);
+void RF_DIALOG_process_main(void);
+void RF_DIALOG_send_beacon(void);
+void RF_DIALOG_send_channel_set(uint8_t current_index, uint8_t nb, uint8_t * channels, uint8_t flags);
+uint32_t RF_DIALOG_get_address_from_short_address(uint8_t short_address);
+void RF_DIALOG_ack_duplicate(rf_frame_t * frame);
+void RF_DIALOG_flush_packed_msgs(void);
 
 #endif /* APPLI_COMMON_RF_DIALOG_H_ */
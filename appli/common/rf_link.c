@@ -0,0 +1,226 @@
+/*
+ * rf_link.c
+ *
+ *  Created on: 17 oct. 2026
+ */
+#include "../config.h"
+#include "rf_link.h"
+#include "systick.h"
+#include "secretary.h"
+#include "rf_dialog.h"
+#include "rf_channel.h"
+
+//Crans de puissance disponibles, du plus faible au plus fort.
+#define TX_POWER_STEPS_NB	8
+static const int8_t tx_power_dbm[TX_POWER_STEPS_NB] = {-20, -16, -12, -8, -4, 0, 3, 4};
+static const nrf_esb_tx_power_t tx_power_values[TX_POWER_STEPS_NB] = {
+		NRF_ESB_TX_POWER_NEG20DBM, NRF_ESB_TX_POWER_NEG16DBM, NRF_ESB_TX_POWER_NEG12DBM, NRF_ESB_TX_POWER_NEG8DBM,
+		NRF_ESB_TX_POWER_NEG4DBM, NRF_ESB_TX_POWER_0DBM, NRF_ESB_TX_POWER_3DBM, NRF_ESB_TX_POWER_4DBM};
+#define TX_POWER_DEFAULT_STEP	5	//0dBm, puissance par dfaut du driver ESB
+
+static rf_link_peer_t peers[RF_LINK_PEERS_NB];	//station de base seulement
+static volatile uint8_t my_tx_power_step = TX_POWER_DEFAULT_STEP;	//objet : puissance impose par la station
+
+static uint8_t RF_LINK_step_of(int8_t dbm);
+static rf_link_peer_t * RF_LINK_find_peer(uint32_t address, bool_e create);
+static void RF_LINK_update_peer(rf_link_peer_t * peer);
+static void RF_LINK_update_bitrate(void);
+
+void RF_LINK_init(void)
+{
+	for(uint8_t i = 0; i < RF_LINK_PEERS_NB; i++)
+		peers[i] = (rf_link_peer_t){0};
+	my_tx_power_step = TX_POWER_DEFAULT_STEP;
+}
+
+static uint8_t RF_LINK_step_of(int8_t dbm)
+{
+	for(uint8_t i = 0; i < TX_POWER_STEPS_NB; i++)
+	{
+		if(tx_power_dbm[i] >= dbm)
+			return i;
+	}
+	return TX_POWER_STEPS_NB - 1;
+}
+
+//Renvoie l'tat de liaison de l'objet address (cr si besoin, en remplaant le plus ancien).
+static rf_link_peer_t * RF_LINK_find_peer(uint32_t address, bool_e create)
+{
+	rf_link_peer_t * oldest = &peers[0];
+	if(address == 0)
+		return NULL;
+	for(uint8_t i = 0; i < RF_LINK_PEERS_NB; i++)
+	{
+		if(peers[i].address == address)
+			return &peers[i];
+		if(peers[i].address == 0 || (oldest->address != 0 && peers[i].last_rx_time - oldest->last_rx_time > 0x80000000))
+			oldest = &peers[i];
+	}
+	if(!create)
+		return NULL;
+	*oldest = (rf_link_peer_t){0};
+	oldest->address = address;
+	oldest->tx_power = tx_power_dbm[TX_POWER_DEFAULT_STEP];
+	oldest->base_step = TX_POWER_DEFAULT_STEP;
+	return oldest;
+}
+
+//Appele pour chaque trame reue. rssi : valeur releve par la radio [-dBm].
+void RF_LINK_report_rx(uint32_t emitter, uint8_t rssi)
+{
+	rf_link_peer_t * peer;
+	int16_t path_loss;
+
+	if(!USE_RF_LINK_ADAPTATION || OBJECT_ID != OBJECT_BASE_STATION)
+		return;
+	peer = RF_LINK_find_peer(emitter, TRUE);
+	if(peer == NULL)
+		return;
+	path_loss = peer->tx_power + rssi;
+	if(path_loss < 0)
+		path_loss = 0;
+	if(peer->last_rx_time == 0 && peer->path_loss == 0)
+		peer->path_loss = path_loss;	//premire mesure
+	else
+		peer->path_loss = peer->path_loss + (path_loss - peer->path_loss) / RF_LINK_FILTER;
+	peer->last_rx_time = SYSTICK_get_time_ms();
+	RF_LINK_update_peer(peer);
+}
+
+//Appele  l'acquittement d'un message fiable (delivered = TRUE) ou  l'expiration de chaque attente d'acquittement.
+void RF_LINK_report_tx_result(uint32_t recipient, bool_e delivered)
+{
+	rf_link_peer_t * peer;
+
+	if(!USE_RF_LINK_ADAPTATION || OBJECT_ID != OBJECT_BASE_STATION)
+		return;
+	peer = RF_LINK_find_peer(recipient, FALSE);
+	if(peer == NULL)
+		return;
+	if(delivered)
+	{
+		peer->delivered_nb++;
+		if(++peer->delivered_in_row >= RF_LINK_BOOST_RELEASE && peer->boost)
+		{
+			peer->boost--;
+			peer->delivered_in_row = 0;
+		}
+	}
+	else
+	{
+		peer->lost_nb++;
+		peer->delivered_in_row = 0;
+		if(peer->boost < RF_LINK_MAX_BOOST)
+			peer->boost++;
+	}
+	RF_LINK_update_peer(peer);
+}
+
+//Station : recalcule la puissance de l'objet et la lui communique si elle change.
+static void RF_LINK_update_peer(rf_link_peer_t * peer)
+{
+	uint8_t step;
+	int16_t required;
+	int8_t tx_power;
+	uint32_t now = SYSTICK_get_time_ms();
+
+	required = peer->path_loss - RF_LINK_RX_TARGET;
+	step = RF_LINK_step_of((required > 127)?127:required);
+	if(step < peer->base_step && tx_power_dbm[peer->base_step - 1] < required + RF_LINK_HYSTERESIS)
+		step = peer->base_step;	//on ne baisse que si le cran infrieur garde la marge d'hystrsis
+	peer->base_step = step;
+	step = (step + peer->boost >= TX_POWER_STEPS_NB)?(TX_POWER_STEPS_NB - 1):(step + peer->boost);
+	tx_power = tx_power_dbm[step];
+
+	if(tx_power != peer->tx_power || now - peer->last_command_time >= RF_LINK_REFRESH_PERIOD)
+	{
+		peer->tx_power = tx_power;
+		peer->last_command_time = now;
+		RF_DIALOG_send_msg_id_to_object(peer->address, LINK_TX_POWER, 1, (uint8_t *)&tx_power);
+	}
+}
+
+//Objet : puissance impose par la station.
+void RF_LINK_tx_power_received(int8_t tx_power)
+{
+	if(OBJECT_ID != OBJECT_BASE_STATION)
+		my_tx_power_step = RF_LINK_step_of(tx_power);
+}
+
+//Puissance  utiliser pour mettre cette trame (appele sous IT, au dmarrage de chaque mission).
+nrf_esb_tx_power_t RF_LINK_get_tx_power(nrf_esb_payload_t const * payload)
+{
+#if USE_RF_LINK_ADAPTATION
+	uint32_t recipient;
+	rf_link_peer_t * peer;
+	int8_t tx_power;
+
+	if(OBJECT_ID != OBJECT_BASE_STATION)
+		return tx_power_values[my_tx_power_step];
+
+	if(payload->pipe == RF_DIALOG_PIPE_COMPACT_HEADER)
+		recipient = RF_DIALOG_get_address_from_short_address(payload->data[BYTE_POS_COMPACT_RECIPIENT]);
+	else
+		recipient = U32FROMU8(payload->data[BYTE_POS_RECIPIENTS], payload->data[BYTE_POS_RECIPIENTS+1], payload->data[BYTE_POS_RECIPIENTS+2], payload->data[BYTE_POS_RECIPIENTS+3]);
+	peer = RF_LINK_find_peer(recipient, FALSE);
+	if(peer != NULL)
+		return tx_power_values[RF_LINK_step_of(peer->tx_power)];
+
+	//diffusion, ou objet inconnu : il faut atteindre tout le monde.
+	tx_power = tx_power_dbm[TX_POWER_DEFAULT_STEP];
+	for(uint8_t i = 0; i < RF_LINK_PEERS_NB; i++)
+	{
+		if(peers[i].address != 0 && peers[i].tx_power > tx_power)
+			tx_power = peers[i].tx_power;
+	}
+	return tx_power_values[RF_LINK_step_of(tx_power)];
+#else
+	return tx_power_values[TX_POWER_DEFAULT_STEP];
+#endif
+}
+
+void RF_LINK_process_main(void)
+{
+	if(USE_RF_LINK_ADAPTATION && OBJECT_ID == OBJECT_BASE_STATION)
+		RF_LINK_update_bitrate();
+}
+
+//Station : 2Mbps (trames deux fois plus courtes) si tous les objets actifs ont un affaiblissement modr, 1Mbps sinon.
+static void RF_LINK_update_bitrate(void)
+{
+	uint32_t now = SYSTICK_get_time_ms();
+	uint8_t max_path_loss = 0;
+	bool_e active = FALSE;
+	bool_e boosted = FALSE;
+	bool_e fast;
+
+#if !USE_RF_CHANNEL_AGILITY
+	return;		//le dbit n'est annonc qu'avec le jeu de canaux : le rseau reste  1Mbps
+#endif
+	for(uint8_t i = 0; i < RF_LINK_PEERS_NB; i++)
+	{
+		if(peers[i].address == 0 || now - peers[i].last_rx_time > RF_LINK_PEER_TIMEOUT)
+			continue;
+		active = TRUE;
+		if(peers[i].path_loss > max_path_loss)
+			max_path_loss = peers[i].path_loss;
+		if(peers[i].boost && RF_LINK_step_of(peers[i].tx_power) == TX_POWER_STEPS_NB - 1)
+			boosted = TRUE;		//pertes malgr la puissance maximale
+	}
+	if(!active)
+		return;
+
+	fast = RF_CHANNEL_is_2mbps();
+	if(fast && (max_path_loss > RF_LINK_2MBPS_MAX_PATH_LOSS || boosted))
+		RF_CHANNEL_set_2mbps(FALSE);
+	else if(!fast && !boosted && max_path_loss + RF_LINK_HYSTERESIS <= RF_LINK_2MBPS_MAX_PATH_LOSS)
+		RF_CHANNEL_set_2mbps(TRUE);
+}
+
+bool_e RF_LINK_get_peer(uint8_t index, rf_link_peer_t * peer)
+{
+	if(index >= RF_LINK_PEERS_NB || peer == NULL)
+		return FALSE;
+	*peer = peers[index];
+	return TRUE;
+}
@@ -0,0 +1,62 @@
+/*
+ * rf_link.h
+ *
+ *  Created on: 17 oct. 2026
+ */
+
+#ifndef APPLI_COMMON_RF_LINK_H_
+#define APPLI_COMMON_RF_LINK_H_
+
+#include "../config.h"
+#include "macro_types.h"
+#include "nrf_esb.h"
+#include "timeslot.h"
+
+/*
+ * Adaptation de liaison (pilote par la station de base).
+ * 	Pour chaque objet, la station estime l'affaiblissement du trajet : puissance d'mission de l'objet + RSSI mesur  la rception.
+ * 	Elle en dduit la plus petite puissance assurant une rception  -RF_LINK_RX_TARGET dBm, utilise pour ses propres missions
+ * 	vers cet objet et impose  l'objet pour ses missions (message LINK_TX_POWER). Chaque perte de message fiable ajoute un cran.
+ * 	Le dbit est commun  tout le rseau (la station n'coute qu' un dbit  la fois) : 2Mbps tant que tous les objets actifs
+ * 	sont assez proches, 1Mbps sinon. Il est annonc avec le jeu de canaux (voir rf_channel.h) : sans USE_RF_CHANNEL_AGILITY, il reste  1Mbps.
+ */
+
+#define RF_LINK_PEERS_NB			TIMESLOT_SLOTS_NB	//un par OBJECT_ID : un objet oubli repartirait de la puissance par dfaut, et recevrait un LINK_TX_POWER  chaque trame
+#define RF_LINK_RX_TARGET			80		//[-dBm] niveau de rception vis (sensibilit : -93dBm  1Mbps, -89dBm  2Mbps)
+#define RF_LINK_HYSTERESIS			3		//[dB]
+#define RF_LINK_2MBPS_MAX_PATH_LOSS	80		//[dB] affaiblissement maximal de tous les objets actifs pour passer le rseau  2Mbps
+#define RF_LINK_PEER_TIMEOUT		60000	//[ms] un objet muet depuis ce dlai n'est plus pris en compte
+#define RF_LINK_REFRESH_PERIOD		30000	//[ms] rappel priodique de sa puissance  chaque objet (il a pu rater le prcdent)
+#define RF_LINK_FILTER				4		//la moyenne glissante de l'affaiblissement prend 1/RF_LINK_FILTER de chaque mesure
+#define RF_LINK_MAX_BOOST			3		//crans de puissance ajouts au plus suite  des pertes
+#define RF_LINK_BOOST_RELEASE		8		//messages fiables acquitts d'affile avant de retirer un cran
+
+typedef struct
+{
+	uint32_t address;			//0 : emplacement libre
+	uint8_t path_loss;			//[dB] moyenne glissante
+	int8_t tx_power;			//[dBm] puissance utilise vers cet objet, et impose  celui-ci
+	uint8_t base_step;			//cran dduit de l'affaiblissement, avant boost (l'hystrsis porte sur lui seul)
+	uint8_t boost;				//crans ajouts suite  des pertes
+	uint8_t delivered_in_row;
+	uint32_t last_rx_time;		//[ms]
+	uint32_t last_command_time;	//[ms] dernier envoi de LINK_TX_POWER
+	uint32_t delivered_nb;
+	uint32_t lost_nb;
+}rf_link_peer_t;
+
+void RF_LINK_init(void);
+
+void RF_LINK_process_main(void);
+
+void RF_LINK_report_rx(uint32_t emitter, uint8_t rssi);
+
+void RF_LINK_report_tx_result(uint32_t recipient, bool_e delivered);
+
+nrf_esb_tx_power_t RF_LINK_get_tx_power(nrf_esb_payload_t const * payload);
+
+void RF_LINK_tx_power_received(int8_t tx_power);
+
+bool_e RF_LINK_get_peer(uint8_t index, rf_link_peer_t * peer);
+
+#endif /* APPLI_COMMON_RF_LINK_H_ */
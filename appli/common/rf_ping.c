@@ -0,0 +1,239 @@
+/*
+ * rf_ping.c
+ *
+ *  Created on: 17 oct. 2026
+ */
+#include "../config.h"
+#include "rf_ping.h"
+#include "rf_dialog.h"
+#include "systick.h"
+
+typedef enum
+{
+	RF_PING_REQUESTER_LOCAL = 0,	//RF_PING_start() : rsultat sur debug_printf
+	RF_PING_REQUESTER_UART,
+	RF_PING_REQUESTER_RF
+}rf_ping_requester_e;
+
+static rf_ping_peer_t peers[RF_PING_PEERS_NB];
+static uint16_t seq = 0;
+
+//Srie en cours
+static struct
+{
+	bool_e running;
+	rf_ping_peer_t * peer;
+	uint8_t remaining;
+	uint16_t period;				//[ms]
+	uint32_t next_time;				//[ms]
+	uint32_t last_sent_time;		//[ms]
+	rf_ping_requester_e requester;
+	uint32_t requester_emitter;		//metteur du PING_START
+	uint32_t requester_recipient;
+}series;
+
+static rf_ping_peer_t * RF_PING_find_peer(uint32_t address, bool_e create);
+static void RF_PING_send(void);
+static void RF_PING_report(void);
+static void RF_PING_put_u24(uint8_t * datas, uint32_t value);
+
+void RF_PING_init(void)
+{
+	for(uint8_t i = 0; i < RF_PING_PEERS_NB; i++)
+		peers[i] = (rf_ping_peer_t){0};
+	series.running = FALSE;
+}
+
+//Correspondant d'adresse address. Si create, il est ajout s'il est inconnu,  la place du moins rcemment vis si la table est pleine.
+static rf_ping_peer_t * RF_PING_find_peer(uint32_t address, bool_e create)
+{
+	rf_ping_peer_t * victim = NULL;
+
+	for(uint8_t i = 0; i < RF_PING_PEERS_NB; i++)
+	{
+		if(peers[i].address == address)
+			return &peers[i];
+		if(victim == NULL || (victim->address != 0 && (peers[i].address == 0 || (int32_t)(peers[i].last_use - victim->last_use) < 0)))
+			victim = &peers[i];
+	}
+	if(!create || victim == NULL || (series.running && victim == series.peer))
+		return NULL;
+	*victim = (rf_ping_peer_t){0};
+	victim->address = address;
+	return victim;
+}
+
+rf_ping_peer_t const * RF_PING_get_peer(uint32_t address)
+{
+	return RF_PING_find_peer(address, FALSE);
+}
+
+bool_e RF_PING_is_running(void)
+{
+	return series.running;
+}
+
+//Lance une srie de count PING, un toutes les period ms. Renvoie FALSE si une srie est dj en cours.
+bool_e RF_PING_start(uint32_t target, uint8_t count, uint16_t period)
+{
+	rf_ping_peer_t * peer;
+
+	if(series.running)
+		return FALSE;
+	if(OBJECT_ID != OBJECT_BASE_STATION)
+		target = RF_DIALOG_get_my_base_station_id();	//un objet ne dialogue qu'avec sa station
+	peer = RF_PING_find_peer(target, TRUE);
+	if(peer == NULL)
+		return FALSE;
+
+	*peer = (rf_ping_peer_t){0};
+	peer->address = target;
+	peer->last_use = SYSTICK_get_time_ms();
+	peer->first_seq = seq;
+	series.running = TRUE;
+	series.peer = peer;
+	series.remaining = count ? count : RF_PING_DEFAULT_COUNT;
+	series.period = period ? period : RF_PING_DEFAULT_PERIOD;
+	series.next_time = SYSTICK_get_time_ms();
+	series.requester = RF_PING_REQUESTER_LOCAL;
+	return TRUE;
+}
+
+//PING_START = [TARGET(4) COUNT PERIOD_MS(2)], COUNT et PERIOD_MS facultatifs. Le rsultat sera renvoy au demandeur.
+void RF_PING_start_received(rf_frame_t * frame)
+{
+	uint8_t count = 0;
+	uint16_t period = 0;
+
+	if(frame->datasize < 4)
+		return;
+	if(frame->datasize >= 5)
+		count = frame->datas[4];
+	if(frame->datasize >= 7)
+		period = U16FROMU8(frame->datas[5], frame->datas[6]);
+	if(!RF_PING_start(U32FROMU8(frame->datas[0], frame->datas[1], frame->datas[2], frame->datas[3]), count, period))
+		return;
+	series.requester = (frame->source == MSG_SOURCE_UART) ? RF_PING_REQUESTER_UART : RF_PING_REQUESTER_RF;
+	series.requester_emitter = frame->emitter;
+	series.requester_recipient = frame->recipient;
+}
+
+void RF_PING_process_main(void)
+{
+	uint32_t now;
+
+	if(!series.running)
+		return;
+	now = SYSTICK_get_time_ms();
+	if(series.remaining)
+	{
+		if((int32_t)(now - series.next_time) >= 0)
+		{
+			series.next_time += series.period;
+			series.last_sent_time = now;
+			series.remaining--;
+			RF_PING_send();
+		}
+	}
+	else if(series.peer->received_nb >= series.peer->sent_nb || now - series.last_sent_time > RF_PING_TIMEOUT)
+	{
+		series.running = FALSE;
+		RF_PING_report();
+	}
+}
+
+//PING = [SEQ(2) TIME_US(4)]
+static void RF_PING_send(void)
+{
+	uint8_t datas[RF_PING_DATAS_SIZE];
+	uint32_t now_us = SYSTICK_get_time_us();
+
+	datas[0] = (seq >> 8) & 0xFF;
+	datas[1] = seq & 0xFF;
+	datas[2] = (now_us >> 24) & 0xFF;
+	datas[3] = (now_us >> 16) & 0xFF;
+	datas[4] = (now_us >> 8) & 0xFF;
+	datas[5] = now_us & 0xFF;
+	seq++;
+	series.peer->sent_nb++;
+	if(OBJECT_ID == OBJECT_BASE_STATION)
+		RF_DIALOG_send_msg_id_to_object((recipient_e)series.peer->address, PING, RF_PING_DATAS_SIZE, datas);
+	else
+		RF_DIALOG_send_msg_id_to_basestation(PING, RF_PING_DATAS_SIZE, datas);
+}
+
+void RF_PING_pong_received(rf_frame_t * frame)
+{
+	rf_ping_peer_t * peer;
+	uint16_t pong_seq;
+	uint32_t rtt;
+	uint32_t delta;
+
+	if(frame->datasize < RF_PING_DATAS_SIZE)
+		return;	//PONG d'un PING sans datas
+	peer = RF_PING_find_peer((OBJECT_ID == OBJECT_BASE_STATION) ? frame->emitter : RF_DIALOG_get_my_base_station_id(), FALSE);
+	pong_seq = U16FROMU8(frame->datas[0], frame->datas[1]);
+	if(peer == NULL || (uint16_t)(pong_seq - peer->first_seq) >= peer->sent_nb || peer->received_nb >= peer->sent_nb)
+		return;	//PONG d'une srie prcdente
+
+	rtt = SYSTICK_get_time_us() - U32FROMU8(frame->datas[2], frame->datas[3], frame->datas[4], frame->datas[5]);
+	if(peer->received_nb == 0)
+		peer->rtt_min = rtt;
+	else
+	{
+		delta = (rtt > peer->rtt_last) ? (rtt - peer->rtt_last) : (peer->rtt_last - rtt);
+		peer->jitter = (int32_t)peer->jitter + ((int32_t)delta - (int32_t)peer->jitter) / RF_PING_JITTER_FILTER;
+	}
+	if(rtt < peer->rtt_min)
+		peer->rtt_min = rtt;
+	if(rtt > peer->rtt_max)
+		peer->rtt_max = rtt;
+	peer->rtt_sum += rtt;
+	peer->rtt_last = rtt;
+	peer->received_nb++;
+}
+
+static void RF_PING_put_u24(uint8_t * datas, uint32_t value)
+{
+	if(value > 0xFFFFFF)
+		value = 0xFFFFFF;
+	datas[0] = (value >> 16) & 0xFF;
+	datas[1] = (value >> 8) & 0xFF;
+	datas[2] = value & 0xFF;
+}
+
+//PING_REPORT = [TARGET(4) SENT RECEIVED MIN_US(3) AVG_US(3) MAX_US(3) JITTER_US(3)]
+static void RF_PING_report(void)
+{
+	rf_ping_peer_t * peer = series.peer;
+	uint8_t datas[RF_PING_REPORT_SIZE];
+	uint32_t avg = peer->received_nb ? peer->rtt_sum / peer->received_nb : 0;
+
+	datas[0] = (peer->address >> 24) & 0xFF;
+	datas[1] = (peer->address >> 16) & 0xFF;
+	datas[2] = (peer->address >> 8) & 0xFF;
+	datas[3] = peer->address & 0xFF;
+	datas[4] = peer->sent_nb;
+	datas[5] = peer->received_nb;
+	RF_PING_put_u24(&datas[6], peer->rtt_min);
+	RF_PING_put_u24(&datas[9], avg);
+	RF_PING_put_u24(&datas[12], peer->rtt_max);
+	RF_PING_put_u24(&datas[15], peer->jitter);
+
+	switch(series.requester)
+	{
+		case RF_PING_REQUESTER_UART:
+			SECRETARY_send_to_uart(series.requester_emitter, series.requester_recipient, PING_REPORT, RF_PING_REPORT_SIZE, datas);
+			break;
+		case RF_PING_REQUESTER_RF:
+			if(OBJECT_ID == OBJECT_BASE_STATION)
+				RF_DIALOG_send_msg_id_to_object((recipient_e)series.requester_emitter, PING_REPORT, RF_PING_REPORT_SIZE, datas);
+			else
+				RF_DIALOG_send_msg_id_to_basestation(PING_REPORT, RF_PING_REPORT_SIZE, datas);
+			break;
+		default:
+			debug_printf("ping %08x: %d/%d rtt[us] min %d avg %d max %d jitter %d\n", peer->address, peer->received_nb, peer->sent_nb,
+					peer->rtt_min, avg, peer->rtt_max, peer->jitter);
+			break;
+	}
+}
@@ -0,0 +1,56 @@
+/*
+ * rf_ping.h
+ *
+ *  Created on: 17 oct. 2026
+ */
+
+#ifndef APPLI_COMMON_RF_PING_H_
+#define APPLI_COMMON_RF_PING_H_
+
+#include "../config.h"
+#include "macro_types.h"
+#include "secretary.h"
+
+/*
+ * Mesure du temps d'aller-retour (RTT) radio par PING/PONG.
+ * 	PING = [SEQ(2) TIME_US(4)] : TIME_US est l'heure d'mission selon l'horloge de l'initiateur ; le PONG en renvoie les datas telles quelles.
+ * 	L'initiateur en dduit le RTT sans garder trace des PING en vol. Pour chaque correspondant, il tient les statistiques de la dernire srie :
+ * 	PING mis et PONG reus, RTT min/moyen/max et gigue (moyenne glissante de l'cart entre deux RTT successifs, comme la RFC 3550).
+ * 	Une srie se lance par RF_PING_start(), par un appui court sur le bouton rseau d'un objet, ou par PING_START = [TARGET(4) COUNT PERIOD_MS(2)]
+ * 	reu de l'UART ou par radio (COUNT et PERIOD_MS facultatifs). Une fois la srie termine, PING_REPORT = [TARGET(4) SENT RECEIVED
+ * 	MIN_US(3) AVG_US(3) MAX_US(3) JITTER_US(3)] est renvoy au demandeur (UART ou metteur du PING_START).
+ * 	Un objet ne peut viser que sa station de base (TARGET est alors ignor). Un PING sans datas reoit toujours un PONG sans datas.
+ * 	Le RTT comprend l'attente des crneaux d'mission (voir timeslot.h) de part et d'autre.
+ */
+
+#define RF_PING_PEERS_NB			8
+#define RF_PING_TIMEOUT				1000	//[ms] attente des PONG en retard aprs le dernier PING d'une srie
+#define RF_PING_DEFAULT_COUNT		10
+#define RF_PING_DEFAULT_PERIOD		200		//[ms]
+#define RF_PING_JITTER_FILTER		16
+#define RF_PING_DATAS_SIZE			6		//[SEQ(2) TIME_US(4)]
+#define RF_PING_REPORT_SIZE			18
+
+typedef struct
+{
+	uint32_t address;			//0 : emplacement libre
+	uint32_t last_use;			//[ms]
+	uint16_t first_seq;			//premier PING de la srie : les PONG plus anciens sont ignors
+	uint8_t sent_nb;
+	uint8_t received_nb;
+	uint32_t rtt_last;			//[us]
+	uint32_t rtt_min;			//[us]
+	uint32_t rtt_max;			//[us]
+	uint32_t rtt_sum;			//[us]
+	uint32_t jitter;			//[us]
+}rf_ping_peer_t;
+
+void RF_PING_init(void);
+void RF_PING_process_main(void);
+bool_e RF_PING_start(uint32_t target, uint8_t count, uint16_t period);
+bool_e RF_PING_is_running(void);
+void RF_PING_start_received(rf_frame_t * frame);
+void RF_PING_pong_received(rf_frame_t * frame);
+rf_ping_peer_t const * RF_PING_get_peer(uint32_t address);
+
+#endif /* APPLI_COMMON_RF_PING_H_ */
@@ -0,0 +1,239 @@
+/*
+ * rf_relay.c
+ *
+ *  Created on: 17 oct. 2026
+ */
+#include "../config.h"
+#include "rf_relay.h"
+#include "rf_dialog.h"
+#include "systick.h"
+
+typedef struct
+{
+	bool_e used;
+	uint32_t emitter;
+	uint32_t recipient;
+	uint8_t msg_cnt;
+	uint8_t msg_id;
+	uint32_t time;
+}rf_relay_forwarded_t;
+
+static rf_relay_neighbour_t neighbours[RF_RELAY_NEIGHBOURS_NB];
+static rf_relay_forwarded_t forwarded[RF_RELAY_FORWARDED_NB];
+static uint8_t forwarded_index = 0;
+static rf_relay_stats_t stats;
+
+static rf_relay_neighbour_t * RF_RELAY_find(uint32_t address, bool_e create);
+static bool_e RF_RELAY_is_fresh(rf_relay_neighbour_t * neighbour);
+#if USE_RF_RELAY
+static bool_e RF_RELAY_already_forwarded(rf_frame_t * frame);
+#endif
+
+void RF_RELAY_init(void)
+{
+	for(uint8_t i = 0; i < RF_RELAY_NEIGHBOURS_NB; i++)
+		neighbours[i] = (rf_relay_neighbour_t){0};
+	for(uint8_t i = 0; i < RF_RELAY_FORWARDED_NB; i++)
+		forwarded[i].used = FALSE;
+	forwarded_index = 0;
+	stats = (rf_relay_stats_t){0};
+}
+
+//Voisin d'adresse address. Si create, il est ajout s'il est inconnu,  la place du plus anciennement entendu si la table est pleine.
+static rf_relay_neighbour_t * RF_RELAY_find(uint32_t address, bool_e create)
+{
+	rf_relay_neighbour_t * victim = NULL;
+
+	for(uint8_t i = 0; i < RF_RELAY_NEIGHBOURS_NB; i++)
+	{
+		if(neighbours[i].address == address)
+			return &neighbours[i];
+		if(neighbours[i].address == BASE_STATION_EMITTER_ID)
+			continue;	//jamais remplace : entre deux beacons, plus d'objets que la table n'en contient peuvent mettre
+		if(victim == NULL || victim->address != 0)
+		{
+			if(neighbours[i].address == 0 || victim == NULL || (int32_t)(neighbours[i].last_seen - victim->last_seen) < 0)
+				victim = &neighbours[i];
+		}
+	}
+	if(!create || victim == NULL)
+		return NULL;
+	*victim = (rf_relay_neighbour_t){0};
+	victim->address = address;
+	return victim;
+}
+
+static bool_e RF_RELAY_is_fresh(rf_relay_neighbour_t * neighbour)
+{
+	return (neighbour != NULL && SYSTICK_get_time_ms() - neighbour->last_seen < RF_RELAY_NEIGHBOUR_TIMEOUT)?TRUE:FALSE;
+}
+
+//Appele pour chaque trame reue par radio (y compris celles qui ne nous sont pas destines).
+void RF_RELAY_report_rx(rf_frame_t * frame)
+{
+	rf_relay_neighbour_t * neighbour;
+	uint32_t now = SYSTICK_get_time_ms();
+	uint8_t rssi = frame->payload->rssi;
+
+	if(frame->emitter == ((OBJECT_ID == OBJECT_BASE_STATION)?BASE_STATION_EMITTER_ID:OBJECT_ID))
+		return;	//notre propre trame, retransmise par un relais
+	neighbour = RF_RELAY_find(frame->emitter, TRUE);
+	if(neighbour == NULL)
+		return;
+	neighbour->wants_relay = (frame->relay_ttl != RF_RELAY_TTL_NONE)?TRUE:FALSE;
+	if(RF_RELAY_IS_DIRECT(frame->relay_ttl))
+	{
+		if(neighbour->last_seen == 0 || now - neighbour->last_direct > RF_RELAY_NEIGHBOUR_TIMEOUT)
+			neighbour->rssi = rssi;
+		else
+			neighbour->rssi = (uint8_t)((int16_t)neighbour->rssi + ((int16_t)rssi - (int16_t)neighbour->rssi) / RF_RELAY_FILTER);
+		neighbour->hops = 0;
+		neighbour->last_direct = now;
+	}
+	else
+		neighbour->hops = RF_RELAY_TTL_REQUEST - frame->relay_ttl;
+	neighbour->last_seen = now;
+}
+
+//Objet : TRUE si nous n'entendons plus la station directement, nos trames demandent alors le relais.
+bool_e RF_RELAY_is_relay_mode(void)
+{
+#if OBJECT_ID == OBJECT_BASE_STATION
+	return FALSE;
+#else
+	rf_relay_neighbour_t * base;
+	base = RF_RELAY_find(BASE_STATION_EMITTER_ID, FALSE);
+	return (base == NULL || SYSTICK_get_time_ms() - base->last_direct > RF_RELAY_DIRECT_TIMEOUT)?TRUE:FALSE;
+#endif
+}
+
+//Station : TRUE si l'objet address demande le relais (nos trames vers lui partent alors avec RF_RELAY_TTL_REQUEST).
+bool_e RF_RELAY_is_relayed(uint32_t address)
+{
+	rf_relay_neighbour_t * neighbour;
+	neighbour = RF_RELAY_find(address, FALSE);
+	return (RF_RELAY_is_fresh(neighbour) && neighbour->wants_relay)?TRUE:FALSE;
+}
+
+//Complte le TTL d'une trame  entte complet que nous mettons (une trame retransmise a dj le sien).
+void RF_RELAY_stamp(nrf_esb_payload_t * payload)
+{
+	bool_e relay = FALSE;
+
+	if(payload->length < BYTE_POS_DATAS || (payload->data[BYTE_POS_DATASIZE] & DATASIZE_RELAY_TTL_MASK))
+		return;
+	if(payload->data[BYTE_POS_MSG_ID] == BEACON)
+		return;	//la synchronisation des crneaux n'a de sens qu'en direct
+#if OBJECT_ID == OBJECT_BASE_STATION
+	uint32_t recipient;
+	recipient = U32FROMU8(payload->data[BYTE_POS_RECIPIENTS], payload->data[BYTE_POS_RECIPIENTS+1], payload->data[BYTE_POS_RECIPIENTS+2], payload->data[BYTE_POS_RECIPIENTS+3]);
+	if(RF_DIALOG_IS_MULTICAST(recipient))
+	{
+		for(uint8_t i = 0; i < RF_RELAY_NEIGHBOURS_NB && !relay; i++)
+			relay = (RF_RELAY_is_fresh(&neighbours[i]) && neighbours[i].wants_relay)?TRUE:FALSE;
+	}
+	else
+		relay = RF_RELAY_is_relayed(recipient);
+#else
+	relay = RF_RELAY_is_relay_mode();
+#endif
+	if(relay)
+		payload->data[BYTE_POS_DATASIZE] |= RF_RELAY_TTL_REQUEST << DATASIZE_RELAY_TTL_SHIFT;
+}
+
+#if USE_RF_RELAY
+//Renvoie TRUE si la trame a dj t retransmise rcemment. Sinon, elle est mmorise.
+static bool_e RF_RELAY_already_forwarded(rf_frame_t * frame)
+{
+	uint32_t now = SYSTICK_get_time_ms();
+	rf_relay_forwarded_t * entry;
+
+	for(uint8_t i = 0; i < RF_RELAY_FORWARDED_NB; i++)
+	{
+		entry = &forwarded[i];
+		if(entry->used && now - entry->time < RF_RELAY_FORWARDED_MAX_AGE && entry->msg_cnt == frame->msg_cnt
+				&& entry->msg_id == frame->msg_id && entry->emitter == frame->emitter && entry->recipient == frame->recipient)
+			return TRUE;
+	}
+	entry = &forwarded[forwarded_index];
+	forwarded_index = (forwarded_index + 1) % RF_RELAY_FORWARDED_NB;
+	entry->used = TRUE;
+	entry->emitter = frame->emitter;
+	entry->recipient = frame->recipient;
+	entry->msg_cnt = frame->msg_cnt;
+	entry->msg_id = frame->msg_id;
+	entry->time = now;
+	return FALSE;
+}
+#endif
+
+//Relais : retransmission ventuelle d'une trame reue par radio (voir les rgles dans rf_relay.h).
+void RF_RELAY_forward(rf_frame_t * frame)
+{
+#if USE_RF_RELAY
+	rf_relay_neighbour_t * base;
+	rf_relay_neighbour_t * neighbour;
+	uint8_t datas[NRF_ESB_MAX_PAYLOAD_LENGTH];
+	uint8_t ttl = frame->relay_ttl;
+	uint8_t length;
+	bool_e route;
+	bool_e alert;
+
+	if(ttl < 2 || frame->payload == NULL || frame->payload->pipe != RF_DIALOG_PIPE_FULL_HEADER)
+		return;
+	if(frame->emitter == OBJECT_ID || frame->recipient == OBJECT_ID || frame->msg_id == BEACON)
+		return;
+
+	if(frame->recipient == RF_DIALOG_get_my_base_station_id())
+	{
+		//vers la station : au premier saut, l'metteur doit tre bien reu ; au second, nous devons entendre la station directement
+		base = RF_RELAY_find(BASE_STATION_EMITTER_ID, FALSE);
+		if(ttl == RF_RELAY_TTL_REQUEST)
+			route = (RF_RELAY_is_fresh(base) && frame->payload->rssi <= RF_RELAY_MAX_RSSI)?TRUE:FALSE;
+		else
+			route = (RF_RELAY_is_fresh(base) && SYSTICK_get_time_ms() - base->last_direct < RF_RELAY_DIRECT_TIMEOUT)?TRUE:FALSE;
+	}
+	else if(RF_DIALOG_IS_MULTICAST(frame->recipient))
+		route = TRUE;
+	else
+	{
+		//vers un objet qui demande le relais : au second saut, nous devons l'entendre directement et correctement
+		neighbour = RF_RELAY_find(frame->recipient, FALSE);
+		route = (RF_RELAY_is_fresh(neighbour) && neighbour->wants_relay
+				&& (ttl == RF_RELAY_TTL_REQUEST || (neighbour->hops == 0 && neighbour->rssi <= RF_RELAY_MAX_RSSI)))?TRUE:FALSE;
+	}
+	if(!route)
+	{
+		stats.no_route_nb++;
+		return;
+	}
+	if(RF_RELAY_already_forwarded(frame))
+	{
+		stats.loop_nb++;
+		return;
+	}
+
+	length = MIN(frame->payload->length, NRF_ESB_MAX_PAYLOAD_LENGTH);
+	for(uint8_t i = 0; i < length; i++)
+		datas[i] = frame->payload->data[i];
+	datas[BYTE_POS_DATASIZE] = (datas[BYTE_POS_DATASIZE] & ~DATASIZE_RELAY_TTL_MASK) | ((ttl - 1) << DATASIZE_RELAY_TTL_SHIFT);
+	alert = (frame->msg_id == EVENT_OCCURED || frame->msg_id == ACK)?TRUE:FALSE;
+	if(SECRETARY_forward_msg(alert?TX_PRIORITY_ALERT:TX_PRIORITY_REPLY, length, datas))	//une alerte, ou un ACK, garde sa priorit
+		stats.forwarded_nb++;
+#endif
+}
+
+void RF_RELAY_get_stats(rf_relay_stats_t * s)
+{
+	if(s != NULL)
+		*s = stats;
+}
+
+//Parcours de la table des voisins : renvoie FALSE si l'emplacement index est libre ou hors de la table.
+bool_e RF_RELAY_get_neighbour(uint8_t index, rf_relay_neighbour_t * neighbour)
+{
+	if(index >= RF_RELAY_NEIGHBOURS_NB || neighbours[index].address == 0)
+		return FALSE;
+	*neighbour = neighbours[index];
+	return TRUE;
+}
@@ -0,0 +1,79 @@
+/*
+ * rf_relay.h
+ *
+ *  Created on: 17 oct. 2026
+ */
+
+#ifndef APPLI_COMMON_RF_RELAY_H_
+#define APPLI_COMMON_RF_RELAY_H_
+
+#include "../config.h"
+#include "macro_types.h"
+#include "secretary.h"
+
+/*
+ * Relais radio (USE_RF_RELAY : objets aliments sur secteur).
+ * 	Le TTL de relais occupe 2 bits de l'octet DATASIZE de l'entte complet (DATASIZE_RELAY_TTL_MASK) :
+ * 		0 : trame directe, jamais relaye
+ * 		3 : relais demand par l'metteur, pas encore relaye
+ * 		2, 1 : relaye une fois, deux fois. Un relais ne retransmet que les trames de TTL >= 2, en dcrmentant le TTL.
+ * 	Une trame fait donc au plus 2 sauts ; chaque relais garde de plus la trace des trames dj retransmises (pas de boucle).
+ * 	Les trames compactes (pipe propre au destinataire) ne sont pas entendues des relais : un objet relay garde l'entte complet.
+ *
+ * 	Table des voisins (tous les noeuds) : pour chaque metteur entendu, RSSI (trames directes), dernier passage, et s'il demande
+ * 	 tre relay. Un objet qui n'a entendu aucune trame directe de la station depuis RF_RELAY_DIRECT_TIMEOUT (les beacons suffisent)
+ * 	demande le relais de ses trames. La station relaie alors vers lui : TTL 3 pour ses messages, et pour les diffusions (sauf BEACON).
+ * 	Un relais retransmet :
+ * 		- vers la station : les trames de TTL 3 d'un objet bien reu (RSSI <= RF_RELAY_MAX_RSSI) s'il a une route vers la station,
+ * 		  celles de TTL 2 s'il entend la station directement ;
+ * 		- vers un objet qui demande le relais : au premier saut s'il le connait, au second saut s'il l'entend directement ;
+ * 		- les diffusions de la station (TTL >= 2).
+ * 	Les retransmissions partent en priorit REPLY : le dlai ajout par saut est celui d'une trame, plus l'attente de notre crneau.
+ */
+
+#define RF_RELAY_NEIGHBOURS_NB		16
+#define RF_RELAY_FORWARDED_NB		8		//trames retransmises mmorises (anti-boucle)
+#define RF_RELAY_FORWARDED_MAX_AGE	1000	//[ms]
+#define RF_RELAY_NEIGHBOUR_TIMEOUT	30000	//[ms] un voisin muet depuis ce dlai est oubli
+#define RF_RELAY_DIRECT_TIMEOUT		2000	//[ms] objet : sans trame directe de la station depuis ce dlai, on demande le relais
+#define RF_RELAY_MAX_RSSI			85		//[-dBm] en de, la trame d'un voisin est trop faible pour valoir une retransmission
+#define RF_RELAY_FILTER				4		//la moyenne glissante du RSSI prend 1/RF_RELAY_FILTER de chaque mesure
+
+#define RF_RELAY_TTL_NONE			0
+#define RF_RELAY_TTL_REQUEST		3
+#define RF_RELAY_IS_DIRECT(ttl)		((ttl) == RF_RELAY_TTL_NONE || (ttl) == RF_RELAY_TTL_REQUEST)
+
+typedef struct
+{
+	uint32_t address;			//0 : emplacement libre
+	uint32_t last_seen;			//[ms]
+	uint32_t last_direct;		//[ms] dernire trame reue sans relais
+	uint8_t rssi;				//[-dBm] moyenne glissante des trames directes
+	uint8_t hops;				//sauts de la dernire trame reue (0 : directe)
+	bool_e wants_relay;			//ses trames demandent le relais
+}rf_relay_neighbour_t;
+
+typedef struct
+{
+	uint32_t forwarded_nb;
+	uint32_t loop_nb;			//trames dj retransmises, entendues  nouveau
+	uint32_t no_route_nb;		//trames  relayer sans route connue
+}rf_relay_stats_t;
+
+void RF_RELAY_init(void);
+
+void RF_RELAY_report_rx(rf_frame_t * frame);
+
+void RF_RELAY_forward(rf_frame_t * frame);
+
+void RF_RELAY_stamp(nrf_esb_payload_t * payload);
+
+bool_e RF_RELAY_is_relay_mode(void);
+
+bool_e RF_RELAY_is_relayed(uint32_t address);
+
+void RF_RELAY_get_stats(rf_relay_stats_t * stats);
+
+bool_e RF_RELAY_get_neighbour(uint8_t index, rf_relay_neighbour_t * neighbour);
+
+#endif /* APPLI_COMMON_RF_RELAY_H_ */
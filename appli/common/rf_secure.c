@@ -0,0 +1,563 @@
+/*
+ * rf_secure.c
+ *
+ *  Created on: 17 oct. 2026
+ */
+#include <string.h>
+#include "../config.h"
+#include "rf_secure.h"
+#include "rf_dialog.h"
+#include "systick.h"
+#include "flash.h"
+#include "nrf.h"
+
+#if USE_RF_SECURE
+
+#define RF_SECURE_NONCE_SIZE			13
+#define RF_SECURE_CCM_L					2		//taille du champ longueur des blocs CCM (15 - RF_SECURE_NONCE_SIZE)
+#define RF_SECURE_FCNT_SIZE				4
+#define RF_SECURE_COMPACT_FCNT_SIZE		2
+#define RF_SECURE_JOURNAL_PAGE_SIZE		0x1000
+#define RF_SECURE_JOURNAL_RECORDS_NB	(RF_SECURE_JOURNAL_PAGE_SIZE/4)
+#define RF_SECURE_JOURNAL_END			(RF_SECURE_JOURNAL_ADDRESS + 2*RF_SECURE_JOURNAL_PAGE_SIZE)
+#define RF_SECURE_PEER_JOURNAL_END		(RF_SECURE_PEER_JOURNAL_ADDRESS + 2*RF_SECURE_JOURNAL_PAGE_SIZE)
+#define RF_SECURE_PEER_JOURNAL_MAGIC	0x52465345	//'RFSE' : page du journal des metteurs ouverte
+#define RF_SECURE_PEER_RECORD_SIZE		8			//[FCNT EMITTER]
+
+//Structure pointe par ECBDATAPTR : le priphrique y lit la cl et le clair, et y crit le chiffr.
+typedef struct
+{
+	uint8_t key[16];
+	uint8_t cleartext[16];
+	uint8_t ciphertext[16];
+}rf_secure_ecb_data_t;
+
+typedef struct
+{
+	uint32_t emitter;				//0 : emplacement libre
+	uint32_t last_use;				//[ms]
+	uint32_t fcnt_max;				//plus grand FCNT accept
+	uint32_t window;				//bit i : FCNT fcnt_max - i dj accept
+	uint32_t fcnt_journaled;		//dernier FCNT inscrit dans le journal des metteurs
+	bool_e journaled;				//inscrit depuis le dmarrage
+}rf_secure_peer_t;
+
+static const uint8_t key[16] = RF_SECURE_KEY;
+static rf_secure_ecb_data_t ecb_data;
+static rf_secure_peer_t peers[RF_SECURE_PEERS_NB];
+static rf_secure_stats_t stats;
+//Compteur de trames : les valeurs de fcnt  fcnt_reserved - 1 sont rserves en flash, la suivante est inscrite  journal_address.
+static volatile uint32_t fcnt;
+static uint32_t fcnt_reserved;
+static uint32_t journal_address;
+//Journal des metteurs : prochain enregistrement libre (en dbut de page : page pleine, ou aucune page ouverte) et gnration de la page courante.
+static uint32_t peer_journal_address;
+static uint32_t peer_journal_generation;
+
+static void RF_SECURE_aes(uint8_t * block);
+static void RF_SECURE_ccm(uint8_t const * nonce, uint8_t const * aad, uint8_t aad_size, uint8_t * datas, uint8_t datasize, bool_e encrypt, uint8_t * mic);
+static void RF_SECURE_counter_block(uint8_t * a, uint8_t const * nonce, uint8_t i);
+static void RF_SECURE_ctr(uint8_t const * nonce, uint8_t * datas, uint8_t datasize);
+static bool_e RF_SECURE_parse_header(uint8_t pipe, uint8_t const * frame, uint8_t size, uint8_t * header_size, uint8_t * datasize, uint32_t * emitter);
+static void RF_SECURE_build_nonce(uint8_t * nonce, uint32_t emitter, uint32_t counter);
+static uint8_t RF_SECURE_build_aad(uint8_t pipe, uint8_t const * frame, uint8_t header_size, uint8_t * aad);
+static void RF_SECURE_load_counter(void);
+static bool_e RF_SECURE_reserve_counters(void);
+static rf_secure_peer_t * RF_SECURE_find_peer(uint32_t emitter);
+static bool_e RF_SECURE_is_replay(rf_secure_peer_t * peer, uint32_t counter);
+static void RF_SECURE_accept(rf_secure_peer_t * peer, uint32_t emitter, uint32_t counter);
+static void RF_SECURE_load_peers(void);
+static void RF_SECURE_open_peer_journal_page(void);
+static void RF_SECURE_journal_peer(rf_secure_peer_t * peer);
+
+void RF_SECURE_init(void)
+{
+	memcpy(ecb_data.key, key, sizeof(ecb_data.key));
+	NRF_ECB->ECBDATAPTR = (uintptr_t)&ecb_data;
+	for(uint8_t i = 0; i < RF_SECURE_PEERS_NB; i++)
+		peers[i].emitter = 0;
+	stats = (rf_secure_stats_t){0};
+	RF_SECURE_load_counter();
+	RF_SECURE_reserve_counters();	//avant toute mission : les compteurs d'avant le reset sont peut-tre tous utiliss
+	RF_SECURE_load_peers();			//avant toute rception : les FCNT accepts avant le reset ne doivent pas l'tre  nouveau
+}
+
+//Rservation du bloc de compteurs suivant, en tche de fond (criture en flash), bien avant que le bloc en cours soit puis.
+//Ouverture d'une nouvelle page du journal des metteurs lorsque la courante est pleine.
+void RF_SECURE_process_main(void)
+{
+	if(fcnt_reserved - fcnt < RF_SECURE_COUNTER_BLOCK/2)
+		RF_SECURE_reserve_counters();
+	if((peer_journal_address & (RF_SECURE_JOURNAL_PAGE_SIZE - 1)) == 0)
+		RF_SECURE_open_peer_journal_page();
+}
+
+//Scelle la trame frame (pipe indique son format d'entte), dans un tampon de NRF_ESB_MAX_PAYLOAD_LENGTH octets : ses datas sont chiffres et
+//[FCNT(4) MIC(4)] est ajout  la suite. Renvoie FALSE si la trame scelle ne tient pas dans une payload ESB ou s'il n'y a plus de compteur disponible.
+//Non bloquant (hors attente du priphrique ECB), peut tre appele en IT.
+bool_e RF_SECURE_seal(uint8_t pipe, uint8_t * frame, uint8_t * size)
+{
+	uint8_t header_size;
+	uint8_t datasize;
+	uint32_t emitter;
+	uint32_t counter;
+	uint8_t nonce[RF_SECURE_NONCE_SIZE];
+	uint8_t aad[BYTE_POS_DATAS];
+	uint8_t aad_size;
+	uint8_t * trailer;
+	uint8_t fcnt_size = (pipe == RF_DIALOG_PIPE_COMPACT_HEADER)?RF_SECURE_COMPACT_FCNT_SIZE:RF_SECURE_FCNT_SIZE;
+	uint32_t primask;
+	uint32_t start = SYSTICK_get_time_us();
+	uint32_t duration;
+
+	if(!RF_SECURE_parse_header(pipe, frame, *size, &header_size, &datasize, &emitter) || header_size + datasize + fcnt_size + RF_SECURE_MIC_SIZE > NRF_ESB_MAX_PAYLOAD_LENGTH)
+	{
+		stats.seal_failed_nb++;
+		return FALSE;
+	}
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	counter = fcnt;
+	if(counter != fcnt_reserved)
+		fcnt++;
+	__set_PRIMASK(primask);
+	if(counter == fcnt_reserved)
+	{
+		stats.seal_failed_nb++;	//la rservation en flash n'a pas suivi (ou les compteurs sont puiss : la cl doit tre change)
+		return FALSE;
+	}
+
+	trailer = &frame[header_size + datasize];
+	for(uint8_t i = 0; i < fcnt_size; i++)
+		trailer[i] = (counter >> (8 * (fcnt_size - 1 - i))) & 0xFF;
+	RF_SECURE_build_nonce(nonce, emitter, counter);
+	aad_size = RF_SECURE_build_aad(pipe, frame, header_size, aad);
+	RF_SECURE_ccm(nonce, aad, aad_size, &frame[header_size], datasize, TRUE, &trailer[fcnt_size]);
+	*size = header_size + datasize + fcnt_size + RF_SECURE_MIC_SIZE;
+
+	duration = SYSTICK_get_time_us() - start;
+	stats.sealed_nb++;
+	stats.seal_time_sum += duration;
+	if(duration > stats.seal_time_max)
+		stats.seal_time_max = duration;
+	return TRUE;
+}
+
+//Vrifie la trame reue par radio et dchiffre ses datas dans datas (COMPACT_MAX_DATA_SIZE octets), vers lesquelles frame->datas est redirig.
+//La payload reste scelle, telle qu'un relais doit la retransmettre. Renvoie FALSE si la trame doit tre ignore.
+bool_e RF_SECURE_open(rf_frame_t * frame, uint8_t * datas)
+{
+	nrf_esb_payload_t * payload = frame->payload;
+	uint8_t header_size = frame->datas - payload->data;
+	uint8_t datasize = frame->datasize;
+	uint8_t nonce[RF_SECURE_NONCE_SIZE];
+	uint8_t aad[BYTE_POS_DATAS];
+	uint8_t aad_size;
+	uint8_t mic[RF_SECURE_MIC_SIZE];
+	uint8_t diff = 0;
+	uint8_t * trailer;
+	uint8_t fcnt_size = (payload->pipe == RF_DIALOG_PIPE_COMPACT_HEADER)?RF_SECURE_COMPACT_FCNT_SIZE:RF_SECURE_FCNT_SIZE;
+	uint32_t counter;
+	rf_secure_peer_t * peer;
+	uint32_t start = SYSTICK_get_time_us();
+	uint32_t duration;
+
+	if(payload->length != header_size + datasize + fcnt_size + RF_SECURE_MIC_SIZE)
+	{
+		stats.unsealed_nb++;
+		return FALSE;
+	}
+	trailer = &payload->data[header_size + datasize];
+	peer = RF_SECURE_find_peer(frame->emitter);
+	if(fcnt_size == RF_SECURE_FCNT_SIZE)
+		counter = U32FROMU8(trailer[0], trailer[1], trailer[2], trailer[3]);
+	else if(peer != NULL)
+		counter = peer->fcnt_max + (int16_t)(U16FROMU8(trailer[0], trailer[1]) - (uint16_t)peer->fcnt_max);	//le plus proche du dernier FCNT accept
+	else
+	{
+		stats.unknown_nb++;
+		return FALSE;
+	}
+	if(RF_SECURE_is_replay(peer, counter))
+	{
+		stats.replay_nb++;
+		return FALSE;
+	}
+
+	memcpy(datas, frame->datas, datasize);
+	RF_SECURE_build_nonce(nonce, frame->emitter, counter);
+	aad_size = RF_SECURE_build_aad(payload->pipe, payload->data, header_size, aad);
+	RF_SECURE_ccm(nonce, aad, aad_size, datas, datasize, FALSE, mic);
+	for(uint8_t i = 0; i < RF_SECURE_MIC_SIZE; i++)
+		diff |= mic[i] ^ trailer[fcnt_size + i];	//dure indpendante du premier octet faux (pas de memcmp)
+	if(diff)
+	{
+		stats.mic_failed_nb++;
+		return FALSE;
+	}
+	RF_SECURE_accept(peer, frame->emitter, counter);
+	frame->datas = datas;
+
+	duration = SYSTICK_get_time_us() - start;
+	stats.opened_nb++;
+	stats.open_time_sum += duration;
+	if(duration > stats.open_time_max)
+		stats.open_time_max = duration;
+	return TRUE;
+}
+
+//Chiffrement AES-128 d'un bloc par le priphrique ECB, sous section critique : des trames sont aussi scelles depuis les IT.
+static void RF_SECURE_aes(uint8_t * block)
+{
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	memcpy(ecb_data.cleartext, block, 16);
+	do
+	{
+		NRF_ECB->EVENTS_ENDECB = 0;
+		NRF_ECB->EVENTS_ERRORECB = 0;
+		NRF_ECB->TASKS_STARTECB = 1;
+		while(NRF_ECB->EVENTS_ENDECB == 0 && NRF_ECB->EVENTS_ERRORECB == 0);
+	}while(NRF_ECB->EVENTS_ENDECB == 0);	//ERRORECB : opration interrompue par un priphrique prioritaire (CCM, AAR), on recommence
+	memcpy(block, ecb_data.ciphertext, 16);
+	stats.ecb_blocks_nb++;
+	__set_PRIMASK(primask);
+}
+
+//CCM (RFC 3610), nonce de 13 octets et MIC de RF_SECURE_MIC_SIZE octets. aad : au plus 14 octets (un seul bloc).
+//Le CBC-MAC porte sur le clair : les datas sont dchiffres avant le calcul, ou chiffres aprs. mic reoit le MIC chiffr.
+static void RF_SECURE_ccm(uint8_t const * nonce, uint8_t const * aad, uint8_t aad_size, uint8_t * datas, uint8_t datasize, bool_e encrypt, uint8_t * mic)
+{
+	uint8_t x[16];
+	uint8_t a[16];
+	uint8_t i;
+	uint8_t j;
+	uint8_t n;
+
+	if(!encrypt)
+		RF_SECURE_ctr(nonce, datas, datasize);
+
+	//CBC-MAC : B0 = [FLAGS NONCE DATASIZE(2)], puis [AAD_SIZE(2) AAD] et les datas, complts par des 0
+	x[0] = 0x40 | (((RF_SECURE_MIC_SIZE - 2) / 2) << 3) | (RF_SECURE_CCM_L - 1);
+	memcpy(&x[1], nonce, RF_SECURE_NONCE_SIZE);
+	x[14] = 0;
+	x[15] = datasize;
+	RF_SECURE_aes(x);
+	x[1] ^= aad_size;
+	for(j = 0; j < aad_size; j++)
+		x[2 + j] ^= aad[j];
+	RF_SECURE_aes(x);
+	for(i = 0; i * 16 < datasize; i++)
+	{
+		n = MIN(16, datasize - i * 16);
+		for(j = 0; j < n; j++)
+			x[j] ^= datas[i * 16 + j];
+		RF_SECURE_aes(x);
+	}
+
+	if(encrypt)
+		RF_SECURE_ctr(nonce, datas, datasize);
+
+	RF_SECURE_counter_block(a, nonce, 0);
+	RF_SECURE_aes(a);
+	for(j = 0; j < RF_SECURE_MIC_SIZE; j++)
+		mic[j] = x[j] ^ a[j];
+}
+
+//Bloc de compteur CTR : A_i = [FLAGS NONCE i(2)]
+static void RF_SECURE_counter_block(uint8_t * a, uint8_t const * nonce, uint8_t i)
+{
+	a[0] = RF_SECURE_CCM_L - 1;
+	memcpy(&a[1], nonce, RF_SECURE_NONCE_SIZE);
+	a[14] = 0;
+	a[15] = i;
+}
+
+//Chiffrement (ou dchiffrement) CTR des datas : bloc i ^ E(A_i+1), A_0 tant rserv au MIC.
+static void RF_SECURE_ctr(uint8_t const * nonce, uint8_t * datas, uint8_t datasize)
+{
+	uint8_t a[16];
+	uint8_t n;
+
+	for(uint8_t i = 0; i * 16 < datasize; i++)
+	{
+		RF_SECURE_counter_block(a, nonce, i + 1);
+		RF_SECURE_aes(a);
+		n = MIN(16, datasize - i * 16);
+		for(uint8_t j = 0; j < n; j++)
+			datas[i * 16 + j] ^= a[j];
+	}
+}
+
+//Taille de l'entte et des datas, et adresse complte de l'metteur, d'une trame que nous mettons.
+//Une trame compacte n'est mise que par la station (BASE_STATION_EMITTER_ID) ou par l'objet lui-mme (OBJECT_ID), voir RF_DIALOG_get_short_addresses().
+static bool_e RF_SECURE_parse_header(uint8_t pipe, uint8_t const * frame, uint8_t size, uint8_t * header_size, uint8_t * datasize, uint32_t * emitter)
+{
+	if(pipe == RF_DIALOG_PIPE_COMPACT_HEADER)
+	{
+		if(size < BYTE_POS_COMPACT_DATAS)
+			return FALSE;
+		*header_size = BYTE_POS_COMPACT_DATAS;
+		*datasize = frame[BYTE_POS_COMPACT_DATASIZE] & DATASIZE_MASK;
+		*emitter = (OBJECT_ID == OBJECT_BASE_STATION)?BASE_STATION_EMITTER_ID:OBJECT_ID;
+	}
+	else
+	{
+		if(size < BYTE_POS_DATAS)
+			return FALSE;
+		*header_size = BYTE_POS_DATAS;
+		*datasize = frame[BYTE_POS_DATASIZE] & DATASIZE_MASK;
+		*emitter = U32FROMU8(frame[BYTE_POS_EMITTER], frame[BYTE_POS_EMITTER+1], frame[BYTE_POS_EMITTER+2], frame[BYTE_POS_EMITTER+3]);
+	}
+	return (*header_size + *datasize <= size)?TRUE:FALSE;
+}
+
+static void RF_SECURE_build_nonce(uint8_t * nonce, uint32_t emitter, uint32_t counter)
+{
+	nonce[0] = (emitter >> 24) & 0xFF;
+	nonce[1] = (emitter >> 16) & 0xFF;
+	nonce[2] = (emitter >> 8) & 0xFF;
+	nonce[3] = emitter & 0xFF;
+	nonce[4] = (counter >> 24) & 0xFF;
+	nonce[5] = (counter >> 16) & 0xFF;
+	nonce[6] = (counter >> 8) & 0xFF;
+	nonce[7] = counter & 0xFF;
+	for(uint8_t i = 8; i < RF_SECURE_NONCE_SIZE; i++)
+		nonce[i] = 0;
+}
+
+//Donnes authentifies : l'entte, sans le TTL de relais que les relais modifient.
+static uint8_t RF_SECURE_build_aad(uint8_t pipe, uint8_t const * frame, uint8_t header_size, uint8_t * aad)
+{
+	memcpy(aad, frame, header_size);
+	if(pipe != RF_DIALOG_PIPE_COMPACT_HEADER)
+		aad[BYTE_POS_DATASIZE] &= ~DATASIZE_RELAY_TTL_MASK;
+	return header_size;
+}
+
+//Le plus grand enregistrement du journal (deux pages, chacune remplie depuis son dbut) est la borne des compteurs dj rservs.
+static void RF_SECURE_load_counter(void)
+{
+	uint32_t address;
+	uint32_t record;
+
+	fcnt = 0;
+	journal_address = RF_SECURE_JOURNAL_ADDRESS;
+	for(uint32_t page = RF_SECURE_JOURNAL_ADDRESS; page < RF_SECURE_JOURNAL_END; page += RF_SECURE_JOURNAL_PAGE_SIZE)
+	{
+		for(uint16_t i = 0; i < RF_SECURE_JOURNAL_RECORDS_NB; i++)
+		{
+			address = page + 4 * i;
+			record = FLASHWRITER_read(address);
+			if(record == 0xFFFFFFFF)
+				break;
+			if(record >= fcnt)
+			{
+				fcnt = record;
+				journal_address = address + 4;
+			}
+		}
+	}
+	if(journal_address == RF_SECURE_JOURNAL_END)
+		journal_address = RF_SECURE_JOURNAL_ADDRESS;
+	fcnt_reserved = fcnt;
+}
+
+//Inscrit la nouvelle borne dans le journal. En arrivant au dbut d'une page, celle-ci est efface : la plus grande borne est dans l'autre.
+static bool_e RF_SECURE_reserve_counters(void)
+{
+	uint32_t bound = fcnt_reserved + RF_SECURE_COUNTER_BLOCK;
+
+	if(bound < fcnt_reserved || bound == 0xFFFFFFFF)
+		return FALSE;	//compteurs puiss
+	if((journal_address & (RF_SECURE_JOURNAL_PAGE_SIZE - 1)) == 0)
+		FLASHWRITER_erase_page(journal_address);
+	if(FLASHWRITER_program(journal_address, bound) != END_OK)
+	{
+		//mot dj crit (page non efface au premier dmarrage ?) : on passe  la page suivante
+		journal_address = (journal_address & ~(RF_SECURE_JOURNAL_PAGE_SIZE - 1)) + RF_SECURE_JOURNAL_PAGE_SIZE;
+		if(journal_address == RF_SECURE_JOURNAL_END)
+			journal_address = RF_SECURE_JOURNAL_ADDRESS;
+		return FALSE;
+	}
+	journal_address += 4;
+	if(journal_address == RF_SECURE_JOURNAL_END)
+		journal_address = RF_SECURE_JOURNAL_ADDRESS;
+	fcnt_reserved = bound;
+	return TRUE;
+}
+
+//Emplacement de l'metteur, ou NULL s'il est inconnu.
+static rf_secure_peer_t * RF_SECURE_find_peer(uint32_t emitter)
+{
+	for(uint8_t i = 0; i < RF_SECURE_PEERS_NB; i++)
+	{
+		if(peers[i].emitter == emitter)
+			return &peers[i];
+	}
+	return NULL;
+}
+
+static bool_e RF_SECURE_is_replay(rf_secure_peer_t * peer, uint32_t counter)
+{
+	uint32_t age;
+
+	if(peer == NULL || counter > peer->fcnt_max)
+		return FALSE;
+	age = peer->fcnt_max - counter;
+	if(age >= RF_SECURE_REPLAY_WINDOW)
+		return TRUE;
+	return (peer->window & (1UL << age))?TRUE:FALSE;
+}
+
+//MIC vrifi : le compteur est retenu. Un metteur inconnu prend l'emplacement libre, ou  dfaut le moins rcemment utilis.
+static void RF_SECURE_accept(rf_secure_peer_t * peer, uint32_t emitter, uint32_t counter)
+{
+	uint32_t now = SYSTICK_get_time_ms();
+	uint32_t shift;
+
+	if(peer == NULL)
+	{
+		peer = &peers[0];
+		for(uint8_t i = 0; i < RF_SECURE_PEERS_NB; i++)
+		{
+			if(peers[i].emitter == 0)
+			{
+				peer = &peers[i];
+				break;
+			}
+			if(now - peers[i].last_use > now - peer->last_use)
+				peer = &peers[i];
+		}
+		peer->emitter = emitter;
+		peer->fcnt_max = counter;
+		peer->window = 1;
+		peer->fcnt_journaled = 0;
+		peer->journaled = FALSE;
+	}
+	else if(counter > peer->fcnt_max)
+	{
+		shift = counter - peer->fcnt_max;
+		peer->window = (shift >= RF_SECURE_REPLAY_WINDOW)?1:((peer->window << shift) | 1);
+		peer->fcnt_max = counter;
+	}
+	else
+		peer->window |= 1UL << (peer->fcnt_max - counter);
+	peer->last_use = now;
+	//Premire trame depuis le dmarrage (elle peut avoir demand un reset...) ou RF_SECURE_PEER_JOURNAL_STEP trames depuis la dernire inscription
+	if(!peer->journaled || peer->fcnt_max - peer->fcnt_journaled >= RF_SECURE_PEER_JOURNAL_STEP)
+		RF_SECURE_journal_peer(peer);
+}
+
+//Journal des metteurs : deux pages utilises  tour de rle, chacune commenant par [MAGIC GENERATION] suivi d'enregistrements [FCNT EMITTER].
+//Au dmarrage, chaque metteur retrouve le plus grand FCNT inscrit (dans l'une ou l'autre page) : tous les FCNT jusqu' celui-ci sont des rejeux.
+static void RF_SECURE_load_peers(void)
+{
+	uint32_t address;
+	uint32_t counter;
+	uint32_t emitter;
+	uint32_t generation;
+	bool_e found = FALSE;
+	rf_secure_peer_t * peer;
+
+	peer_journal_address = RF_SECURE_PEER_JOURNAL_ADDRESS;	//aucune page ouverte : RF_SECURE_process_main en ouvrira une
+	peer_journal_generation = 0;
+	for(uint32_t page = RF_SECURE_PEER_JOURNAL_ADDRESS; page < RF_SECURE_PEER_JOURNAL_END; page += RF_SECURE_JOURNAL_PAGE_SIZE)
+	{
+		if(FLASHWRITER_read(page) != RF_SECURE_PEER_JOURNAL_MAGIC)
+			continue;
+		generation = FLASHWRITER_read(page + 4);
+		for(address = page + RF_SECURE_PEER_RECORD_SIZE; address < page + RF_SECURE_JOURNAL_PAGE_SIZE; address += RF_SECURE_PEER_RECORD_SIZE)
+		{
+			counter = FLASHWRITER_read(address);
+			emitter = FLASHWRITER_read(address + 4);
+			if(emitter == 0xFFFFFFFF)
+			{
+				if(counter == 0xFFFFFFFF)
+					break;	//fin de la page
+				continue;	//inscription interrompue par un reset
+			}
+			peer = RF_SECURE_find_peer(emitter);
+			if(peer == NULL)
+			{
+				peer = RF_SECURE_find_peer(0);
+				if(peer == NULL)
+					continue;	//table pleine
+				peer->emitter = emitter;
+				peer->fcnt_max = counter;
+			}
+			else if(counter > peer->fcnt_max)
+				peer->fcnt_max = counter;
+		}
+		if(!found || (int32_t)(generation - peer_journal_generation) > 0)
+		{
+			found = TRUE;
+			peer_journal_generation = generation;
+			peer_journal_address = address;		//en dbut de la page suivante si celle-ci est pleine
+		}
+	}
+	if(peer_journal_address == RF_SECURE_PEER_JOURNAL_END)
+		peer_journal_address = RF_SECURE_PEER_JOURNAL_ADDRESS;
+	for(uint8_t i = 0; i < RF_SECURE_PEERS_NB; i++)
+	{
+		peers[i].last_use = 0;
+		peers[i].window = 0xFFFFFFFF;
+		peers[i].fcnt_journaled = peers[i].fcnt_max;
+		peers[i].journaled = FALSE;
+	}
+}
+
+//Efface la page pointe par peer_journal_address (l'autre contient encore tous les metteurs connus) et y recopie la table.
+static void RF_SECURE_open_peer_journal_page(void)
+{
+	uint32_t page = peer_journal_address;
+
+	FLASHWRITER_erase_page(page);
+	peer_journal_generation++;
+	if(FLASHWRITER_program(page + 4, peer_journal_generation) != END_OK || FLASHWRITER_program(page, RF_SECURE_PEER_JOURNAL_MAGIC) != END_OK)
+		return;	//nouvel essai au prochain passage
+	peer_journal_address = page + RF_SECURE_PEER_RECORD_SIZE;
+	for(uint8_t i = 0; i < RF_SECURE_PEERS_NB; i++)
+	{
+		if(peers[i].emitter != 0)
+			RF_SECURE_journal_peer(&peers[i]);
+	}
+}
+
+//FCNT d'abord, EMITTER ensuite : un enregistrement dont EMITTER est crit est complet.
+//Page pleine : l'metteur sera recopi dans la page suivante, ouverte par RF_SECURE_process_main.
+static void RF_SECURE_journal_peer(rf_secure_peer_t * peer)
+{
+	if((peer_journal_address & (RF_SECURE_JOURNAL_PAGE_SIZE - 1)) == 0)
+		return;
+	if(FLASHWRITER_program(peer_journal_address, peer->fcnt_max) == END_OK && FLASHWRITER_program(peer_journal_address + 4, peer->emitter) == END_OK)
+	{
+		peer->fcnt_journaled = peer->fcnt_max;
+		peer->journaled = TRUE;
+	}
+	peer_journal_address += RF_SECURE_PEER_RECORD_SIZE;
+	if(peer_journal_address == RF_SECURE_PEER_JOURNAL_END)
+		peer_journal_address = RF_SECURE_PEER_JOURNAL_ADDRESS;
+}
+
+void RF_SECURE_get_stats(rf_secure_stats_t * s)
+{
+	if(s != NULL)
+		*s = stats;
+}
+
+void RF_SECURE_print_stats(void)
+{
+	debug_printf("secure: sealed %d (failed %d) opened %d rejected unsealed %d replay %d unknown %d mic %d ecb blocks %d",
+			stats.sealed_nb, stats.seal_failed_nb, stats.opened_nb, stats.unsealed_nb, stats.replay_nb, stats.unknown_nb, stats.mic_failed_nb, stats.ecb_blocks_nb);
+	if(stats.sealed_nb)
+		debug_printf(" seal[us] avg %d max %d", stats.seal_time_sum / stats.sealed_nb, stats.seal_time_max);
+	if(stats.opened_nb)
+		debug_printf(" open[us] avg %d max %d", stats.open_time_sum / stats.opened_nb, stats.open_time_max);
+	debug_printf("\n");
+}
+
+#endif
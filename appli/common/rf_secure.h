@@ -0,0 +1,80 @@
+/*
+ * rf_secure.h
+ *
+ *  Created on: 17 oct. 2026
+ */
+
+#ifndef APPLI_COMMON_RF_SECURE_H_
+#define APPLI_COMMON_RF_SECURE_H_
+
+#include "../config.h"
+#include "macro_types.h"
+#include "secretary.h"
+
+/*
+ * Protection des trames radio : chiffrement et authentification AES-CCM (RFC 3610), avec une cl commune au rseau (RF_SECURE_KEY).
+ * 	Trame scelle = [ENTETE DATAS_CHIFFREES FCNT(4) MIC(4)] : l'entte (complet ou compact) reste en clair, il est authentifi avec les datas.
+ * 	Une trame compacte ne porte que les 16 bits de poids faible de FCNT : le destinataire en dduit les autres du dernier FCNT accept de cet metteur,
+ * 	appris de ses trames  entte complet (jonction, beacons). Ses datas gardent ainsi la place d'une trame  entte complet non protge.
+ * 	Un metteur inconnu, ou oubli faute de place dans la table, n'est reconnu qu' sa prochaine trame  entte complet.
+ * 	DATASIZE est inchang : une trame est reconnue scelle  sa longueur (entte + DATASIZE + RF_SECURE_OVERHEAD ou RF_SECURE_COMPACT_OVERHEAD).
+ * 	Nonce = [EMITTER(4) FCNT(4) 0(5)], o EMITTER est l'adresse complte de l'metteur (dduite de l'adresse courte pour une trame compacte)
+ * 	et FCNT le compteur de trames de l'metteur. Il n'est jamais rutilis : il est rserv en flash par blocs de RF_SECURE_COUNTER_BLOCK
+ * 	(les compteurs rservs et inutiliss avant un reset sont perdus). Comme le reste du protocole, cela suppose des adresses d'metteur uniques.
+ * 	Les bits de TTL de relais de DATASIZE sont exclus du MIC : un relais retransmet la trame telle quelle, sans la desceller ni la resceller.
+ * 	Rejeu : pour chaque metteur, le plus grand FCNT accept et une fentre des RF_SECURE_REPLAY_WINDOW prcdents
+ * 	(les files de priorit de l'metteur peuvent inverser l'ordre d'mission).
+ * 	Le plus grand FCNT accept de chaque metteur est inscrit en flash (RF_SECURE_PEER_JOURNAL_ADDRESS)  sa premire trame aprs le dmarrage,
+ * 	puis toutes les RF_SECURE_PEER_JOURNAL_STEP trames : aprs un reset, tous les FCNT jusqu'au dernier inscrit sont refuss.
+ * 	Seules les trames des RF_SECURE_PEER_JOURNAL_STEP derniers FCNT non inscrits peuvent alors tre rejoues, chacune une seule fois.
+ * 	Les trames reues de l'UART (serveur reli par fil) ne sont pas scelles ; la station scelle celles qu'elle retransmet sur la radio.
+ * 	Les datas d'une trame scelle sont limites  FRAME_MAX_DATA_SIZE (COMPACT_FRAME_MAX_DATA_SIZE pour l'entte compact) :
+ * 	rf_dialog fragmente au besoin, une trame trop longue venant du serveur est refuse.
+ *
+ * 	AES : priphrique ECB du nRF52, un bloc de 16 octets  la fois ; sceller ou ouvrir une trame cote 3 + 2 x ceil(DATASIZE/16) blocs.
+ * 	Le priphrique CCM n'est pas utilis : prvu pour les paquets BLE, il n'authentifie de l'entte que l'octet S0.
+ * 	Les trames sont scelles au moment o elles sont dposes dans les files d'mission, par la tche (ou l'IT) qui les produit :
+ * 	l'enchanement des missions par l'IT radio ne porte que sur des trames prtes, le chiffrement ne la retarde jamais.
+ * 	Elles sont ouvertes en tche de fond, au dpilement de la FIFO de rception.
+ */
+
+#if USE_RF_SECURE
+	#define RF_SECURE_OVERHEAD				8		//[FCNT(4) MIC(4)]
+	#define RF_SECURE_COMPACT_OVERHEAD		6		//[FCNT(2) MIC(4)]
+#else
+	#define RF_SECURE_OVERHEAD				0
+	#define RF_SECURE_COMPACT_OVERHEAD		0
+#endif
+
+#define RF_SECURE_MIC_SIZE				4
+#define RF_SECURE_COUNTER_BLOCK			1024	//compteurs rservs en flash  chaque criture
+#define RF_SECURE_JOURNAL_ADDRESS		0x5000	//deux pages de la zone FLASHWRITER, utilises  tour de rle (voir mailbox.h pour 0x4000)
+#define RF_SECURE_PEER_JOURNAL_ADDRESS	0x7000	//deux pages de la zone FLASHWRITER : FCNT des metteurs
+#define RF_SECURE_PEER_JOURNAL_STEP		256		//trames acceptes d'un metteur entre deux inscriptions de son FCNT
+#define RF_SECURE_REPLAY_WINDOW			32
+#define RF_SECURE_PEERS_NB				((OBJECT_ID == OBJECT_BASE_STATION)?64:16)
+
+typedef struct
+{
+	uint32_t sealed_nb;
+	uint32_t seal_failed_nb;		//trame trop longue une fois scelle, ou compteurs puiss
+	uint32_t opened_nb;
+	uint32_t unsealed_nb;			//trames radio reues sans protection (ou de longueur incohrente)
+	uint32_t replay_nb;
+	uint32_t unknown_nb;			//trames compactes d'un metteur dont le FCNT ne nous est pas (ou plus) connu
+	uint32_t mic_failed_nb;
+	uint32_t ecb_blocks_nb;
+	uint32_t seal_time_sum;			//[us]
+	uint32_t seal_time_max;			//[us]
+	uint32_t open_time_sum;			//[us]
+	uint32_t open_time_max;			//[us]
+}rf_secure_stats_t;
+
+void RF_SECURE_init(void);
+void RF_SECURE_process_main(void);
+bool_e RF_SECURE_seal(uint8_t pipe, uint8_t * frame, uint8_t * size);
+bool_e RF_SECURE_open(rf_frame_t * frame, uint8_t * datas);
+void RF_SECURE_get_stats(rf_secure_stats_t * s);
+void RF_SECURE_print_stats(void);
+
+#endif /* APPLI_COMMON_RF_SECURE_H_ */
@@ -0,0 +1,276 @@
+/*
+ * rf_stats.c
+ *
+ *  Created on: 17 oct. 2026
+ */
+#include "../config.h"
+#include "rf_stats.h"
+#include "systick.h"
+#include "rf_dialog.h"
+
+//Compteurs globaux. Les compteurs d'mission sont incrments sous IT (ou sous section critique).
+static volatile uint32_t tx_success_nb;
+static volatile uint32_t tx_failed_nb;
+static volatile uint32_t tx_dropped_nb;
+static uint32_t rx_nb;
+static uint32_t rx_rejected_nb;
+
+static rf_stats_peer_t peers[RF_STATS_PEERS_NB];
+static rf_stats_msg_id_t msg_ids[RF_STATS_MSG_IDS_NB];	//les RF_STATS_MSG_IDS_NB premiers MSG_ID rencontrs
+
+static const uint16_t latency_bounds[RF_STATS_LATENCY_BINS_NB-1] = RF_STATS_LATENCY_BOUNDS;
+
+static rf_stats_peer_t * RF_STATS_find_peer(uint32_t address, bool_e create);
+static rf_stats_msg_id_t * RF_STATS_find_msg_id(uint8_t msg_id);
+static void RF_STATS_add_latency(uint16_t * bins, uint32_t latency_ms);
+static uint8_t RF_STATS_put_u32(uint8_t * datas, uint32_t value);
+static uint8_t RF_STATS_put_bins(uint8_t * datas, uint16_t * bins);
+
+void RF_STATS_init(void)
+{
+	tx_success_nb = 0;
+	tx_failed_nb = 0;
+	tx_dropped_nb = 0;
+	rx_nb = 0;
+	rx_rejected_nb = 0;
+	for(uint8_t i = 0; i < RF_STATS_PEERS_NB; i++)
+		peers[i] = (rf_stats_peer_t){0};
+	for(uint8_t i = 0; i < RF_STATS_MSG_IDS_NB; i++)
+		msg_ids[i] = (rf_stats_msg_id_t){0};
+}
+
+//Correspondant address ; s'il est inconnu et que create vaut TRUE, il prend un emplacement libre (NULL si la table est pleine).
+static rf_stats_peer_t * RF_STATS_find_peer(uint32_t address, bool_e create)
+{
+	if(address == 0)
+		return NULL;
+	for(uint8_t i = 0; i < RF_STATS_PEERS_NB; i++)
+	{
+		if(peers[i].address == address)
+			return &peers[i];
+		if(peers[i].address == 0)
+		{
+			if(!create)
+				return NULL;
+			peers[i].address = address;
+			return &peers[i];
+		}
+	}
+	return NULL;
+}
+
+//Appele aussi sous IT : les appelants en tache de fond passent par une section critique.
+static rf_stats_msg_id_t * RF_STATS_find_msg_id(uint8_t msg_id)
+{
+	for(uint8_t i = 0; i < RF_STATS_MSG_IDS_NB; i++)
+	{
+		if(msg_ids[i].used && msg_ids[i].msg_id == msg_id)
+			return &msg_ids[i];
+		if(!msg_ids[i].used)
+		{
+			msg_ids[i].used = TRUE;
+			msg_ids[i].msg_id = msg_id;
+			return &msg_ids[i];
+		}
+	}
+	return NULL;
+}
+
+static void RF_STATS_add_latency(uint16_t * bins, uint32_t latency_ms)
+{
+	uint8_t bin;
+	for(bin = 0; bin < RF_STATS_LATENCY_BINS_NB - 1; bin++)
+	{
+		if(latency_ms < latency_bounds[bin])
+			break;
+	}
+	if(bins[bin] < 0xFFFF)
+		bins[bin]++;
+}
+
+//Fin d'mission d'une trame (sous IT radio).
+void RF_STATS_report_tx_done(bool_e success)
+{
+	if(success)
+		tx_success_nb++;
+	else
+		tx_failed_nb++;
+}
+
+//Dpt d'une trame dans une file d'mission (sous section critique). accepted vaut FALSE si la file tait pleine.
+void RF_STATS_report_tx_queued(uint8_t pipe, uint8_t size, uint8_t * datas, bool_e accepted)
+{
+	rf_stats_msg_id_t * entry;
+	uint8_t pos_msg_id = (pipe == RF_DIALOG_PIPE_COMPACT_HEADER)?BYTE_POS_COMPACT_MSG_ID:BYTE_POS_MSG_ID;
+
+	if(!accepted)
+	{
+		tx_dropped_nb++;
+		return;
+	}
+	if(size <= pos_msg_id)
+		return;
+	entry = RF_STATS_find_msg_id(datas[pos_msg_id]);
+	if(entry != NULL)
+		entry->tx_nb++;
+}
+
+//Trame reue par radio, traite en tache de fond.
+void RF_STATS_report_rx(rf_frame_t * frame)
+{
+	rf_stats_peer_t * peer;
+	rf_stats_msg_id_t * entry;
+	uint8_t rssi = frame->payload->rssi;
+	uint32_t primask;
+
+	rx_nb++;
+	peer = RF_STATS_find_peer(frame->emitter, TRUE);
+	if(peer != NULL)
+	{
+		if(peer->rx_nb == 0)
+			peer->rssi_avg = rssi;
+		else
+			peer->rssi_avg = peer->rssi_avg + ((int16_t)rssi - peer->rssi_avg) / RF_STATS_RSSI_FILTER;
+		if(rssi > peer->rssi_worst)
+			peer->rssi_worst = rssi;
+		peer->rssi_last = rssi;
+		peer->rx_nb++;
+	}
+	primask = __get_PRIMASK();
+	__disable_irq();
+	entry = RF_STATS_find_msg_id(frame->msg_id);
+	if(entry != NULL)
+		entry->rx_nb++;
+	__set_PRIMASK(primask);
+}
+
+//Trame reue par radio mais inexploitable (mal forme, ou adresse courte inconnue).
+void RF_STATS_report_rx_rejected(void)
+{
+	rx_rejected_nb++;
+}
+
+//Issue d'un message fiable : acquitt aprs latency_ms, ou attente d'acquittement expire (delivered = FALSE).
+void RF_STATS_report_reliable(uint32_t recipient, uint8_t msg_id, bool_e delivered, uint32_t latency_ms)
+{
+	rf_stats_peer_t * peer;
+	rf_stats_msg_id_t * entry;
+	uint32_t primask;
+
+	peer = RF_STATS_find_peer(recipient, TRUE);
+	if(peer != NULL)
+	{
+		if(delivered)
+		{
+			peer->delivered_nb++;
+			RF_STATS_add_latency(peer->latency_bins, latency_ms);
+		}
+		else
+			peer->lost_nb++;
+	}
+	primask = __get_PRIMASK();
+	__disable_irq();
+	entry = RF_STATS_find_msg_id(msg_id);
+	if(entry != NULL)
+	{
+		if(delivered)
+		{
+			entry->delivered_nb++;
+			RF_STATS_add_latency(entry->latency_bins, latency_ms);
+		}
+		else
+			entry->lost_nb++;
+	}
+	__set_PRIMASK(primask);
+}
+
+static uint8_t RF_STATS_put_u32(uint8_t * datas, uint32_t value)
+{
+	for(uint8_t i = 0; i < 4; i++)
+		datas[i] = (value >> (24-8*i)) & 0xFF;
+	return 4;
+}
+
+static uint8_t RF_STATS_put_bins(uint8_t * datas, uint16_t * bins)
+{
+	for(uint8_t i = 0; i < RF_STATS_LATENCY_BINS_NB; i++)
+	{
+		datas[2*i] = bins[i] >> 8;
+		datas[2*i+1] = bins[i] & 0xFF;
+	}
+	return 2*RF_STATS_LATENCY_BINS_NB;
+}
+
+//Remplit datas (au moins RF_STATS_PAGE_MAX_SIZE octets) avec la page demande. Renvoie sa taille.
+uint8_t RF_STATS_build_page(uint8_t page, uint8_t index, uint8_t * datas)
+{
+	uint8_t size = 0;
+	uint32_t overflow_nb;
+	uint32_t max_occupancy;
+	rf_stats_peer_t peer;
+	rf_stats_msg_id_t entry;
+
+	datas[size++] = page;
+	datas[size++] = index;
+	switch(page)
+	{
+		case RF_STATS_PAGE_GLOBAL:
+			if(index != 0)
+				break;
+			SECRETARY_get_rx_fifo_stats(&overflow_nb, &max_occupancy);
+			size += RF_STATS_put_u32(&datas[size], tx_success_nb);
+			size += RF_STATS_put_u32(&datas[size], tx_failed_nb);
+			size += RF_STATS_put_u32(&datas[size], tx_dropped_nb);
+			size += RF_STATS_put_u32(&datas[size], rx_nb);
+			size += RF_STATS_put_u32(&datas[size], rx_rejected_nb);
+			size += RF_STATS_put_u32(&datas[size], overflow_nb);
+			datas[size++] = (max_occupancy > 0xFF)?0xFF:max_occupancy;
+			size += RF_STATS_put_u32(&datas[size], SYSTICK_get_time_ms()/1000);
+			break;
+		case RF_STATS_PAGE_PEER:
+			if(!RF_STATS_get_peer(index, &peer) || peer.address == 0)
+				break;
+			size += RF_STATS_put_u32(&datas[size], peer.address);
+			size += RF_STATS_put_u32(&datas[size], peer.rx_nb);
+			datas[size++] = peer.rssi_last;
+			datas[size++] = peer.rssi_worst;
+			datas[size++] = peer.rssi_avg;
+			size += RF_STATS_put_u32(&datas[size], peer.delivered_nb);
+			size += RF_STATS_put_u32(&datas[size], peer.lost_nb);
+			size += RF_STATS_put_bins(&datas[size], peer.latency_bins);
+			break;
+		case RF_STATS_PAGE_MSG_ID:
+			if(!RF_STATS_get_msg_id(index, &entry) || !entry.used)
+				break;
+			datas[size++] = entry.msg_id;
+			size += RF_STATS_put_u32(&datas[size], entry.rx_nb);
+			size += RF_STATS_put_u32(&datas[size], entry.tx_nb);
+			size += RF_STATS_put_u32(&datas[size], entry.delivered_nb);
+			size += RF_STATS_put_u32(&datas[size], entry.lost_nb);
+			size += RF_STATS_put_bins(&datas[size], entry.latency_bins);
+			break;
+		default:
+			break;
+	}
+	return size;
+}
+
+bool_e RF_STATS_get_peer(uint8_t index, rf_stats_peer_t * peer)
+{
+	if(index >= RF_STATS_PEERS_NB || peer == NULL)
+		return FALSE;
+	*peer = peers[index];
+	return TRUE;
+}
+
+bool_e RF_STATS_get_msg_id(uint8_t index, rf_stats_msg_id_t * msg_id_stats)
+{
+	uint32_t primask;
+	if(index >= RF_STATS_MSG_IDS_NB || msg_id_stats == NULL)
+		return FALSE;
+	primask = __get_PRIMASK();
+	__disable_irq();
+	*msg_id_stats = msg_ids[index];
+	__set_PRIMASK(primask);
+	return TRUE;
+}
@@ -0,0 +1,82 @@
+/*
+ * rf_stats.h
+ *
+ *  Created on: 17 oct. 2026
+ */
+
+#ifndef APPLI_COMMON_RF_STATS_H_
+#define APPLI_COMMON_RF_STATS_H_
+
+#include "../config.h"
+#include "macro_types.h"
+#include "secretary.h"
+
+/*
+ * Statistiques radio et liaison.
+ * 	Compteurs globaux (missions russies/choues/refuses, rceptions, dbordements de la FIFO de rception),
+ * 	compteurs par correspondant (trames, RSSI, messages fiables acquitts/perdus) et par MSG_ID,
+ * 	avec un petit histogramme de la latence des messages fiables (de la premire mission  l'ACK).
+ * 	Ces statistiques sont lues par pages avec le message STATS_ASK = [PAGE INDEX], auquel rpond STATS_IS = [PAGE INDEX ...].
+ * 	Une page vide ([PAGE INDEX]) indique qu'il n'y a plus d'entre. Les valeurs sur plusieurs octets sont envoyes poids fort en tte.
+ * 	Demand par l'UART, la rponse est crite sur l'UART ; demand par radio, elle est renvoye  l'metteur (par morceaux si besoin).
+ * 	Sur l'UART, une page peut dpasser DATASIZE_MASK : sa taille est alors donne par la longueur du message srie.
+ */
+
+#define RF_STATS_PEERS_NB			8
+#define RF_STATS_MSG_IDS_NB			8
+#define RF_STATS_LATENCY_BINS_NB	8
+#define RF_STATS_LATENCY_BOUNDS		{2, 5, 10, 20, 50, 100, 200}	//[ms] bornes suprieures des RF_STATS_LATENCY_BINS_NB-1 premires classes
+#define RF_STATS_RSSI_FILTER		8		//la moyenne glissante du RSSI prend 1/RF_STATS_RSSI_FILTER de chaque mesure
+
+typedef enum
+{
+	RF_STATS_PAGE_GLOBAL = 0,	//[0 0 TX_SUCCESS(4) TX_FAILED(4) TX_DROPPED(4) RX(4) RX_REJECTED(4) RX_OVERFLOW(4) RX_FIFO_MAX UPTIME_S(4)]
+	RF_STATS_PAGE_PEER,			//[1 INDEX ADDRESS(4) RX(4) RSSI_LAST RSSI_WORST RSSI_AVG DELIVERED(4) LOST(4) LATENCY_BINS(2*8)]
+	RF_STATS_PAGE_MSG_ID,		//[2 INDEX MSG_ID RX(4) TX(4) DELIVERED(4) LOST(4) LATENCY_BINS(2*8)]
+	RF_STATS_PAGE_NB
+}rf_stats_page_e;
+
+#define RF_STATS_PAGE_MAX_SIZE		40	//[octets] taille de la plus grande page
+
+typedef struct
+{
+	uint32_t address;			//0 : emplacement libre
+	uint32_t rx_nb;
+	uint8_t rssi_last;			//[-dBm]
+	uint8_t rssi_worst;			//[-dBm] plus faible niveau reu
+	uint8_t rssi_avg;			//[-dBm] moyenne glissante
+	uint32_t delivered_nb;		//messages fiables acquitts
+	uint32_t lost_nb;			//attentes d'acquittement expires
+	uint16_t latency_bins[RF_STATS_LATENCY_BINS_NB];
+}rf_stats_peer_t;
+
+typedef struct
+{
+	bool_e used;
+	uint8_t msg_id;
+	uint32_t rx_nb;
+	uint32_t tx_nb;				//trames dposes dans les files d'mission
+	uint32_t delivered_nb;
+	uint32_t lost_nb;
+	uint16_t latency_bins[RF_STATS_LATENCY_BINS_NB];
+}rf_stats_msg_id_t;
+
+void RF_STATS_init(void);
+
+void RF_STATS_report_tx_done(bool_e success);
+
+void RF_STATS_report_tx_queued(uint8_t pipe, uint8_t size, uint8_t * datas, bool_e accepted);
+
+void RF_STATS_report_rx(rf_frame_t * frame);
+
+void RF_STATS_report_rx_rejected(void);
+
+void RF_STATS_report_reliable(uint32_t recipient, uint8_t msg_id, bool_e delivered, uint32_t latency_ms);
+
+uint8_t RF_STATS_build_page(uint8_t page, uint8_t index, uint8_t * datas);
+
+bool_e RF_STATS_get_peer(uint8_t index, rf_stats_peer_t * peer);
+
+bool_e RF_STATS_get_msg_id(uint8_t index, rf_stats_msg_id_t * msg_id_stats);
+
+#endif /* APPLI_COMMON_RF_STATS_H_ */
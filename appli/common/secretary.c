@@ -16,22 +16,115 @@
 #include "modules/nrfx/hal/nrf_gpio.h"
 #include "components/proprietary_rf/esb/nrf_esb.h"
 #include "rf_dialog.h"
+#include "systick.h"
+#include "timeslot.h"
+#include "timebase.h"
+#include "rf_channel.h"
+#include "rf_link.h"
+#include "rf_stats.h"
+#include "sniffer.h"
+#include "registry.h"
+#include "mailbox.h"
+#include "rf_relay.h"
+#include "rf_bench.h"
+#include "rf_ping.h"
+#include "rf_secure.h"
+#include "serial_dialog.h"
 
-static nrf_esb_payload_t        rx_payload;
 static nrf_esb_payload_t        tx_payload;
-#if SNIFFER_MODE
-static nrf_esb_payload_t        rx_payload_process_main;
-volatile static _Bool flag_rx_payload_process_main = false;
-#endif
+
+//Filtrage d'adresse par la radio :
+//	- pipe 0 (adresse commune) : trames  entte complet (jonction, diffusion...), reues par tous les noeuds.
+//	- pipe 1 : trames compactes qui nous sont destines. Son prfixe est driv de notre adresse courte,
+//	  la radio rejette donc d'elle-mme les trames compactes destines aux autres noeuds, sans rveiller le CPU.
+//	- pipe 2 : mission seulement ; son prfixe est celui du destinataire de la trame compacte en cours d'mission.
+//	- pipes 3  7 : pipes d'acquittement, ouverts en rception par la station seulement (RF_DIALOG_PIPE_ACK_FIRST...).
+#define PIPE_COMPACT_TX							2
+#define SHORT_ADDRESS_PREFIX(short_address)		(0xC0 | ((short_address) & 0x1F))
+#define PIPES_ACK_MASK							(((1 << (RF_DIALOG_PIPE_ACK_LAST + 1)) - 1) & ~((1 << RF_DIALOG_PIPE_ACK_FIRST) - 1))
+static volatile uint8_t rx_short_address = SHORT_ADDRESS_NONE;
+static volatile bool_e rx_address_update_pending = FALSE;
+static uint8_t rx_ack_pipes = 0;				//station : pipes d'acquittement ouverts en rception
+static volatile uint8_t ack_pipe = RF_DIALOG_PIPE_FULL_HEADER;	//objet : pipe d'mission de nos trames vers la station (voir ACK_PIPE_IS)
+
+//Ajouts  notre copie de nrf_esb.c (absents de nrf_esb.h) : une payload d'acquittement par pipe.
+uint32_t nrf_esb_set_ack_payload(uint8_t pipe, uint8_t const * p_data, uint8_t length);
+
+//Canal radio : un changement demand est appliqu au prochain retour en rception, la radio tant alors au repos.
+static volatile uint8_t rf_channel;
+static volatile bool_e rf_channel_update_pending = FALSE;
+static volatile nrf_esb_bitrate_t bitrate = NRF_ESB_BITRATE_1MBPS;
+static volatile bool_e bitrate_update_pending = FALSE;
+#define RSSI_SAMPLES_NB		8
 static volatile _Bool initialized = false;
 
-typedef enum
-{
-	MSG_SOURCE_RF,
-	MSG_SOURCE_UART
-}msg_source_e;
+//FIFO des trames recues : remplie par l'IT radio (SECRETARY_esb_event_handler), videe par la tache de fond (SECRETARY_process_main).
+//Un seul producteur et un seul consommateur : chacun ne modifie que son propre index, aucune section critique n'est necessaire.
+#define RX_FIFO_SIZE	16		//doit etre une puissance de 2 !
+#define RX_FIFO_MASK	(RX_FIFO_SIZE-1)
 
+typedef struct
+{
+	nrf_esb_payload_t payloads[RX_FIFO_SIZE];
+	uint32_t rx_times_us[RX_FIFO_SIZE];	//instant de rception de chaque trame, relev sous IT
+	volatile uint32_t index_write;		//incremente uniquement par le producteur (IT radio)
+	volatile uint32_t index_read;		//incremente uniquement par le consommateur (tache de fond)
+	volatile uint32_t overflow_nb;		//nombre de trames perdues faute de place dans la FIFO
+	volatile uint32_t max_occupancy;	//remplissage maximal observe depuis l'init
+}rx_fifo_t;
+
+static rx_fifo_t rx_fifo;
+static uint32_t current_rx_time_us;		//instant de rception de la trame en cours de traitement
+
+//Files d'emission, une par classe de priorite. La trame en tete de la file la plus prioritaire est emise des que la radio se libere.
+//Ces files sont alimentees depuis la tache de fond comme depuis les IT : leur manipulation se fait sous section critique.
+typedef struct
+{
+	nrf_esb_payload_t payloads[TX_QUEUE_SIZE];
+	uint8_t index_read;
+	uint8_t nb;
+	tx_queue_stats_t stats;
+}tx_queue_t;
+
+static tx_queue_t tx_queues[TX_PRIORITY_NB];
+static volatile bool_e tx_in_progress = FALSE;
+static tx_priority_e tx_current_priority;
+static volatile uint32_t last_tx_end_time = 0;	//[ms] objet OBJECT_RADIO_SLEEPS : fin de sa dernire mission
+static volatile bool_e radio_asleep = FALSE;
+
+static void SECRETARY_start_next_tx(void);
+static void SECRETARY_start_rx(void);
+static bool_e SECRETARY_radio_may_sleep(void);
+static void SECRETARY_process_radio_sleep(void);
+
+//Cache des dernires trames traites, pour ne pas traiter deux fois la mme trame (retransmission, relais, rception multiple...).
+//Une trame est identifie par son metteur, son destinataire et son MSG_CNT (les compteurs sont tenus par destinataire).
+#define DEDUP_CACHE_SIZE	16
+#define DEDUP_MAX_AGE		1000	//[ms] au-del, une entre est considre comme prime (le compteur 8 bits a pu reboucler)
+
+typedef struct
+{
+	uint32_t emitter;
+	uint32_t recipient;
+	uint8_t msg_cnt;
+	bool_e used;
+	uint32_t time;		//[ms]
+}dedup_entry_t;
+
+static dedup_entry_t dedup_cache[DEDUP_CACHE_SIZE];
+static uint8_t dedup_index_write = 0;
+static uint32_t dedup_lookup_nb = 0;
+static uint32_t dedup_hit_nb = 0;
+
+static bool_e SECRETARY_is_duplicate(rf_frame_t * frame);
+static bool_e SECRETARY_is_alert(nrf_esb_payload_t * payload);
+static bool_e SECRETARY_is_ack_requested(nrf_esb_payload_t * payload);
+static bool_e SECRETARY_is_urgent(tx_priority_e priority, nrf_esb_payload_t * payload);
+
+static bool_e SECRETARY_enqueue(tx_priority_e priority, uint8_t pipe, uint8_t size, uint8_t * datas);
 static void SECRETARY_frame_parse(nrf_esb_payload_t * payload, msg_source_e msg_source);
+static void SECRETARY_process_frame_for_me(rf_frame_t * frame, msg_source_e msg_source);
+static void SECRETARY_unpack_frame(rf_frame_t * frame, msg_source_e msg_source);
 
 void SECRETARY_init(void)
 {
@@ -43,7 +136,9 @@ void SECRETARY_init(void)
 	nrf_esb_config_t nrf_esb_config         = NRF_ESB_DEFAULT_CONFIG;
 	nrf_esb_config.protocol                 = NRF_ESB_PROTOCOL_ESB_DPL;
 	nrf_esb_config.retransmit_delay         = 300+(OBJECT_ID%4)*300;	//300us + 300us*ID !
-	nrf_esb_config.bitrate                  = NRF_ESB_BITRATE_1MBPS;
+	bitrate = NRF_ESB_BITRATE_1MBPS;
+	bitrate_update_pending = FALSE;
+	nrf_esb_config.bitrate                  = bitrate;
 	nrf_esb_config.event_handler            = SECRETARY_esb_event_handler;
 	nrf_esb_config.mode                     = NRF_ESB_MODE_PTX;
 	nrf_esb_config.selective_auto_ack       = true;	//on rend les acquittements dpendant de l'argument du transmetteur !...
@@ -59,24 +154,223 @@ void SECRETARY_init(void)
 	if(err_code == NRF_SUCCESS)
 		nrf_esb_set_prefixes(addr_prefix, NRF_ESB_PIPE_COUNT);
 
+#if USE_RF_ACK_PAYLOAD && !SNIFFER_MODE
+	if(OBJECT_ID == OBJECT_BASE_STATION)
+	{
+		rx_ack_pipes = PIPES_ACK_MASK;
+		for(uint8_t pipe = RF_DIALOG_PIPE_ACK_FIRST; pipe <= RF_DIALOG_PIPE_ACK_LAST && err_code == NRF_SUCCESS; pipe++)
+			err_code = nrf_esb_update_prefix(pipe, RF_DIALOG_ACK_PIPE_PREFIX(pipe));
+	}
+#endif
+	ack_pipe = RF_DIALOG_PIPE_FULL_HEADER;
+
+	if(err_code == NRF_SUCCESS)
+		nrf_esb_enable_pipes((1 << RF_DIALOG_PIPE_FULL_HEADER) | rx_ack_pipes);	//le pipe des trames compactes n'est ouvert qu'une fois notre adresse courte connue
+
+#if USE_RF_SECURE
+	RF_SECURE_init();
+#endif
+	RF_CHANNEL_init();
+	RF_LINK_init();
+	RF_STATS_init();
+	RF_DIALOG_init_groups();
+	RF_RELAY_init();
+	RF_PING_init();
+#if USE_REGISTRY
+	REGISTRY_init();
+#endif
+#if USE_MAILBOX
+	MAILBOX_init();
+#endif
+#if USE_RF_BENCH
+	RF_BENCH_init();
+#endif
+	rf_channel = RF_CHANNEL_get_channel();
+	if(err_code == NRF_SUCCESS)
+		nrf_esb_set_rf_channel(rf_channel);
+
+#if SNIFFER_MODE
+	if(err_code == NRF_SUCCESS)
+		SNIFFER_init();	//tous les pipes ouverts
+#elif USE_RF_DIALOG_COMPACT_HEADER
+	if(OBJECT_ID == OBJECT_BASE_STATION)
+	{
+		rx_short_address = SHORT_ADDRESS_BASE_STATION;	//applique au dmarrage de la rception
+		rx_address_update_pending = TRUE;
+	}
+#endif
+
 	tx_payload.pipe = 0;
 
+	for(tx_priority_e p = 0; p < TX_PRIORITY_NB; p++)
+		tx_queues[p] = (tx_queue_t){0};
+	tx_in_progress = FALSE;
+	last_tx_end_time = SYSTICK_get_time_ms();
+	radio_asleep = FALSE;
+
 	if(err_code == NRF_SUCCESS)
 		initialized = true;
 
-#if SHOE_MODE
-	fifo.index_read = 0;
-	fifo.index_write = 0;
-#endif
+	rx_fifo.index_read = 0;
+	rx_fifo.index_write = 0;
+	rx_fifo.overflow_nb = 0;
+	rx_fifo.max_occupancy = 0;
 
-	nrf_esb_start_rx();
+	for(uint8_t i = 0; i < DEDUP_CACHE_SIZE; i++)
+		dedup_cache[i].used = FALSE;
+
+	TIMESLOT_init();
+	TIMEBASE_init();
+
+	SECRETARY_start_rx();
+
+	if(OBJECT_ID != OBJECT_BASE_STATION && !SNIFFER_MODE)
+		RF_DIALOG_send_recent_reset();	//la station de base met  jour son registre
 }
 
 
 
 void SECRETARY_process_main(void)
 {
+	SECRETARY_consume_fifo();
+#if SNIFFER_MODE
+	SNIFFER_process_main();
+	RF_CHANNEL_process_main();	//recherche de la station si on ne l'entend plus
+	return;
+#endif
+#if USE_RF_SECURE
+	RF_SECURE_process_main();
+#endif
+	RF_DIALOG_process_main();
+	TIMESLOT_process_main();
+	RF_CHANNEL_process_main();
+	RF_LINK_process_main();
+	RF_PING_process_main();
+#if USE_RF_BENCH
+	RF_BENCH_process_main();
+#endif
+	SECRETARY_process_radio_sleep();
+}
+
+//Traitement en tache de fond des trames deposees dans la FIFO par l'IT radio.
+//Les alertes (EVENT_OCCURED) passent avant les trames arrivees plus tot : a la station, elles sont ainsi renvoyees sur l'UART
+//avant le trafic qui attend dans la FIFO. L'ordre d'arrivee n'est donc pas conserve : une alerte peut etre traitee (et remontee
+//au serveur) avant une trame plus ancienne du meme emetteur.
+//Seules les trames presentes a l'appel sont traitees, en deux passages : celles arrivees entre-temps attendent l'appel suivant.
+void SECRETARY_consume_fifo(void)
+{
+	uint32_t index_read = rx_fifo.index_read;
+	uint32_t index_write = rx_fifo.index_write;
+	nrf_esb_payload_t * payload;
+
+#if !SNIFFER_MODE
+	__DMB();
+	for(uint32_t i = index_read; i != index_write; i++)
+	{
+		payload = &rx_fifo.payloads[i & RX_FIFO_MASK];
+		if(SECRETARY_is_alert(payload))
+		{
+			current_rx_time_us = rx_fifo.rx_times_us[i & RX_FIFO_MASK];
+			SECRETARY_frame_parse(payload, MSG_SOURCE_RF);
+			payload->length = 0;	//traitee : la case sera sautee ci-dessous
+		}
+	}
+#endif
+	while(index_read != index_write)
+	{
+		__DMB();	//on s'assure de lire la trame apres avoir lu l'index d'ecriture
+		current_rx_time_us = rx_fifo.rx_times_us[index_read & RX_FIFO_MASK];
+		payload = &rx_fifo.payloads[index_read & RX_FIFO_MASK];
+#if SNIFFER_MODE
+		SNIFFER_capture(payload, current_rx_time_us);
+#else
+		if(payload->length)
+			SECRETARY_frame_parse(payload, MSG_SOURCE_RF);
+#endif
+		__DMB();	//la case n'est rendue au producteur qu'une fois la trame traitee
+		index_read++;
+		rx_fifo.index_read = index_read;
+	}
+}
+
+//Trame en file dont l'metteur attend l'ACK (envoi fiable).
+static bool_e SECRETARY_is_ack_requested(nrf_esb_payload_t * payload)
+{
+	uint8_t pos_datasize = (payload->pipe == RF_DIALOG_PIPE_COMPACT_HEADER)?BYTE_POS_COMPACT_DATASIZE:BYTE_POS_DATASIZE;
+	return (payload->length > pos_datasize && (payload->data[pos_datasize] & DATASIZE_FLAG_ACK_REQUEST))?TRUE:FALSE;
+}
+
+#if !SNIFFER_MODE
+//L'identifiant du message est lisible sans dcoder la trame (il reste en clair dans une trame scelle).
+//Trame autorise hors de notre crneau : message fiable (alerte) ou ACK, attendu par un metteur qui rmet.
+//Station de base : aussi le beacon (mme en retard), le CHANNEL_SET (le changement de canal qui le suit est appliqu ds le retour en rception)
+//et le PONG, rponse immdiate dont le dlai est mesur par l'metteur du PING.
+static bool_e SECRETARY_is_urgent(tx_priority_e priority, nrf_esb_payload_t * payload)
+{
+	uint8_t pos_msg_id = (payload->pipe == RF_DIALOG_PIPE_COMPACT_HEADER)?BYTE_POS_COMPACT_MSG_ID:BYTE_POS_MSG_ID;
+	if(payload->length <= pos_msg_id)
+		return FALSE;
+	if(OBJECT_ID == OBJECT_BASE_STATION && (payload->data[pos_msg_id] == BEACON || payload->data[pos_msg_id] == CHANNEL_SET || payload->data[pos_msg_id] == PONG))
+		return TRUE;
+	if(priority != TX_PRIORITY_ALERT)
+		return FALSE;
+	if(SECRETARY_is_ack_requested(payload))
+		return TRUE;
+	return (payload->data[pos_msg_id] == ACK)?TRUE:FALSE;
+}
+
+static bool_e SECRETARY_is_alert(nrf_esb_payload_t * payload)
+{
+	uint8_t pos_msg_id = (payload->pipe == RF_DIALOG_PIPE_COMPACT_HEADER)?BYTE_POS_COMPACT_MSG_ID:BYTE_POS_MSG_ID;
+	return (payload->length > pos_msg_id && payload->data[pos_msg_id] == EVENT_OCCURED)?TRUE:FALSE;
+}
+#endif
+
+//Instant de rception [us] de la trame en cours de traitement (utile aux messages dats, comme le beacon).
+uint32_t SECRETARY_get_rx_time_us(void)
+{
+	return current_rx_time_us;
+}
+
+void SECRETARY_get_rx_fifo_stats(uint32_t * overflow_nb, uint32_t * max_occupancy)
+{
+	if(overflow_nb != NULL)
+		*overflow_nb = rx_fifo.overflow_nb;
+	if(max_occupancy != NULL)
+		*max_occupancy = rx_fifo.max_occupancy;
+}
 
+//Appelee en IT : on se contente de ranger la trame dans la FIFO, le traitement sera fait par SECRETARY_process_main.
+static void SECRETARY_push_rx_payloads(void)
+{
+	static nrf_esb_payload_t trash_payload;
+	uint32_t index_write = rx_fifo.index_write;
+	uint32_t occupancy;
+	nrf_esb_payload_t * payload;
+
+	while(1)
+	{
+		occupancy = index_write - rx_fifo.index_read;
+		if(occupancy < RX_FIFO_SIZE)
+			payload = &rx_fifo.payloads[index_write & RX_FIFO_MASK];
+		else
+			payload = &trash_payload;	//FIFO pleine : il faut tout de meme vider la FIFO du driver ESB.
+
+		if(nrf_esb_read_rx_payload(payload) != NRF_SUCCESS)
+			break;
+
+		if(payload == &trash_payload)
+			rx_fifo.overflow_nb++;
+		else if(payload->length > 0)
+		{
+			rx_fifo.rx_times_us[index_write & RX_FIFO_MASK] = SYSTICK_get_time_us();
+			__DMB();	//la trame doit etre ecrite avant que le consommateur ne voie l'index
+			index_write++;
+			rx_fifo.index_write = index_write;
+			if(occupancy + 1 > rx_fifo.max_occupancy)
+				rx_fifo.max_occupancy = occupancy + 1;
+		}
+	}
 }
 
 
@@ -85,52 +379,91 @@ void SECRETARY_esb_event_handler(nrf_esb_evt_t const * p_event)
     switch (p_event->evt_id)
     {
         case NRF_ESB_EVENT_TX_SUCCESS:
-        	nrf_esb_start_rx();
+        	last_tx_end_time = SYSTICK_get_time_ms();
+        	tx_queues[tx_current_priority].stats.sent_nb++;
+        	RF_STATS_report_tx_done(TRUE);
+        	if(OBJECT_ID == OBJECT_BASE_STATION && tx_payload.pipe == RF_DIALOG_PIPE_FULL_HEADER && tx_payload.data[BYTE_POS_MSG_ID] == BEACON)
+        		TIMEBASE_beacon_sent(tx_payload.data[BYTE_POS_MSG_CNT], SYSTICK_get_time_us());	//fin d'mission, annonce par le beacon suivant
+        	SECRETARY_start_next_tx();	//trame suivante... ou retour en reception si plus rien a emettre.
             break;
         case NRF_ESB_EVENT_TX_FAILED:
             nrf_esb_flush_tx();
-            nrf_esb_start_tx();
+            last_tx_end_time = SYSTICK_get_time_ms();
+            tx_queues[tx_current_priority].stats.failed_nb++;
+            RF_STATS_report_tx_done(FALSE);
+            SECRETARY_start_next_tx();
             break;
         case NRF_ESB_EVENT_RX_RECEIVED:
-            while (nrf_esb_read_rx_payload(&rx_payload) == NRF_SUCCESS)
-            {
-                if (rx_payload.length > 0)
-                {
-                    SECRETARY_frame_parse(&rx_payload, MSG_SOURCE_RF);
-                }
-            }
-
+            SECRETARY_push_rx_payloads();
             break;
     }
 }
 
 void SECRETARY_frame_parse(nrf_esb_payload_t * payload, msg_source_e msg_source)
 {
-	uint32_t recipient;
-	uint8_t msg_id;
-	uint8_t msg_size;
-
+	rf_frame_t frame;
+	bool_e valid;
+#if USE_RF_SECURE
+	uint8_t datas[COMPACT_MAX_DATA_SIZE];	//datas dchiffres : la payload reste scelle, telle qu'un relais doit la retransmettre
+#endif
 
-		if(payload->length > BYTE_POS_DATASIZE && payload->length <= NRF_ESB_MAX_PAYLOAD_LENGTH)
+		valid = RF_DIALOG_frame_view(&frame, payload);
+#if USE_RF_SECURE
+		if(valid && msg_source == MSG_SOURCE_RF)
+			valid = RF_SECURE_open(&frame, datas);	//trame non scelle, rejoue ou falsifie : ignore
+#endif
+		if(!valid)
+		{
+			if(msg_source == MSG_SOURCE_RF)
+				RF_STATS_report_rx_rejected();
+		}
+		else
 		{
-			recipient = U32FROMU8( payload->data[BYTE_POS_RECIPIENTS],  payload->data[BYTE_POS_RECIPIENTS+1],  payload->data[BYTE_POS_RECIPIENTS+2],  payload->data[BYTE_POS_RECIPIENTS+3]);
+			frame.source = msg_source;
+			if(msg_source == MSG_SOURCE_RF)
+			{
+				RF_CHANNEL_report_rx(frame.emitter);
+				if(RF_RELAY_IS_DIRECT(frame.relay_ttl))
+					RF_LINK_report_rx(frame.emitter, payload->rssi);	//le RSSI d'une trame relaye est celui du relais
+				RF_STATS_report_rx(&frame);
+				RF_RELAY_report_rx(&frame);
+#if USE_REGISTRY
+				REGISTRY_update(&frame);
+#endif
+#if USE_MAILBOX
+				MAILBOX_flush(&frame);	//l'objet vient d'mettre : il coute, c'est le moment de lui envoyer ce qui l'attend
+#endif
+			}
 
 			if(OBJECT_ID == OBJECT_BASE_STATION)
 			{
 				//je suis la station de base
 
-				if(recipient == RF_DIALOG_get_my_base_station_id() || recipient == 0xFFFFFFFF)
+				if(RF_DIALOG_is_for_me(frame.recipient))
 				{
 					//le message est pour moi
-					RF_DIALOG_process_rx_basestation(payload);
-					if(msg_source == MSG_SOURCE_RF)
-						SECRETARY_process_msg_to_uart(payload);	//je renvoie le message sur l'UART
+					if(msg_source == MSG_SOURCE_RF && SECRETARY_is_duplicate(&frame))	//l'UART ne rmet pas : ses trames sont toutes traites
+						RF_DIALOG_ack_duplicate(&frame);	//dj trait : on se contente de l'acquitter  nouveau si besoin
+					else
+						SECRETARY_process_frame_for_me(&frame, msg_source);
 				}
 				else
 				{
 					//le message reu est pour quelqu'un d'autre
 					if(msg_source == MSG_SOURCE_UART)
 					{
+#if USE_REGISTRY
+						if(REGISTRY_answer_for_object(&frame))
+							return;	//valeur rcente connue : rponse au serveur sans passer par la radio
+#endif
+#if USE_RF_SECURE
+						if(frame.datasize > FRAME_MAX_DATA_SIZE)
+							return;	//ne tiendrait pas dans une trame scelle (voir rf_secure.h)
+#endif
+#if USE_MAILBOX
+						if(MAILBOX_store(&frame))
+							return;	//objet endormi : le message lui sera envoy aprs sa prochaine mission
+#endif
 						//le message vient de l'UART (donc du serveur !), on le relaye vers le RF
 						SECRETARY_send_msg(payload->length, payload->data);
 					}
@@ -141,12 +474,17 @@ void SECRETARY_frame_parse(nrf_esb_payload_t * payload, msg_source_e msg_source)
 			}
 			else{
 				//je suis un objet
-				if(recipient == OBJECT_ID)
+#if USE_RF_RELAY
+				if(msg_source == MSG_SOURCE_RF)
+					RF_RELAY_forward(&frame);	//relais : retransmission ventuelle, avant tout traitement local
+#endif
+				if(RF_DIALOG_is_for_me(frame.recipient))	//adresse propre, diffusion, ou groupe dont je suis membre
 				{
 					//super, le message est pour moi !
-					RF_DIALOG_process_rx_object(payload);
-					if(msg_source == MSG_SOURCE_RF)
-						SECRETARY_process_msg_to_uart(payload);	//je renvoie le message sur l'UART
+					if(msg_source == MSG_SOURCE_RF && SECRETARY_is_duplicate(&frame))	//l'UART ne rmet pas : ses trames sont toutes traites
+						RF_DIALOG_ack_duplicate(&frame);	//dj trait : on se contente de l'acquitter  nouveau si besoin
+					else
+						SECRETARY_process_frame_for_me(&frame, msg_source);
 				}
 				else
 				{
@@ -166,6 +504,87 @@ void SECRETARY_frame_parse(nrf_esb_payload_t * payload, msg_source_e msg_source)
 
 
 
+//Renvoie TRUE si cette trame radio a dj t traite rcemment. Sinon, elle est ajoute au cache.
+static bool_e SECRETARY_is_duplicate(rf_frame_t * frame)
+{
+	uint32_t now = SYSTICK_get_time_ms();
+	dedup_entry_t * entry;
+
+	dedup_lookup_nb++;
+	for(uint8_t i = 0; i < DEDUP_CACHE_SIZE; i++)
+	{
+		entry = &dedup_cache[i];
+		if(entry->used && now - entry->time > DEDUP_MAX_AGE)
+			entry->used = FALSE;	//entre prime
+		if(entry->used && entry->msg_cnt == frame->msg_cnt && entry->emitter == frame->emitter && entry->recipient == frame->recipient)
+		{
+			dedup_hit_nb++;
+			return TRUE;
+		}
+	}
+
+	//nouvelle trame : on remplace la plus ancienne entre
+	entry = &dedup_cache[dedup_index_write];
+	dedup_index_write = (dedup_index_write + 1) % DEDUP_CACHE_SIZE;
+	entry->used = TRUE;
+	entry->emitter = frame->emitter;
+	entry->recipient = frame->recipient;
+	entry->msg_cnt = frame->msg_cnt;
+	entry->time = now;
+	return FALSE;
+}
+
+void SECRETARY_get_dedup_stats(uint32_t * lookup_nb, uint32_t * hit_nb)
+{
+	if(lookup_nb != NULL)
+		*lookup_nb = dedup_lookup_nb;
+	if(hit_nb != NULL)
+		*hit_nb = dedup_hit_nb;
+}
+
+static void SECRETARY_process_frame_for_me(rf_frame_t * frame, msg_source_e msg_source)
+{
+	if(frame->msg_id == PACKED_MSGS)
+	{
+		SECRETARY_unpack_frame(frame, msg_source);
+		return;
+	}
+
+	RF_DIALOG_process_rx(frame);
+
+	if(msg_source == MSG_SOURCE_RF)
+		SECRETARY_process_msg_to_uart(frame);	//je renvoie le message sur l'UART
+}
+
+//Une trame PACKED_MSGS regroupe plusieurs messages de mme destinataire et de mme metteur.
+//Ses datas sont une suite de [MSG_ID DATASIZE DATAS...]. Chaque message est prsent sous la forme d'une vue reprenant l'entte
+//de la trame groupe (sans recopie des datas) puis trait comme s'il avait t reu seul.
+static void SECRETARY_unpack_frame(rf_frame_t * frame, msg_source_e msg_source)
+{
+	rf_frame_t sub_frame;
+	uint8_t index;
+	uint8_t msg_id;
+	uint8_t datasize;
+
+	sub_frame = *frame;
+	sub_frame.ack_requested = FALSE;	//l'acquittement ventuel concerne la trame groupe, dj trait
+
+	for(index = 0; index + 2 <= frame->datasize; index += 2 + datasize)
+	{
+		msg_id = frame->datas[index];
+		datasize = frame->datas[index+1];
+		if(index + 2 + datasize > frame->datasize || datasize > MAX_DATA_SIZE || msg_id == PACKED_MSGS)
+			break;	//trame mal forme, on abandonne la suite.
+
+		sub_frame.msg_id = msg_id;
+		sub_frame.datasize = datasize;
+		sub_frame.datas = &frame->datas[index+2];
+
+		SECRETARY_process_frame_for_me(&sub_frame, msg_source);
+	}
+}
+
+
 //Cette fonction permet de convertir un message reu sur l'UART en une "fausse trame RF"...  des fins de tests.
 void SECRETARY_process_msg_from_uart(uint8_t size, uint8_t * datas)
 {
@@ -176,10 +595,11 @@ void SECRETARY_process_msg_from_uart(uint8_t size, uint8_t * datas)
 		initialized = TRUE;
 		fake_payload.noack = FALSE;
 		fake_payload.pid = 0;
-		fake_payload.pipe = 0;
+		fake_payload.pipe = RF_DIALOG_PIPE_FULL_HEADER;	//l'UART utilise toujours l'entte complet
 		fake_payload.rssi = 0;
 	}
 
+	size = MIN(size, NRF_ESB_MAX_PAYLOAD_LENGTH);
 	fake_payload.length = size;
 	for(uint8_t i=0; i<size; i++)
 	{
@@ -190,38 +610,368 @@ void SECRETARY_process_msg_from_uart(uint8_t size, uint8_t * datas)
 }
 
 
-void SECRETARY_process_msg_to_uart(nrf_esb_payload_t * payload)
+//Le message est toujours renvoy sur l'UART avec l'entte complet, quel que soit le format reu sur la radio.
+void SECRETARY_process_msg_to_uart(rf_frame_t * frame)
 {
 	SERIAL_DIALOG_putc(0xBA);
-	SERIAL_DIALOG_putc(payload->length);
-	for(uint8_t i=0; i<payload->length; i++)
-		SERIAL_DIALOG_putc(payload->data[i]);
+	SERIAL_DIALOG_putc(BYTE_POS_DATAS + frame->datasize);
+	for(uint8_t i=0; i<BYTE_QTY_RECIPIENTS; i++)
+		SERIAL_DIALOG_putc((frame->recipient >> (24-8*i)) & 0xFF);
+	for(uint8_t i=0; i<BYTE_QTY_EMITTER; i++)
+		SERIAL_DIALOG_putc((frame->emitter >> (24-8*i)) & 0xFF);
+	SERIAL_DIALOG_putc(frame->msg_cnt);
+	SERIAL_DIALOG_putc(frame->msg_id);
+	SERIAL_DIALOG_putc(frame->datasize | ((frame->ack_requested)?DATASIZE_FLAG_ACK_REQUEST:0));
+	for(uint16_t i=0; i<frame->datasize; i++)
+		SERIAL_DIALOG_putc(frame->datas[i]);
 	SERIAL_DIALOG_putc(0xDA);
 }
 
+//Rponse faite par la station elle-mme  une demande du serveur (reue sur l'UART).
+void SECRETARY_send_to_uart(uint32_t recipient, uint32_t emitter, uint8_t msg_id, uint8_t datasize, uint8_t * datas)
+{
+	rf_frame_t frame;
+
+	frame.recipient = recipient;
+	frame.emitter = emitter;
+	frame.msg_cnt = 0;
+	frame.msg_id = msg_id;
+	frame.datasize = datasize;
+	frame.ack_requested = FALSE;
+	frame.relay_ttl = RF_RELAY_TTL_NONE;
+	frame.datas = datas;
+	frame.payload = NULL;
+	frame.source = MSG_SOURCE_UART;
+	SECRETARY_process_msg_to_uart(&frame);
+}
+
 void SECRETARY_send_msg(uint8_t size, uint8_t * datas)
 {
-	tx_payload.length = MIN(size,NRF_ESB_MAX_PAYLOAD_LENGTH);
-	for(uint8_t i = 0; i<tx_payload.length; i++)
+	tx_priority_e priority = TX_PRIORITY_TELEMETRY;
+	if(size > BYTE_POS_MSG_ID)
+		priority = RF_DIALOG_get_default_priority(datas[BYTE_POS_MSG_ID]);
+	SECRETARY_send_msg_with_priority(priority, size, datas);
+}
+
+//Depose le message dans la file correspondant a sa priorite. Non bloquant, peut etre appelee en IT.
+//Renvoie FALSE si la file est pleine (le message est alors perdu et compte dans drop_nb).
+bool_e SECRETARY_send_msg_with_priority(tx_priority_e priority, uint8_t size, uint8_t * datas)
+{
+	return SECRETARY_send_msg_on_pipe(priority, RF_DIALOG_PIPE_FULL_HEADER, size, datas);
+}
+
+//Idem, en prcisant le pipe ESB d'mission (qui indique au rcepteur le format d'entte de la trame).
+//La trame est scelle ici (voir rf_secure.h), avant d'entrer en file : l'mission n'attend jamais le chiffrement.
+bool_e SECRETARY_send_msg_on_pipe(tx_priority_e priority, uint8_t pipe, uint8_t size, uint8_t * datas)
+{
+#if USE_RF_SECURE
+	uint8_t sealed[NRF_ESB_MAX_PAYLOAD_LENGTH];
+
+	size = MIN(size, NRF_ESB_MAX_PAYLOAD_LENGTH);
+	for(uint8_t i = 0; i < size; i++)
+		sealed[i] = datas[i];
+	if(!RF_SECURE_seal(pipe, sealed, &size))
+		return FALSE;
+	datas = sealed;
+#endif
+	return SECRETARY_enqueue(priority, pipe, size, datas);
+}
+
+//Relais : la trame, dj scelle par son metteur, est mise en file telle quelle.
+bool_e SECRETARY_forward_msg(tx_priority_e priority, uint8_t size, uint8_t * datas)
+{
+	return SECRETARY_enqueue(priority, RF_DIALOG_PIPE_FULL_HEADER, size, datas);
+}
+
+static bool_e SECRETARY_enqueue(tx_priority_e priority, uint8_t pipe, uint8_t size, uint8_t * datas)
+{
+	bool_e ret = FALSE;
+	nrf_esb_payload_t * payload;
+	tx_queue_t * queue;
+	uint32_t primask;
+
+#if SNIFFER_MODE
+	return FALSE;	//un sniffer n'met jamais
+#endif
+	if(priority >= TX_PRIORITY_NB)
+		priority = TX_PRIORITY_TELEMETRY;
+	queue = &tx_queues[priority];
+	size = MIN(size,NRF_ESB_MAX_PAYLOAD_LENGTH);
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if(queue->nb < TX_QUEUE_SIZE)
 	{
-		tx_payload.data[i] = datas[i];
+		payload = &queue->payloads[(queue->index_read + queue->nb) % TX_QUEUE_SIZE];
+		payload->length = size;
+		for(uint8_t i = 0; i<size; i++)
+			payload->data[i] = datas[i];
+		payload->pipe = pipe;
+		payload->noack = TRUE;	//On demande pas d'acquittement !
+		if(pipe == RF_DIALOG_PIPE_FULL_HEADER)
+			RF_RELAY_stamp(payload);	//TTL de relais si le destinataire (ou nous-mme) ne s'entend pas directement
+		queue->nb++;
+		if(queue->nb > queue->stats.max_depth)
+			queue->stats.max_depth = queue->nb;
+		ret = TRUE;
+		RF_STATS_report_tx_queued(pipe, size, datas, TRUE);
+
+		if(!tx_in_progress)
+			SECRETARY_start_next_tx();
 	}
-	tx_payload.noack = TRUE;	//On demande pas d'acquittement !
-	nrf_esb_stop_rx();
+	else
+	{
+		queue->stats.drop_nb++;
+		RF_STATS_report_tx_queued(pipe, size, datas, FALSE);
+	}
+	__set_PRIMASK(primask);
+	return ret;
+}
+
+//Relance l'mission des trames en attente si la radio est libre (par exemple  l'ouverture de notre crneau).
+void SECRETARY_kick_tx(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(!tx_in_progress)
+		SECRETARY_start_next_tx();
+	__set_PRIMASK(primask);
+}
+
+//Lance l'emission de la prochaine trame, par ordre de priorite. Si toutes les files sont vides, on repasse en reception.
+//Hors de notre crneau, seules les alertes envoyes en mode fiable et les ACK (et ct station, le beacon, les CHANNEL_SET et les PONG) partent : ils n'attendent pas la supertrame suivante
+//(l'metteur d'un message fiable rmet au bout de RF_DIALOG_ACK_TIMEOUT, plus court qu'une supertrame), et les rmissions (jusqu' l'ACK)
+//couvrent le risque de collision. Les autres trames restent en file, SECRETARY_kick_tx() relancera l'mission.
+//Appelee soit sous section critique, soit depuis l'IT ESB.
+static void SECRETARY_start_next_tx(void)
+{
+	tx_priority_e p;
+	tx_queue_t * queue;
+	bool_e slot_open;
 
-	if (nrf_esb_write_payload(&tx_payload) == NRF_SUCCESS)
+	slot_open = TIMESLOT_tx_allowed();
+
+	for(p = 0; p < TX_PRIORITY_NB; p++)
 	{
-		debug_printf("msgsent:");
+		queue = &tx_queues[p];
+		while(queue->nb && (slot_open || SECRETARY_is_urgent(p, &queue->payloads[queue->index_read])))
+		{
+			tx_payload = queue->payloads[queue->index_read];
+			queue->index_read = (queue->index_read + 1) % TX_QUEUE_SIZE;
+			queue->nb--;
+
+			nrf_esb_stop_rx();
+			nrf_esb_set_tx_power(RF_LINK_get_tx_power(&tx_payload));	//puissance adapte au destinataire
+			if(tx_payload.pipe == RF_DIALOG_PIPE_COMPACT_HEADER)
+			{
+				//trame compacte : on l'met  l'adresse du pipe 1 de son destinataire.
+				nrf_esb_update_prefix(PIPE_COMPACT_TX, SHORT_ADDRESS_PREFIX(tx_payload.data[BYTE_POS_COMPACT_RECIPIENT]));
+				tx_payload.pipe = PIPE_COMPACT_TX;
+			}
+#if USE_RF_ACK_PAYLOAD
+			else if(ack_pipe != RF_DIALOG_PIPE_FULL_HEADER && tx_payload.pipe == RF_DIALOG_PIPE_FULL_HEADER
+					&& !(tx_payload.data[BYTE_POS_DATASIZE] & DATASIZE_RELAY_TTL_MASK)	//une trame  relayer doit tre entendue des relais
+					&& U32FROMU8(tx_payload.data[BYTE_POS_RECIPIENTS], tx_payload.data[BYTE_POS_RECIPIENTS+1], tx_payload.data[BYTE_POS_RECIPIENTS+2], tx_payload.data[BYTE_POS_RECIPIENTS+3]) == RF_DIALOG_get_my_base_station_id())
+			{
+				//trame vers la station sur notre pipe d'acquittement : l'acquittement ESB nous apporte nos messages en attente.
+				nrf_esb_update_prefix(ack_pipe, RF_DIALOG_ACK_PIPE_PREFIX(ack_pipe));
+				tx_payload.pipe = ack_pipe;
+				tx_payload.noack = FALSE;
+			}
+#endif
+			if(nrf_esb_write_payload(&tx_payload) == NRF_SUCCESS)
+			{
+				tx_current_priority = p;
+				tx_in_progress = TRUE;
+				return;		//la fin d'emission sera signalee par NRF_ESB_EVENT_TX_SUCCESS ou NRF_ESB_EVENT_TX_FAILED
+			}
+			nrf_esb_flush_tx();
+			queue->stats.failed_nb++;
+		}
+	}
+
+	tx_in_progress = FALSE;
+	SECRETARY_start_rx();
+}
 
+//Retour en rception. Une ventuelle nouvelle adresse courte est applique ici, la radio tant alors au repos.
+static void SECRETARY_start_rx(void)
+{
+	if(rf_channel_update_pending)
+	{
+		rf_channel_update_pending = FALSE;
+		nrf_esb_stop_rx();
+		nrf_esb_set_rf_channel(rf_channel);
 	}
-	else
+	if(bitrate_update_pending)
+	{
+		bitrate_update_pending = FALSE;
+		nrf_esb_stop_rx();
+		nrf_esb_set_bitrate(bitrate);
+	}
+	if(rx_address_update_pending)
+	{
+		rx_address_update_pending = FALSE;
+		nrf_esb_stop_rx();
+		if(rx_short_address == SHORT_ADDRESS_NONE)
+			nrf_esb_enable_pipes((1 << RF_DIALOG_PIPE_FULL_HEADER) | rx_ack_pipes);
+		else
+		{
+			nrf_esb_update_prefix(RF_DIALOG_PIPE_COMPACT_HEADER, SHORT_ADDRESS_PREFIX(rx_short_address));
+			nrf_esb_enable_pipes((1 << RF_DIALOG_PIPE_FULL_HEADER) | (1 << RF_DIALOG_PIPE_COMPACT_HEADER) | rx_ack_pipes);
+		}
+	}
+	if(SECRETARY_radio_may_sleep())
+	{
+		nrf_esb_stop_rx();	//fentre d'coute coule : la radio reste teinte jusqu' notre prochaine mission
+		radio_asleep = TRUE;
+		return;
+	}
+	radio_asleep = FALSE;
+	nrf_esb_start_rx();
+}
+
+//Objet OBJECT_RADIO_SLEEPS : sa radio n'coute que pendant MAILBOX_AWAKE_WINDOW aprs la fin de chacune de ses missions (voir mailbox.h),
+//et autour de l'chance des beacons (voir timeslot.h).
+static bool_e SECRETARY_radio_may_sleep(void)
+{
+	if(!OBJECT_RADIO_SLEEPS || OBJECT_ID == OBJECT_BASE_STATION || SNIFFER_MODE || TIMESLOT_beacon_expected())
+		return FALSE;
+	return (SYSTICK_get_time_ms() - last_tx_end_time >= MAILBOX_AWAKE_WINDOW)?TRUE:FALSE;
+}
+
+//Extinction de la radio  la fin de la fentre d'coute, si aucune mission n'est en cours.
+static void SECRETARY_process_radio_sleep(void)
+{
+	uint32_t primask;
+
+	if(radio_asleep || !SECRETARY_radio_may_sleep())
+		return;
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if(!tx_in_progress)
+		SECRETARY_start_rx();	//applique les changements en attente et teint la radio
+	__set_PRIMASK(primask);
+}
+
+//Adresse courte sur laquelle la radio doit accepter les trames compactes (SHORT_ADDRESS_NONE : aucune).
+void SECRETARY_set_rx_short_address(uint8_t short_address)
+{
+	rx_short_address = short_address;
+	rx_address_update_pending = TRUE;
+	SECRETARY_kick_tx();	//si la radio est inoccupe, la nouvelle adresse est applique tout de suite
+}
+
+//Objet : pipe d'acquittement attribu par la station (RF_DIALOG_PIPE_FULL_HEADER : aucun). Pris en compte ds la prochaine trame mise.
+void SECRETARY_set_ack_pipe(uint8_t pipe)
+{
+	if(pipe < RF_DIALOG_PIPE_ACK_FIRST || pipe > RF_DIALOG_PIPE_ACK_LAST)
+		pipe = RF_DIALOG_PIPE_FULL_HEADER;
+	ack_pipe = pipe;
+}
+
+uint8_t SECRETARY_get_ack_pipe(void)
+{
+	return ack_pipe;
+}
+
+//Station : trame (entte complet)  glisser dans les acquittements des prochaines trames reues sur ce pipe (size 0 : aucune).
+void SECRETARY_set_ack_payload(uint8_t pipe, uint8_t size, uint8_t * datas)
+{
+#if USE_RF_SECURE
+	uint8_t sealed[NRF_ESB_MAX_PAYLOAD_LENGTH];
+
+	size = MIN(size, NRF_ESB_MAX_PAYLOAD_LENGTH);
+	if(size)
+	{
+		for(uint8_t i = 0; i < size; i++)
+			sealed[i] = datas[i];
+		if(!RF_SECURE_seal(RF_DIALOG_PIPE_FULL_HEADER, sealed, &size))
+			size = 0;	//trop longue une fois scelle (les trames du serveur sont pourtant bornes  leur arrive)
+		datas = sealed;
+	}
+#endif
+	nrf_esb_set_ack_payload(pipe, datas, MIN(size, NRF_ESB_MAX_PAYLOAD_LENGTH));
+}
+
+//Les trames dj en file partent encore sur l'ancien canal : le changement a lieu au retour en rception.
+void SECRETARY_set_rf_channel(uint8_t channel)
+{
+	rf_channel = channel;
+	rf_channel_update_pending = TRUE;
+	SECRETARY_kick_tx();
+}
+
+uint8_t SECRETARY_get_rf_channel(void)
+{
+	return rf_channel;
+}
+
+//Comme pour le canal, le nouveau dbit est appliqu au retour en rception.
+void SECRETARY_set_bitrate(nrf_esb_bitrate_t new_bitrate)
+{
+	bitrate = new_bitrate;
+	bitrate_update_pending = TRUE;
+	SECRETARY_kick_tx();
+}
+
+nrf_esb_bitrate_t SECRETARY_get_bitrate(void)
+{
+	return bitrate;
+}
+
+//Mesure du bruit sur un canal : la radio y coute brivement puis revient sur le canal de travail.
+//noise reoit la moyenne des chantillons RSSI [-dBm]. Renvoie FALSE (sans mesure) si une mission est en cours.
+bool_e SECRETARY_measure_channel_noise(uint8_t channel, uint8_t * noise)
+{
+	uint32_t primask;
+	uint32_t sum = 0;
+	uint32_t timeout;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if(tx_in_progress)
+	{
+		__set_PRIMASK(primask);
+		return FALSE;
+	}
+	tx_in_progress = TRUE;	//aucune mission ne peut dmarrer pendant la mesure
+	__set_PRIMASK(primask);
+
+	nrf_esb_stop_rx();
+	nrf_esb_set_rf_channel(channel);
+	nrf_esb_start_rx();
+	for(timeout = 10000; timeout && NRF_RADIO->STATE != RADIO_STATE_STATE_Rx && NRF_RADIO->STATE != RADIO_STATE_STATE_RxIdle; timeout--);
+	for(uint8_t i = 0; i < RSSI_SAMPLES_NB; i++)
+	{
+		NRF_RADIO->EVENTS_RSSIEND = 0;
+		NRF_RADIO->TASKS_RSSISTART = 1;
+		for(timeout = 1000; timeout && !NRF_RADIO->EVENTS_RSSIEND; timeout--);
+		sum += NRF_RADIO->RSSISAMPLE;
+	}
+	nrf_esb_stop_rx();
+	nrf_esb_set_rf_channel(rf_channel);
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	tx_in_progress = FALSE;
+	SECRETARY_start_next_tx();	//trames arrives pendant la mesure, ou retour en rception
+	__set_PRIMASK(primask);
+
+	*noise = sum / RSSI_SAMPLES_NB;
+	return TRUE;
+}
+
+void SECRETARY_get_tx_queue_stats(tx_priority_e priority, tx_queue_stats_t * stats)
+{
+	if(priority < TX_PRIORITY_NB && stats != NULL)
 	{
-		nrf_esb_flush_tx();
-		debug_printf("failtosend:");
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		*stats = tx_queues[priority].stats;
+		stats->depth = tx_queues[priority].nb;
+		__set_PRIMASK(primask);
 	}
-	for(uint8_t i = 0; i<tx_payload.length; i++)
-		debug_printf("%02x ", tx_payload.data[i]);
-	debug_printf("\n");
 }
 
 
@@ -12,6 +12,47 @@
 #include <stdint.h>
 #include "../config.h"
 
+//Classes de priorite des files d'emission, de la plus prioritaire a la moins prioritaire.
+typedef enum
+{
+	TX_PRIORITY_ALERT = 0,		//evenements et alarmes
+	TX_PRIORITY_REPLY,			//reponses et messages de controle (PONG, PARAMETER_IS sur demande...)
+	TX_PRIORITY_TELEMETRY,		//remontees periodiques des capteurs
+	TX_PRIORITY_NB
+}tx_priority_e;
+
+#define TX_QUEUE_SIZE	8	//nombre de trames en attente par classe de priorite
+
+typedef struct
+{
+	uint8_t depth;			//nombre de trames en attente
+	uint8_t max_depth;		//remplissage maximal observe
+	uint32_t sent_nb;		//trames emises
+	uint32_t failed_nb;		//trames dont l'emission a echoue
+	uint32_t drop_nb;		//trames refusees car la file etait pleine
+}tx_queue_stats_t;
+
+typedef enum
+{
+	MSG_SOURCE_RF,
+	MSG_SOURCE_UART
+}msg_source_e;
+
+//Vue d'une trame reue, dcode une fois pour toutes (voir RF_DIALOG_frame_view). Quel que soit le format d'entte reu,
+//les adresses sont exprimes sous leur forme complte. Aucune recopie : datas pointe dans la payload ESB (ou dans le tampon de rassemblage d'un bloc fragment).
+typedef struct
+{
+	nrf_esb_payload_t * payload;
+	uint32_t recipient;
+	uint32_t emitter;
+	uint8_t msg_cnt;
+	uint8_t msg_id;
+	uint16_t datasize;			//sans les drapeaux, born  la longueur relle de la payload (ou taille du bloc rassembl)
+	bool_e ack_requested;
+	uint8_t relay_ttl;			//TTL de relais (RF_RELAY_TTL_NONE : trame directe), voir rf_relay.h
+	uint8_t * datas;
+	msg_source_e source;		//trame reue par radio, ou injecte par l'UART
+}rf_frame_t;
 
 void SECRETARY_esb_event_handler(nrf_esb_evt_t const * p_event);
 
@@ -21,13 +62,45 @@ void SECRETARY_init(void);
 
 void SECRETARY_process_msg_from_uart(uint8_t size, uint8_t * datas);
 
-void SECRETARY_process_msg_to_uart(nrf_esb_payload_t * payload);
+void SECRETARY_process_msg_to_uart(rf_frame_t * frame);
+void SECRETARY_send_to_uart(uint32_t recipient, uint32_t emitter, uint8_t msg_id, uint8_t datasize, uint8_t * datas);
+void SECRETARY_set_ack_pipe(uint8_t pipe);
+uint8_t SECRETARY_get_ack_pipe(void);
+void SECRETARY_set_ack_payload(uint8_t pipe, uint8_t size, uint8_t * datas);
 
 void SECRETARY_send_msg(uint8_t size, uint8_t * datas);
 
+bool_e SECRETARY_send_msg_with_priority(tx_priority_e priority, uint8_t size, uint8_t * datas);
+
+bool_e SECRETARY_send_msg_on_pipe(tx_priority_e priority, uint8_t pipe, uint8_t size, uint8_t * datas);
+
+bool_e SECRETARY_forward_msg(tx_priority_e priority, uint8_t size, uint8_t * datas);
+
+void SECRETARY_get_tx_queue_stats(tx_priority_e priority, tx_queue_stats_t * stats);
+
+void SECRETARY_kick_tx(void);
+
+void SECRETARY_set_rx_short_address(uint8_t short_address);
+
+void SECRETARY_set_rf_channel(uint8_t channel);
+
+uint8_t SECRETARY_get_rf_channel(void);
+
+void SECRETARY_set_bitrate(nrf_esb_bitrate_t bitrate);
+
+nrf_esb_bitrate_t SECRETARY_get_bitrate(void);
+
+bool_e SECRETARY_measure_channel_noise(uint8_t channel, uint8_t * noise);
+
+uint32_t SECRETARY_get_rx_time_us(void);
+
 _Bool SECRETARY_toggle_debug_mode(void);
 
 void SECRETARY_consume_fifo(void);
 
+void SECRETARY_get_rx_fifo_stats(uint32_t * overflow_nb, uint32_t * max_occupancy);
+
+void SECRETARY_get_dedup_stats(uint32_t * lookup_nb, uint32_t * hit_nb);
+
 
 #endif /* APPLI_SECRETARY_H_ */
@@ -44,7 +44,11 @@ static void SERIAL_DIALOG_uart_event_handler(app_uart_evt_t * p_event);
 static void SERIAL_DIALOG_parse_rx(uint8_t c);
 
 #define RX_BUF_SIZE		128
-#define TX_BUF_SIZE		128
+#if SNIFFER_MODE
+	#define TX_BUF_SIZE		1024	//le flux de capture doit pouvoir s'couler pendant que la tache de fond est occupe
+#else
+	#define TX_BUF_SIZE		128
+#endif
 
 static app_uart_buffers_t buffers;
 static uint8_t     rx_buf[RX_BUF_SIZE];
@@ -117,6 +121,8 @@ void SERIAL_DIALOG_init(void)
 		false,	//use parity
 #ifdef UART_AT_BAUDRATE_9600
          NRF_UARTE_BAUDRATE_9600
+#elif SNIFFER_MODE
+		 NRF_UARTE_BAUDRATE_1000000
 #else
 		 NRF_UARTE_BAUDRATE_115200
 #endif
@@ -180,6 +186,12 @@ void SERIAL_DIALOG_putc(char c)
 	app_uart_put(c);
 }
 
+//Version non bloquante : renvoie FALSE (sans rien envoyer) si la FIFO d'mission est pleine.
+bool_e SERIAL_DIALOG_try_putc(uint8_t c)
+{
+	return (app_uart_put(c) == NRF_SUCCESS)?TRUE:FALSE;
+}
+
 void SERIAL_DIALOG_puts(char * s)
 {
 	static bool_e reentrance_detection = FALSE;
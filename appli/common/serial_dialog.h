@@ -9,6 +9,7 @@
 #define BURGER_DIALOG_H_
 
 #include <stdint.h>
+#include "macro_types.h"
 
 
 #define SOH		0xBA		//Start Of Header
@@ -19,5 +20,7 @@ void SERIAL_DIALOG_puts(char * s);
 
 void SERIAL_DIALOG_process_main(void);
 void SERIAL_DIALOG_send_msg(uint8_t size, uint8_t * datas);
+bool_e SERIAL_DIALOG_try_putc(uint8_t c);
+void SERIAL_DIALOG_putc(char c);
 
 #endif /* BURGER_DIALOG_H_ */
@@ -0,0 +1,181 @@
+/*
+ * sniffer.c
+ *
+ *  Created on: 17 oct. 2026
+ */
+#include "../config.h"
+#include "sniffer.h"
+#include "secretary.h"
+#include "serial_dialog.h"
+#include "systick.h"
+#include "rf_dialog.h"
+#include "rf_channel.h"
+
+#if SNIFFER_MODE
+
+#define BUFFER_MASK		(SNIFFER_BUFFER_SIZE-1)
+#define SHORT_ADDRESS_PREFIX(short_address)		(0xC0 | ((short_address) & 0x1F))	//mme drivation que le secretary
+#define ROTATING_PIPES_NB	(NRF_ESB_PIPE_COUNT - 2)	//pipes 2  7
+
+//Tampon circulaire des enregistrements en attente d'criture sur l'UART. Rempli et vid par la tache de fond.
+static uint8_t buffer[SNIFFER_BUFFER_SIZE];
+static uint32_t index_write;
+static uint32_t index_read;
+static uint32_t captured_nb;
+static uint32_t dropped_nb;				//trames perdues au total
+static uint32_t dropped_unreported_nb;	//trames perdues pas encore signales dans le flux
+static uint32_t fifo_overflow_reported;	//dbordements de la FIFO de rception du secretary dj compts
+static uint8_t first_short_address;		//premire adresse courte coute par les pipes 2  7
+static uint32_t last_rotation_time;
+
+static void SNIFFER_write_record(uint8_t flags, uint8_t rssi, uint32_t rx_time_us, uint8_t length, uint8_t * datas);
+static void SNIFFER_set_short_addresses(void);
+static void SNIFFER_follow_base_station(nrf_esb_payload_t * payload);
+
+//Appele par SECRETARY_init, la radio tant au repos.
+void SNIFFER_init(void)
+{
+	index_write = 0;
+	index_read = 0;
+	captured_nb = 0;
+	dropped_nb = 0;
+	dropped_unreported_nb = 0;
+	fifo_overflow_reported = 0;
+	first_short_address = 1;
+	last_rotation_time = SYSTICK_get_time_ms();
+
+	nrf_esb_update_prefix(1, SHORT_ADDRESS_PREFIX(SHORT_ADDRESS_BASE_STATION));
+	SNIFFER_set_short_addresses();
+	nrf_esb_enable_pipes(0xFF);
+}
+
+static void SNIFFER_set_short_addresses(void)
+{
+	uint8_t short_address;
+	for(uint8_t i = 0; i < ROTATING_PIPES_NB; i++)
+	{
+		short_address = first_short_address + i;
+		if(short_address >= RF_DIALOG_SHORT_ADDRESSES_NB)
+			short_address = short_address - RF_DIALOG_SHORT_ADDRESSES_NB + 1;	//on reboucle aprs la dernire adresse (0 est dj sur le pipe 1)
+		nrf_esb_update_prefix(2 + i, SHORT_ADDRESS_PREFIX(short_address));
+	}
+}
+
+static void SNIFFER_write_record(uint8_t flags, uint8_t rssi, uint32_t rx_time_us, uint8_t length, uint8_t * datas)
+{
+	uint8_t header[SNIFFER_RECORD_OVERHEAD - 1];
+	uint8_t checksum = 0;
+
+	header[0] = SNIFFER_SYNC;
+	header[1] = flags;
+	header[2] = SECRETARY_get_rf_channel();
+	header[3] = rssi;
+	header[4] = rx_time_us >> 24;
+	header[5] = rx_time_us >> 16;
+	header[6] = rx_time_us >> 8;
+	header[7] = rx_time_us;
+	header[8] = length;
+	for(uint8_t i = 0; i < sizeof(header); i++)
+	{
+		buffer[index_write++ & BUFFER_MASK] = header[i];
+		if(i)
+			checksum ^= header[i];
+	}
+	for(uint8_t i = 0; i < length; i++)
+	{
+		buffer[index_write++ & BUFFER_MASK] = datas[i];
+		checksum ^= datas[i];
+	}
+	buffer[index_write++ & BUFFER_MASK] = checksum;
+}
+
+//Appele par le secretary pour chaque trame sortie de sa FIFO de rception (tache de fond).
+void SNIFFER_capture(nrf_esb_payload_t * payload, uint32_t rx_time_us)
+{
+	uint32_t overflow_nb;
+	uint32_t free_space;
+	uint8_t count[4];
+
+	SECRETARY_get_rx_fifo_stats(&overflow_nb, NULL);
+	dropped_unreported_nb += overflow_nb - fifo_overflow_reported;
+	dropped_nb += overflow_nb - fifo_overflow_reported;
+	fifo_overflow_reported = overflow_nb;
+
+	free_space = SNIFFER_BUFFER_SIZE - (index_write - index_read);
+	if(dropped_unreported_nb)
+	{
+		if(free_space < 2*SNIFFER_RECORD_OVERHEAD + 4 + payload->length)
+		{
+			dropped_unreported_nb++;
+			dropped_nb++;
+			return;
+		}
+		count[0] = dropped_unreported_nb >> 24;
+		count[1] = dropped_unreported_nb >> 16;
+		count[2] = dropped_unreported_nb >> 8;
+		count[3] = dropped_unreported_nb;
+		SNIFFER_write_record(SNIFFER_FLAG_DROPPED, 0, rx_time_us, 4, count);
+		dropped_unreported_nb = 0;
+	}
+	else if(free_space < SNIFFER_RECORD_OVERHEAD + payload->length)
+	{
+		dropped_unreported_nb++;
+		dropped_nb++;
+		return;
+	}
+	SNIFFER_write_record(payload->pipe & SNIFFER_PIPE_MASK, payload->rssi, rx_time_us, payload->length, payload->data);
+	captured_nb++;
+
+	SNIFFER_follow_base_station(payload);
+}
+
+//Les trames de la station de base (entte complet) indiquent que nous sommes sur son canal, et CHANNEL_SET annonce ses changements.
+static void SNIFFER_follow_base_station(nrf_esb_payload_t * payload)
+{
+	rf_frame_t frame;
+	uint8_t flags;
+
+	if(payload->pipe != RF_DIALOG_PIPE_FULL_HEADER || !RF_DIALOG_frame_view(&frame, payload))
+		return;
+	if(frame.emitter != BASE_STATION_EMITTER_ID)
+		return;
+	RF_CHANNEL_report_rx(frame.emitter);
+	if(frame.msg_id == CHANNEL_SET && frame.datasize >= 2 && frame.datasize >= 2 + frame.datas[1])
+	{
+		flags = (frame.datasize > 2 + frame.datas[1])?frame.datas[2 + frame.datas[1]]:0;
+		RF_CHANNEL_channel_set_received(frame.datas[0], frame.datas[1], &frame.datas[2], flags);
+	}
+}
+
+void SNIFFER_process_main(void)
+{
+	uint32_t primask;
+
+	//vidage vers l'UART, sans jamais attendre : ce qui ne rentre pas dans sa FIFO attendra le prochain passage.
+	while(index_read != index_write && SERIAL_DIALOG_try_putc(buffer[index_read & BUFFER_MASK]))
+		index_read++;
+
+	if(SYSTICK_get_time_ms() - last_rotation_time >= SNIFFER_SHORT_ADDRESS_DWELL)
+	{
+		last_rotation_time = SYSTICK_get_time_ms();
+		first_short_address += ROTATING_PIPES_NB;
+		if(first_short_address >= RF_DIALOG_SHORT_ADDRESSES_NB)
+			first_short_address = 1;
+		primask = __get_PRIMASK();
+		__disable_irq();
+		nrf_esb_stop_rx();
+		SNIFFER_set_short_addresses();
+		nrf_esb_start_rx();
+		__set_PRIMASK(primask);
+	}
+}
+
+void SNIFFER_get_stats(uint32_t * captured, uint32_t * dropped)
+{
+	if(captured != NULL)
+		*captured = captured_nb;
+	if(dropped != NULL)
+		*dropped = dropped_nb;
+}
+
+#endif
@@ -0,0 +1,49 @@
+/*
+ * sniffer.h
+ *
+ *  Created on: 17 oct. 2026
+ */
+
+#ifndef APPLI_COMMON_SNIFFER_H_
+#define APPLI_COMMON_SNIFFER_H_
+
+#include "../config.h"
+#include "macro_types.h"
+#include "nrf_esb.h"
+
+/*
+ * Mode sniffer (SNIFFER_MODE  1 dans config_perso.h).
+ * 	La radio reste en rception sur tous les pipes et n'met jamais. Chaque trame reue est crite sur l'UART ( 1Mbps)
+ * 	sous la forme d'un enregistrement binaire :
+ * 		SYNC FLAGS CHANNEL RSSI TIME_US(4) LENGTH DATA[LENGTH] XOR
+ * 	- SYNC vaut SNIFFER_SYNC ; XOR est le ou exclusif des octets de FLAGS  la fin de DATA (il permet de se resynchroniser).
+ * 	- FLAGS : bits 0..2 = pipe de rception (0 : entte complet, 1..7 : entte compact), SNIFFER_FLAG_DROPPED : enregistrement
+ * 	  signalant des trames perdues, DATA = [NB(4)] nombre de trames perdues depuis l'enregistrement prcdent.
+ * 	- TIME_US : instant de rception [us], relev sous IT radio. Valeurs multi-octets poids fort en tte.
+ * 	Les trames passent par la FIFO de rception du secretary puis par un tampon circulaire vid vers l'UART au fil de l'eau.
+ * 	Le pipe 0 reoit les trames  entte complet. Le pipe 1 reoit les trames compactes destines  la station de base,
+ * 	les pipes 2  7 celles destines  6 adresses courtes, renouveles toutes les SNIFFER_SHORT_ADDRESS_DWELL ms.
+ * 	Le sniffer suit le canal de travail annonc par la station (CHANNEL_SET) et la recherche s'il ne l'entend plus.
+ * 	Dcodage ct PC : tools/sniffer_decode.c.
+ */
+
+#if SNIFFER_MODE && OBJECT_ID == OBJECT_BASE_STATION
+	#error "un sniffer ne doit pas tre compil comme station de base (il diffuserait le jeu de canaux)"
+#endif
+
+#define SNIFFER_SYNC					0xA5
+#define SNIFFER_FLAG_DROPPED			0x80
+#define SNIFFER_PIPE_MASK				0x07
+#define SNIFFER_RECORD_OVERHEAD			10		//[octets] SYNC FLAGS CHANNEL RSSI TIME_US(4) LENGTH XOR
+#define SNIFFER_BUFFER_SIZE				4096	//[octets] doit tre une puissance de 2 ! ~40ms de capture d'un canal satur
+#define SNIFFER_SHORT_ADDRESS_DWELL		2000	//[ms] dure d'coute de chaque groupe d'adresses courtes
+
+void SNIFFER_init(void);
+
+void SNIFFER_process_main(void);
+
+void SNIFFER_capture(nrf_esb_payload_t * payload, uint32_t rx_time_us);
+
+void SNIFFER_get_stats(uint32_t * captured_nb, uint32_t * dropped_nb);
+
+#endif /* APPLI_COMMON_SNIFFER_H_ */
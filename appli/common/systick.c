@@ -81,14 +81,21 @@ uint32_t SYSTICK_get_time_us(void)
 
 	uint32_t t_us;
 	uint32_t t_ms;
+	uint32_t primask;
+	primask = __get_PRIMASK();	//peut tre appele en section critique (files d'mission) : on ne ractive pas les IT
 	__disable_irq();
 	t_us = 1000 - SysTick->VAL / 64;
 	t_ms = absolute_time;
-	__enable_irq();
+	__set_PRIMASK(primask);
 
 	return t_ms*1000 + t_us;
 }
 
+uint32_t SYSTICK_get_time_ms(void)
+{
+	return absolute_time;
+}
+
 void SYSTICK_delay_ms(uint32_t duration)
 {
 	uint32_t local;
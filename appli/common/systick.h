@@ -23,6 +23,8 @@ bool_e Systick_remove_callback_function(callback_fun_t func);
 
 uint32_t SYSTICK_get_time_us(void);
 
+uint32_t SYSTICK_get_time_ms(void);
+
 void SYSTICK_delay_ms(uint32_t duration);
 
 void SYSTICK_delay_us(uint32_t duration);
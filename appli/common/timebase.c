@@ -0,0 +1,225 @@
+/*
+ * timebase.c
+ *
+ *  Created on: 17 oct. 2026
+ */
+#include "../config.h"
+#include "timebase.h"
+#include "systick.h"
+#include "timeslot.h"
+#include "nrf.h"
+
+#define TIMEBASE_OFFSET_MODULO_NS	(4294967296LL * 1000)	//2^32 us : l'offset est pris modulo 2^32 us, comme les horloges
+
+typedef struct
+{
+	uint32_t rx_time_us;		//instant local de rception
+	uint8_t seq;				//MSG_CNT du beacon
+	bool_e valid;
+}beacon_rx_t;
+
+//Station
+static volatile uint32_t sent_time_us;
+static volatile uint8_t sent_seq;
+static volatile bool_e sent_valid = FALSE;
+
+//Objet : temps rseau = temps local + ref_offset_ns + drift_ppb x (temps local - ref_local_us)
+//L'offset est tenu  la ns : la boucle peut ainsi corriger des carts d'une fraction de us (les horloges sont  la us).
+static beacon_rx_t history[TIMEBASE_HISTORY_NB];
+static uint8_t history_index = 0;
+static bool_e locked = FALSE;				//offset recal au moins une fois
+static bool_e drift_measured = FALSE;		//drive mesure depuis le dernier recalage
+static uint32_t ref_local_us;
+static int64_t ref_offset_ns;				//[0 ; TIMEBASE_OFFSET_MODULO_NS[
+static int32_t drift_ppb = 0;
+static uint32_t last_sample_ms;
+static timebase_stats_t stats;
+
+void TIMEBASE_init(void)
+{
+	sent_valid = FALSE;
+	for(uint8_t i = 0; i < TIMEBASE_HISTORY_NB; i++)
+		history[i].valid = FALSE;
+	history_index = 0;
+	locked = FALSE;
+	drift_measured = FALSE;
+	ref_local_us = 0;
+	ref_offset_ns = 0;
+	drift_ppb = 0;
+	last_sample_ms = SYSTICK_get_time_ms();
+	stats = (timebase_stats_t){0};
+}
+
+//Station, appele par l'IT radio  la fin de l'mission d'un beacon.
+void TIMEBASE_beacon_sent(uint8_t seq, uint32_t tx_time_us)
+{
+#if USE_TIMEBASE
+	sent_seq = seq;
+	sent_time_us = tx_time_us;
+	sent_valid = TRUE;
+#endif
+}
+
+//Station : datas du prochain beacon, qui datent le prcdent. Renvoie leur taille (0 tant qu'aucun beacon n'est parti).
+uint8_t TIMEBASE_get_beacon_datas(uint8_t * datas)
+{
+#if USE_TIMEBASE
+	uint32_t primask;
+	uint32_t time_us;
+	uint8_t seq;
+
+	if(!sent_valid)
+		return 0;
+	primask = __get_PRIMASK();
+	__disable_irq();
+	seq = sent_seq;
+	time_us = sent_time_us;
+	__set_PRIMASK(primask);
+	datas[0] = seq;
+	datas[1] = (uint8_t)(time_us >> 24);
+	datas[2] = (uint8_t)(time_us >> 16);
+	datas[3] = (uint8_t)(time_us >> 8);
+	datas[4] = (uint8_t)(time_us);
+	return TIMEBASE_BEACON_DATAS_SIZE;
+#else
+	return 0;
+#endif
+}
+
+#if USE_TIMEBASE
+//Offset [ns]  l'instant local donn : il reste suprieur  -TIMEBASE_OFFSET_MODULO_NS (drive borne, instant proche de ref_local_us).
+static int64_t TIMEBASE_offset_ns(uint32_t local_time_us)
+{
+	int32_t elapsed = (int32_t)(local_time_us - ref_local_us);
+	return ref_offset_ns + ((int64_t)drift_ppb * elapsed) / 1000000;	//[ppb] x [us] = 1e-6 [ns]
+}
+
+//Objet : un chantillon = instant local de rception d'un beacon, et son instant d'mission selon la station.
+static void TIMEBASE_add_sample(uint32_t local_us, uint32_t network_us)
+{
+	uint32_t primask;
+	int64_t measured_ns = (int64_t)(network_us - local_us) * 1000;
+	int64_t offset;
+	int64_t error;
+	int32_t error_us;
+	int32_t elapsed;
+	int64_t drift = drift_ppb;
+
+	offset = TIMEBASE_offset_ns(local_us);
+	error = measured_ns - offset;
+	while(error >= TIMEBASE_OFFSET_MODULO_NS/2)
+		error -= TIMEBASE_OFFSET_MODULO_NS;
+	while(error < -TIMEBASE_OFFSET_MODULO_NS/2)
+		error += TIMEBASE_OFFSET_MODULO_NS;
+	error_us = (int32_t)(error / 1000);
+	elapsed = (int32_t)(local_us - ref_local_us);
+	stats.samples_nb++;
+	stats.last_error_us = error_us;
+	last_sample_ms = SYSTICK_get_time_ms();
+
+	if(!locked || elapsed <= 0 || error_us > TIMEBASE_STEP_THRESHOLD_US || error_us < -TIMEBASE_STEP_THRESHOLD_US)
+	{
+		offset = measured_ns;		//recalage : la drive dj estime est conserve
+		drift_measured = FALSE;
+		stats.steps_nb++;
+		stats.max_error_us = 0;
+	}
+	else if(!drift_measured)
+	{
+		drift += error * 1000000 / elapsed;		//[ns/us] -> [ppb]
+		offset = measured_ns;
+		drift_measured = TRUE;
+	}
+	else
+	{
+		drift += error * 1000000 / elapsed / 8;
+		offset += error / 2;
+		if((uint32_t)((error_us < 0)?-error_us:error_us) > stats.max_error_us)
+			stats.max_error_us = (uint32_t)((error_us < 0)?-error_us:error_us);
+	}
+	if(drift > TIMEBASE_DRIFT_MAX_PPB)
+		drift = TIMEBASE_DRIFT_MAX_PPB;
+	else if(drift < -TIMEBASE_DRIFT_MAX_PPB)
+		drift = -TIMEBASE_DRIFT_MAX_PPB;
+	if(offset < 0)
+		offset += TIMEBASE_OFFSET_MODULO_NS;
+	else if(offset >= TIMEBASE_OFFSET_MODULO_NS)
+		offset -= TIMEBASE_OFFSET_MODULO_NS;
+
+	primask = __get_PRIMASK();
+	__disable_irq();	//l'horloge rseau peut tre lue sous IT
+	ref_local_us = local_us;
+	ref_offset_ns = offset;
+	drift_ppb = (int32_t)drift;
+	locked = TRUE;
+	__set_PRIMASK(primask);
+}
+#endif
+
+uint32_t TIMEBASE_local_to_network(uint32_t local_time_us)
+{
+#if USE_TIMEBASE
+	return local_time_us + (uint32_t)((TIMEBASE_offset_ns(local_time_us) + TIMEBASE_OFFSET_MODULO_NS + 500) / 1000);	//arrondi  la us
+#else
+	return local_time_us;
+#endif
+}
+
+//Objet, appele au traitement de chaque beacon reu (rx_time_us : instant local de rception, dat sous IT).
+void TIMEBASE_beacon_received(rf_frame_t * frame, uint32_t rx_time_us)
+{
+#if USE_TIMEBASE
+	if(OBJECT_ID == OBJECT_BASE_STATION || frame->source != MSG_SOURCE_RF)
+		return;
+	if(frame->datasize >= TIMEBASE_BEACON_DATAS_SIZE)
+	{
+		for(uint8_t i = 0; i < TIMEBASE_HISTORY_NB; i++)
+		{
+			if(history[i].valid && history[i].seq == frame->datas[0])
+			{
+				history[i].valid = FALSE;
+				if(rx_time_us - history[i].rx_time_us < TIMEBASE_HISTORY_NB*TIMESLOT_SUPERFRAME_DURATION_US)	//sinon : MSG_CNT revenu au mme point (beacons perdus, reset de la station)
+					TIMEBASE_add_sample(history[i].rx_time_us, U32FROMU8(frame->datas[1], frame->datas[2], frame->datas[3], frame->datas[4]));
+				break;
+			}
+		}
+	}
+	history[history_index].rx_time_us = rx_time_us;
+	history[history_index].seq = frame->msg_cnt;
+	history[history_index].valid = TRUE;
+	history_index = (history_index + 1) % TIMEBASE_HISTORY_NB;
+#endif
+}
+
+//Temps rseau [us] : horloge de la station de base, modulo 2^32 comme SYSTICK_get_time_us().
+uint32_t TIMEBASE_get_time_us(void)
+{
+	return TIMEBASE_local_to_network(SYSTICK_get_time_us());
+}
+
+int32_t TIMEBASE_get_offset_us(void)
+{
+	uint32_t local_time_us = SYSTICK_get_time_us();
+	return (int32_t)(TIMEBASE_local_to_network(local_time_us) - local_time_us);
+}
+
+int32_t TIMEBASE_get_drift_ppb(void)
+{
+	return drift_ppb;
+}
+
+bool_e TIMEBASE_is_synchronized(void)
+{
+#if USE_TIMEBASE
+	if(OBJECT_ID == OBJECT_BASE_STATION)
+		return TRUE;
+	return locked && SYSTICK_get_time_ms() - last_sample_ms < TIMEBASE_TIMEOUT_MS;
+#else
+	return OBJECT_ID == OBJECT_BASE_STATION;
+#endif
+}
+
+void TIMEBASE_get_stats(timebase_stats_t * s)
+{
+	*s = stats;
+}
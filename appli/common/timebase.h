@@ -0,0 +1,61 @@
+/*
+ * timebase.h
+ *
+ *  Created on: 17 oct. 2026
+ */
+
+#ifndef APPLI_COMMON_TIMEBASE_H_
+#define APPLI_COMMON_TIMEBASE_H_
+
+#include "../config.h"
+#include "macro_types.h"
+#include "secretary.h"
+
+/*
+ * Base de temps commune au rseau, discipline par les beacons de la station de base.
+ * 	Le temps rseau est l'horloge (systick) de la station. Chaque objet l'estime par : temps rseau = temps local + offset, l'offset
+ * 	voluant entre deux beacons selon la drive estime entre les deux quartz (en ppb).
+ * 	BEACON = [] ou [SEQ TX_TIME_US(4)] : synchronisation en deux temps (comme PTP), car l'instant d'mission n'est connu qu'aprs coup
+ * 	(attente dans la file d'mission) et une trame scelle (voir rf_secure.h) ne peut plus tre modifie une fois dpose.
+ * 	TX_TIME_US est l'instant de fin d'mission, selon l'horloge de la station, du beacon prcdent, dont SEQ est le MSG_CNT.
+ * 	L'objet garde les instants de rception des TIMEBASE_HISTORY_NB derniers beacons : ils sont tous dats dans l'IT de rception
+ * 	(fin de trame), comme la fin d'mission l'est dans l'IT radio de la station. Le temps de vol et les latences d'IT, quasi constantes,
+ * 	ne laissent qu'un biais de quelques us.
+ * 	Chaque chantillon (instant local de rception, TX_TIME_US) corrige l'offset de la moiti de l'cart mesur, et la drive d'un huitime
+ * 	de l'cart rapport au temps coul depuis l'chantillon prcdent (boucle du second ordre : la drive des quartz est rattrape sans erreur statique).
+ * 	Le premier chantillon, ou un cart de plus de TIMEBASE_STEP_THRESHOLD_US (reset de la station, beacons perdus longtemps), recale l'offset d'un coup ;
+ * 	le suivant mesure directement la drive. Sans chantillon depuis TIMEBASE_TIMEOUT_MS, l'objet n'est plus synchronis mais garde son estimation.
+ * 	Sur la station de base, le temps rseau est le temps local. Sans USE_TIMEBASE, TIMEBASE_get_time_us() est l'horloge locale.
+ */
+
+#define TIMEBASE_BEACON_DATAS_SIZE		5		//[SEQ TX_TIME_US(4)]
+#define TIMEBASE_HISTORY_NB				4		//beacons dont l'instant de rception est retenu
+#define TIMEBASE_STEP_THRESHOLD_US		2000	//[us] cart au-del duquel l'offset est recal d'un coup
+#define TIMEBASE_DRIFT_MAX_PPB			200000	//[ppb] drive maximale admise entre deux quartz (200ppm)
+#define TIMEBASE_TIMEOUT_MS				5000	//[ms]
+
+typedef struct
+{
+	uint32_t samples_nb;
+	uint32_t steps_nb;				//recalages de l'offset
+	int32_t last_error_us;			//cart mesur au dernier chantillon, avant correction
+	uint32_t max_error_us;			//plus grand cart mesur depuis le dernier recalage (hors chantillon qui mesure la drive)
+}timebase_stats_t;
+
+void TIMEBASE_init(void);
+
+//Station
+void TIMEBASE_beacon_sent(uint8_t seq, uint32_t tx_time_us);
+uint8_t TIMEBASE_get_beacon_datas(uint8_t * datas);
+
+//Objet
+void TIMEBASE_beacon_received(rf_frame_t * frame, uint32_t rx_time_us);
+
+uint32_t TIMEBASE_get_time_us(void);
+uint32_t TIMEBASE_local_to_network(uint32_t local_time_us);
+int32_t TIMEBASE_get_offset_us(void);
+int32_t TIMEBASE_get_drift_ppb(void);
+bool_e TIMEBASE_is_synchronized(void);
+void TIMEBASE_get_stats(timebase_stats_t * s);
+
+#endif /* APPLI_COMMON_TIMEBASE_H_ */
@@ -0,0 +1,116 @@
+/*
+ * timeslot.c
+ *
+ *  Created on: 17 oct. 2026
+ */
+#include "../config.h"
+#include "timeslot.h"
+#include "systick.h"
+#include "secretary.h"
+#include "rf_dialog.h"
+
+static volatile bool_e synchronized = FALSE;
+static volatile uint32_t last_beacon_time_us;		//instant de rception du dernier beacon (ct objet)
+static volatile uint32_t last_beacon_sent_us;				//chance du dernier beacon (ct station de base) : la supertrame n'est pas un nombre entier de ms
+static bool_e previous_tx_allowed = FALSE;
+static bool_e previous_beacon_expected = FALSE;
+
+static void TIMESLOT_process_ms(void);
+
+void TIMESLOT_init(void)
+{
+	synchronized = FALSE;
+	previous_tx_allowed = FALSE;
+	previous_beacon_expected = FALSE;
+	last_beacon_sent_us = SYSTICK_get_time_us();
+	if(USE_TIMESLOT)
+		Systick_add_callback_function(&TIMESLOT_process_ms);
+}
+
+//Ct station de base : mission priodique du beacon qui rythme les supertrames.
+void TIMESLOT_process_main(void)
+{
+#if USE_TIMESLOT
+	if(OBJECT_ID == OBJECT_BASE_STATION)
+	{
+		if(SYSTICK_get_time_us() - last_beacon_sent_us >= TIMESLOT_SUPERFRAME_DURATION_US)
+		{
+			last_beacon_sent_us += TIMESLOT_SUPERFRAME_DURATION_US;
+			RF_DIALOG_send_beacon();
+		}
+	}
+#endif
+}
+
+//Ct objet : appele  la rception d'un beacon, avec l'instant de rception relev sous IT.
+void TIMESLOT_beacon_received(uint32_t rx_time_us)
+{
+	last_beacon_time_us = rx_time_us;
+	synchronized = TRUE;
+}
+
+bool_e TIMESLOT_is_synchronized(void)
+{
+	return synchronized;
+}
+
+//Renvoie TRUE si l'objet (ou la station de base) a le droit de dmarrer une mission maintenant.
+//La station de base n'met de sa propre initiative qu'au dbut de la supertrame (OFFSET_TRANSMISSION_DURATION), voir SECRETARY_start_next_tx.
+bool_e TIMESLOT_tx_allowed(void)
+{
+#if USE_TIMESLOT
+	uint32_t elapsed;
+	uint32_t phase;
+	uint32_t slot_start;
+
+	if(OBJECT_ID == OBJECT_BASE_STATION)
+	{
+		phase = (SYSTICK_get_time_us() - last_beacon_sent_us) % TIMESLOT_SUPERFRAME_DURATION_US;	//beacon en retard : la phase suit l'chance
+		return (phase < OFFSET_TRANSMISSION_DURATION - TIMESLOT_GUARD_US);
+	}
+	if(!synchronized)
+		return TRUE;	//accs libre
+
+	elapsed = SYSTICK_get_time_us() - last_beacon_time_us;
+	if(elapsed > TIMESLOT_BEACON_TIMEOUT*TIMESLOT_SUPERFRAME_DURATION_US)
+	{
+		synchronized = FALSE;	//beacons perdus : on repasse en accs libre plutt que de se taire.
+		return TRUE;
+	}
+
+	phase = elapsed % TIMESLOT_SUPERFRAME_DURATION_US;	//les crneaux se rptent mme si un beacon est manqu
+	slot_start = OFFSET_TRANSMISSION_DURATION + OBJECT_ID*TIMESLOT_DURATION*1000;
+	return (phase >= slot_start && phase < slot_start + TIMESLOT_DURATION*1000 - TIMESLOT_GUARD_US);	//fentre >= 1ms : vue au moins une fois par TIMESLOT_process_ms
+#else
+	return TRUE;
+#endif
+}
+
+//Objet synchronis : TRUE  moins de TIMESLOT_BEACON_LISTEN_US de l'chance d'un beacon (les chances se rptent mme si un beacon est manqu).
+bool_e TIMESLOT_beacon_expected(void)
+{
+#if USE_TIMESLOT
+	uint32_t phase;
+
+	if(OBJECT_ID == OBJECT_BASE_STATION || !synchronized)
+		return FALSE;
+	phase = (SYSTICK_get_time_us() - last_beacon_time_us) % TIMESLOT_SUPERFRAME_DURATION_US;
+	return (phase < TIMESLOT_BEACON_LISTEN_US || phase >= TIMESLOT_SUPERFRAME_DURATION_US - TIMESLOT_BEACON_LISTEN_US);
+#else
+	return FALSE;
+#endif
+}
+
+//Appele chaque ms par le systick :  l'ouverture de notre crneau (ou du dbut de supertrame pour la station), on relance l'mission des trames en attente.
+//Un objet endormi y rveille aussi sa radio  l'approche du beacon (SECRETARY_kick_tx repasse en rception si rien n'est  mettre).
+static void TIMESLOT_process_ms(void)
+{
+	bool_e tx_allowed;
+	bool_e beacon_expected;
+	tx_allowed = TIMESLOT_tx_allowed();
+	beacon_expected = OBJECT_RADIO_SLEEPS && TIMESLOT_beacon_expected();
+	if((tx_allowed && !previous_tx_allowed) || (beacon_expected && !previous_beacon_expected))
+		SECRETARY_kick_tx();
+	previous_tx_allowed = tx_allowed;
+	previous_beacon_expected = beacon_expected;
+}
@@ -0,0 +1,50 @@
+/*
+ * timeslot.h
+ *
+ *  Created on: 17 oct. 2026
+ */
+
+#ifndef APPLI_COMMON_TIMESLOT_H_
+#define APPLI_COMMON_TIMESLOT_H_
+
+#include "../config.h"
+#include "macro_types.h"
+
+/*
+ * Accs au mdium par crneaux (TDMA).
+ * 	La station de base met un BEACON au dbut de chaque supertrame.
+ * 	Chaque objet ne dmarre ses missions que dans son crneau :
+ * 		[OFFSET_TRANSMISSION_DURATION + OBJECT_ID * TIMESLOT_DURATION ; + TIMESLOT_DURATION[ aprs le beacon.
+ * 	Le dbut de la supertrame (avant le premier crneau) est rserv  la station de base : elle n'met rien d'autre de sa propre initiative
+ * 	en dehors (hors la fin de garde TIMESLOT_GUARD_US). Seuls le beacon, les CHANNEL_SET, les ACK, les alertes fiables et les PONG partent  tout moment.
+ * 	Sans beacon depuis TIMESLOT_BEACON_TIMEOUT supertrames, l'objet repasse en accs libre.
+ * 	Un objet dont la radio dort (OBJECT_RADIO_SLEEPS, voir mailbox.h) la rveille autour de l'chance de chaque beacon pour rester synchronis.
+ */
+
+#ifndef TIMESLOT_SLOTS_NB
+	#define TIMESLOT_SLOTS_NB			OBJECTS_NB	//crneaux par supertrame (un par OBJECT_ID), modifiable  la compilation (simulateur tools/esb_sim)
+#endif
+
+#define TIMESLOT_SUPERFRAME_DURATION_US	(OFFSET_TRANSMISSION_DURATION + TIMESLOT_SLOTS_NB*TIMESLOT_DURATION*1000)
+#define TIMESLOT_GUARD_US				1000	//fin de crneau o l'on ne dmarre plus d'mission : une trame (32 octets  1Mbps) doit s'y terminer
+
+#if TIMESLOT_DURATION*1000 - TIMESLOT_GUARD_US < 1000
+	#error "la fentre d'mission doit durer au moins 1ms pour tre vue par le systick"
+#endif
+
+#define TIMESLOT_BEACON_TIMEOUT			4		//[supertrames]
+#define TIMESLOT_BEACON_LISTEN_US		2000	//[us] coute d'un objet endormi de part et d'autre de l'chance du beacon
+
+void TIMESLOT_init(void);
+
+void TIMESLOT_process_main(void);
+
+void TIMESLOT_beacon_received(uint32_t rx_time_us);
+
+bool_e TIMESLOT_tx_allowed(void);
+
+bool_e TIMESLOT_is_synchronized(void);
+
+bool_e TIMESLOT_beacon_expected(void);
+
+#endif /* APPLI_COMMON_TIMESLOT_H_ */
@@ -208,7 +208,6 @@
 		#define DC_PIN           9
 		#define BUSY_PIN         13
 //		#define EPAPER_SPI		SPI1
-		EPAPER_demo();
 
 	#endif
 
@@ -275,6 +274,22 @@
 	#define USE_SERIAL_DIALOG	1
 #endif
 
+//Firmware de capture : la radio coute tout le rseau sans jamais mettre, les trames sont crites sur l'UART (voir sniffer.h).
+#ifndef SNIFFER_MODE
+	#define SNIFFER_MODE	0
+#endif
+
+//Regroupement des messages de tlmtrie (PARAMETER_IS...) de mme destinataire dans une seule trame radio.
+#ifndef USE_RF_DIALOG_PACKING
+	#define USE_RF_DIALOG_PACKING		0
+#endif
+#define RF_DIALOG_PACKING_WINDOW		10		//[ms] dure maximale d'attente d'autres messages avant l'envoi de la trame groupe
+
+//Entte compact (adresses courtes attribues par la station de base) pour les changes objet <-> station de base.
+#ifndef USE_RF_DIALOG_COMPACT_HEADER
+	#define USE_RF_DIALOG_COMPACT_HEADER	0
+#endif
+
 //pour voir les IRQ Radio...
 #define SP_DEBUG_RADIO_IRQ_INIT()		nrf_gpio_cfg_output(12)
 #define SP_DEBUG_RADIO_IRQ_SET()		NRF_P0->OUTSET = (1 << (12))
@@ -284,9 +299,72 @@
 #define OFF_BUTTON_LONG_PRESS_DURATION	2000	//dur�e de l'appui sur le bouton OFF qui d�clenche l'extinction.
 #define AUTO_OFF_IF_NO_EVENT_DURATION	(30*60*1000)	//extinction automatique au bout de 30mn
 
-#define TIMESLOT_DURATION	1	//ms
+//Changement de canal radio selon le bruit mesur et les pertes (voir rf_channel.h).
+#ifndef USE_RF_CHANNEL_AGILITY
+	#define USE_RF_CHANNEL_AGILITY	0
+#endif
+
+//Puissance d'mission par objet et dbit du rseau selon l'affaiblissement mesur (voir rf_link.h).
+#ifndef USE_RF_LINK_ADAPTATION
+	#define USE_RF_LINK_ADAPTATION	0
+#endif
+
+//Registre des objets tenu par la station de base : dernire rception, RSSI, resets, paramtres en cache (voir registry.h).
+#ifndef USE_REGISTRY
+	#define USE_REGISTRY	0	//station de base seulement
+#endif
+
+#define FIRMWARE_VERSION	0x0100	//annonce par RECENT_RESET : [MAJEUR MINEUR]
+
+//Bote aux lettres de la station de base pour les objets dont la radio dort (voir mailbox.h).
+#ifndef USE_MAILBOX
+	#define USE_MAILBOX		0	//station de base seulement, ncessite USE_REGISTRY
+#endif
+#ifndef USE_MAILBOX_FLASH_SPILL
+	#define USE_MAILBOX_FLASH_SPILL		0	//messages en surnombre recopis en flash plutt que perdus
+#endif
+
+//Messages en attente d'un objet endormi glisss dans les acquittements ESB de ses trames (voir mailbox.h).
+#ifndef USE_RF_ACK_PAYLOAD
+	#define USE_RF_ACK_PAYLOAD		0
+#endif
+
+//Objet : 1 si sa radio ne reste  l'coute que brivement aprs chacune de ses missions (voir mailbox.h).
+#ifndef OBJECT_RADIO_SLEEPS
+	#define OBJECT_RADIO_SLEEPS		0
+#endif
+
+//Objet : 1 s'il retransmet les trames des objets hors de porte de la station (voir rf_relay.h). Rserv aux objets aliments sur secteur.
+#ifndef USE_RF_RELAY
+	#define USE_RF_RELAY			0
+#endif
+
+//Banc de mesure de charge : trafic synthtique des objets, pertes et latences mesures par la station (voir rf_bench.h).
+#ifndef USE_RF_BENCH
+	#define USE_RF_BENCH			0
+#endif
+
+//Chiffrement et authentification AES-CCM des trames radio (voir rf_secure.h). Tous les noeuds du rseau partagent la mme cl.
+#ifndef USE_RF_SECURE
+	#define USE_RF_SECURE			0
+#endif
+#ifndef RF_SECURE_KEY
+	#define RF_SECURE_KEY			{0x3C, 0x9A, 0x51, 0xE7, 0x08, 0xB4, 0x6D, 0x22, 0xF1, 0x7E, 0x93, 0x0C, 0x5B, 0xA8, 0x46, 0xD9}	// redfinir pour chaque rseau (config_perso.h)
+#endif
+
+//Accs au mdium par crneaux, rythm par les beacons de la station de base (voir timeslot.h).
+#ifndef USE_TIMESLOT
+	#define USE_TIMESLOT	0
+#endif
+
+//Base de temps commune au rseau, discipline par les beacons de la station de base (voir timebase.h).
+#ifndef USE_TIMEBASE
+	#define USE_TIMEBASE	USE_TIMESLOT
+#endif
+
+#define TIMESLOT_DURATION	2	//ms	dure du crneau de chaque objet (1ms pour dmarrer l'mission + 1ms de garde)
 
-#define OFFSET_TRANSMISSION_DURATION	13440
+#define OFFSET_TRANSMISSION_DURATION	13440	//[us] dbut de supertrame rserv  la station de base, avant le crneau du premier objet
 
 void uart_puts(char * s);
 uint32_t debug_printf(char * format, ...);
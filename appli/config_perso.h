@@ -1 +1,3 @@
-#define OBJECT_ID 	OBJECT_LCD_SLIDER
+#ifndef OBJECT_ID	//peut tre impos  la compilation (-DOBJECT_ID=n), voir tools/esb_sim
+	#define OBJECT_ID 	OBJECT_LCD_SLIDER
+#endif
@@ -21,6 +21,8 @@
 #include "common/buttons.h"
 #include "common/gpio.h"
 #include "common/parameters.h"
+#include "common/rf_dialog.h"
+#include "common/rf_ping.h"
 
 //Tout les includes des header des objets.
 #include "objects/object_tracker_gps.h"
@@ -38,6 +40,7 @@
 void button_network_process_short_press(void);
 void button_network_process_long_press(void);
 void button_network_process_5press(void);
+static void network_ping_process_main(void);
 
 #undef NRF_LOG_ENABLED
 #define NRF_LOG_ENABLED 1
@@ -109,6 +112,8 @@ int main(void)
 
     	BUTTONS_process_main();
 
+    	network_ping_process_main();
+
     	//Orientation du main vers chaque code de chaque objets
     		#if OBJECT_ID == OBJECT_BASE_STATION
 
@@ -257,10 +262,46 @@ char * object_id_to_string(uint8_t id)
 
 
 
+static callback_fun_t previous_callback_pong = NULL;	//callback PONG en place avant la srie lance par le bouton rseau
+static bool_e network_ping_running = FALSE;
+
+//Fin de la srie lance par le bouton rseau : la led s'teint et le callback PONG prcdent est rtabli.
+static void network_ping_end(void)
+{
+	LED_set(LED_ID_NETWORK, LED_MODE_OFF);
+	RF_DIALOG_set_callback_pong(previous_callback_pong);
+	network_ping_running = FALSE;
+}
+
+static void network_pong_received(void)
+{
+	network_ping_end();
+	if(previous_callback_pong != NULL)
+		previous_callback_pong();	//ce PONG le concerne peut-tre aussi
+}
+
+//Srie termine sans aucun PONG.
+static void network_ping_process_main(void)
+{
+	if(network_ping_running && !RF_PING_is_running())
+		network_ping_end();
+}
+
+//Objet : srie de PING vers la station (rsultat sur debug_printf, voir rf_ping.h). La led rseau reste allume jusqu'au premier PONG, ou jusqu' la fin de la srie.
 void button_network_process_short_press(void)
 {
-	LED_toggle(LED_ID_NETWORK);
-	//TODO envoi d'un ping... (avec �ventuellement extinction de la led � la r�ception du Pong ?)
+	if(OBJECT_ID == OBJECT_BASE_STATION)
+	{
+		LED_toggle(LED_ID_NETWORK);
+		return;
+	}
+	if(RF_PING_start(RF_DIALOG_get_my_base_station_id(), RF_PING_DEFAULT_COUNT, RF_PING_DEFAULT_PERIOD))
+	{
+		LED_set(LED_ID_NETWORK, LED_MODE_ON);
+		previous_callback_pong = RF_DIALOG_get_callback_pong();
+		RF_DIALOG_set_callback_pong(&network_pong_received);
+		network_ping_running = TRUE;
+	}
 }
 
 void button_network_process_long_press(void)
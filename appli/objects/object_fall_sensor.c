@@ -10,6 +10,7 @@
 #include "appli/common/systick.h"
 #include "appli/common/buttons.h"
 #include "appli/common/leds.h"
+#include "appli/common/rf_dialog.h"
 
 #if OBJECT_ID == OBJECT_FALL_SENSOR
 static MPU6050_t mpu_datas;
@@ -79,6 +80,7 @@ void OBJECT_FALL_SENSOR_state_machine(void){
 		case ALERT:{
 			debug_printf("ALERT\n");
 			LED_set(LED_ID_BATTERY, LED_MODE_ON);
+			RF_DIALOG_send_event(EVENT_FALL_DETECTED, 0, NULL, NULL);	//chemin prioritaire des alertes
 			//BUTTONS_alerte();
 			SYSTICK_delay_ms(3000);
 			state = GET_DATA;
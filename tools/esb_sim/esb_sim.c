@@ -0,0 +1,850 @@
+/*
+ * esb_sim.c
+ *
+ *  Created on: 17 oct. 2026
+ *
+ * Simulateur (ct PC, Linux) d'un rseau ESB : la station de base et n objets excutent le code de appli/common
+ * (secretary.c, rf_dialog.c, timeslot.c...) sur un mdium radio simul, en temps virtuel.
+ *
+ * Compilation :	make [OBJECTS=50]		(une bibliothque par OBJECT_ID dans nodes/, voir Makefile)
+ * Utilisation :	esb_sim [-n objets] [-t dure_s] [-p priode_ms] [-D priode_ms] [-l perte_%] [-L latence_us] [-C]
+ * 						[-a ct_m] [-s graine] [-k pas_us] [-r taux_min_%] [-T priode_ms[:taille]] [-B priode_ms[:nombre]]
+ * 						[-P priode_ms] [-K drive_ppm] [-N dossier] [-v]
+ *
+ * 	-n	nombre d'objets, OBJECT_ID 1  n (dfaut 10), en plus de la station de base (OBJECT_ID 0)
+ * 	-t	dure simule [s] (dfaut 60)
+ * 	-p	priode des messages de mesure de chaque objet vers la station [ms] (dfaut 1000, 0 : aucun), gigue de +/-10%
+ * 	-D	priode des messages du serveur vers les objets, chacun  son tour [ms] (dfaut 0 : aucun)
+ * 	-l	taux de perte alatoire de chaque trame sur chaque lien [%] (dfaut 0)
+ * 	-L	latence ajoute  chaque fin de trame (traitement de l'IT radio) [us] (dfaut 0)
+ * 	-C	pas de collisions (par dfaut, deux trames qui se recouvrent sur un mme canal sont perdues pour tous)
+ * 	-a	objets rpartis au hasard sur un carr de ce ct [m], station au centre : le RSSI dpend de la distance,
+ * 		la porte est limite (dfaut 0 : tous les noeuds s'entendent, avec un RSSI de ESB_SIM_DEFAULT_RSSI)
+ * 	-s	graine du gnrateur alatoire (dfaut 1) : deux excutions de mmes paramtres donnent le mme rsultat
+ * 	-k	pas de la tache de fond des noeuds [us] (dfaut 100)
+ * 	-r	code de retour 1 si moins de ce pourcentage des messages de mesure est arriv (intgration continue)
+ * 	-T	banc de charge (appli/common/rf_bench.h) : tlmtrie de chaque objet, priode [ms] et taille des datas [octets] (dfaut 12)
+ * 	-B	banc de charge : rafales de chaque objet, priode [ms] et nombre de messages (dfaut 4)
+ * 	-A	banc de charge : priode des alertes (EVENT_OCCURED, chemin prioritaire) de chaque objet [ms]
+ * 	-P	banc de charge : priode des interrogations (PARAMETER_ASK) de la station, chaque objet  son tour [ms]
+ * 	-K	horloge de chaque objet dcale au hasard (jusqu' 1000 s) et drivant d'au plus ce nombre de ppm (dfaut 0 : horloge commune)
+ * 	-N	dossier des bibliothques des noeuds (dfaut nodes)
+ * 	-v	journal dtaill des noeuds (debug_printf)
+ *
+ * Mdium : chaque trame occupe le canal pendant sa dure  son dbit (ESB_SIM_RAMP_US de mise en route de la radio
+ * en plus). Une trame n'est reue que par les noeuds  l'coute de son canal  son dbut, qui n'ont pas mis pendant
+ * sa dure. Un acquittement demand est mis par le noeud qui l'a reue ; s'ils sont plusieurs, les acquittements
+ * se perdent. Les retransmissions ESB sont faites par le pilote simul (sim_node.c) avec les paramtres du firmware.
+ *
+ * Chaque message de mesure est un EVENT_OCCURED de datas [ESB_SIM_PROBE_MARK SEQ(4) TIME_US(4)] : le simulateur le
+ * retrouve dans le flux UART de son destinataire, et en dduit taux de livraison, dbit et latence de bout en bout.
+ * Le banc de charge dmarre lui aussi au bout d'une seconde ; ses rsultats par classe de message sont ceux que mesure
+ * la station de base (RF_BENCH_get_report). Le code de retour de -r tient compte de chaque classe active.
+ * Base de temps commune (appli/common/timebase.h) :  partir d'une seconde, toutes les ESB_SIM_TIMEBASE_PERIOD_US, le temps
+ * rseau estim par chaque objet est compar  celui de la station ; l'cart et la part des relevs synchroniss sont rsums.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include "esb_sim.h"
+
+//doit rester identique  appli/common/rf_dialog.h et appli/common/serial_dialog.h
+#define BASE_STATION_ID			0xFFFFFFFF
+#define EVENT_OCCURED			0x30
+#define SOH						0xBA
+#define EOT						0xDA
+#define BYTE_POS_DATAS			11
+
+#define ESB_SIM_MAX_NODES		255
+#define ESB_SIM_RAMP_US			130		//mise en route de la radio avant chaque mission (trame ou acquittement)
+#define ESB_SIM_ACK_TIMEOUT_US	(ESB_SIM_RAMP_US + 100)	//attente d'un acquittement qui ne vient pas
+#define ESB_SIM_DEFAULT_RSSI	50		//[-dBm] sans topologie (-a 0)
+#define ESB_SIM_SENSITIVITY		92		//[-dBm] au-del, la trame n'est pas reue
+#define ESB_SIM_NOISE			100		//[-dBm] niveau mesur hors trame
+#define ESB_SIM_PROBE_MARK		0x5A
+#define ESB_SIM_PROBE_SIZE		9
+#define ESB_SIM_SERVER_ID		0x5E5E5E5E	//metteur des messages du serveur
+#define ESB_SIM_TIMEBASE_PERIOD_US	100000	//relev des bases de temps des noeuds
+
+typedef enum
+{
+	EVENT_TX_START,			//dbut d'une mission (trame ou acquittement)
+	EVENT_TX_END,			//fin d'une mission (+ latence) : rceptions
+	EVENT_ACK_TIMEOUT,		//aucun acquittement ne viendra
+	EVENT_PROBE,			//message de mesure d'un objet vers la station
+	EVENT_DOWNLINK,			//message de mesure du serveur vers un objet
+	EVENT_BENCH_START,		//configuration du banc de charge de tous les noeuds
+	EVENT_TIMEBASE			//relev des bases de temps
+}event_type_e;
+
+typedef struct
+{
+	uint64_t time;
+	uint64_t order;			// instant gal, ordre de cration : le rsultat ne dpend que de la graine
+	event_type_e type;
+	uint32_t node;
+	int32_t tx;
+}event_t;
+
+typedef struct
+{
+	bool used;
+	uint32_t emitter;
+	int32_t acked_node;		//acquittement : noeud qui l'attend ; -1 pour une trame de donnes
+	esb_sim_air_frame_t frame;
+	uint64_t start;
+	uint64_t end;
+	bool collided;
+	uint8_t * listeners;	//noeuds  l'coute du canal au dbut de la trame
+}transmission_t;
+
+typedef struct
+{
+	void * lib;
+	esb_sim_node_t const * api;
+	double x;
+	double y;
+	uint64_t tx_start;		//dernire mission : aucune rception possible pendant
+	uint64_t tx_end;
+	int32_t drift_ppb;		//drive de l'horloge locale par rapport au temps simul (-K)
+	uint8_t uart[BYTE_POS_DATAS + 32];
+	uint8_t uart_size;
+	uint8_t uart_index;
+	enum {UART_WAIT_SOH, UART_SIZE, UART_DATAS, UART_WAIT_EOT} uart_state;
+}node_t;
+
+typedef struct
+{
+	uint64_t time;
+	uint32_t source;
+	uint32_t destination;
+	bool received;
+	uint32_t latency_us;
+}probe_t;
+
+static node_t nodes[ESB_SIM_MAX_NODES + 1];
+static uint32_t nodes_nb;
+static uint64_t now_us;
+
+static event_t * events;
+static uint32_t events_nb;
+static uint32_t events_size;
+static uint64_t events_order;
+
+static transmission_t * transmissions;
+static uint32_t transmissions_size;
+
+static probe_t * probes;
+static uint32_t probes_nb;
+static uint32_t probes_size;
+
+static struct
+{
+	uint32_t objects_nb;
+	double duration_s;
+	uint32_t period_ms;
+	uint32_t downlink_period_ms;
+	double loss;
+	uint32_t latency_us;
+	bool collisions;
+	double area_m;
+	uint32_t seed;
+	uint32_t step_us;
+	double min_ratio;
+	char const * nodes_dir;
+	bool verbose;
+	esb_sim_bench_config_t bench;
+	double clock_ppm;
+}config = {10, 60, 1000, 0, 0, 0, true, 0, 1, 100, -1, "nodes", false, {0, 12, 0, 4, 0}, 0};
+
+static struct
+{
+	uint64_t frames_nb;
+	uint64_t acks_nb;
+	uint64_t airtime_us;
+	uint64_t lost_collision_nb;
+	uint64_t lost_half_duplex_nb;
+	uint64_t lost_random_nb;
+	uint64_t ack_lost_nb;
+	uint64_t ack_conflict_nb;
+	uint64_t duplicate_probes_nb;
+}stats;
+
+static struct
+{
+	uint64_t samples_nb;			//relevs des objets
+	uint64_t synchronized_nb;
+	uint64_t error_sum;				//[us] cart au temps de la station, objets synchroniss
+	uint32_t error_max;				//[us]
+}timebase_stats;
+
+static uint64_t random_state;
+static uint8_t downlink_cnt;
+static uint32_t downlink_next;
+
+static uint64_t SIM_get_time_us(void);
+static void SIM_radio_tx(uint32_t node, esb_sim_air_frame_t const * frame, uint32_t delay_us);
+static void SIM_uart_putc(uint32_t node, uint8_t c);
+static void SIM_log(uint32_t node, char const * s);
+
+static esb_sim_host_t host = {SIM_get_time_us, SIM_radio_tx, SIM_uart_putc, SIM_log, ESB_SIM_NOISE, false};
+
+//xorshift64* : reproductible d'une machine  l'autre
+static double SIM_random(void)
+{
+	random_state ^= random_state >> 12;
+	random_state ^= random_state << 25;
+	random_state ^= random_state >> 27;
+	return (double)((random_state * 0x2545F4914F6CDD1DULL) >> 11) / (double)(1ULL << 53);
+}
+
+static void * SIM_alloc(void * p, size_t size)
+{
+	p = realloc(p, size);
+	if(p == NULL)
+	{
+		fprintf(stderr, "esb_sim: out of memory\n");
+		exit(2);
+	}
+	return p;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Echancier (tas binaire sur (time, order))
+
+static bool SIM_event_before(event_t const * a, event_t const * b)
+{
+	return (a->time < b->time) || (a->time == b->time && a->order < b->order);
+}
+
+static void SIM_event_add(uint64_t time, event_type_e type, uint32_t node, int32_t tx)
+{
+	uint32_t i;
+	event_t e = {time, events_order++, type, node, tx};
+
+	if(events_nb == events_size)
+	{
+		events_size = events_size ? 2*events_size : 256;
+		events = SIM_alloc(events, events_size * sizeof(event_t));
+	}
+	for(i = events_nb++; i > 0 && SIM_event_before(&e, &events[(i-1)/2]); i = (i-1)/2)
+		events[i] = events[(i-1)/2];
+	events[i] = e;
+}
+
+static event_t SIM_event_pop(void)
+{
+	event_t top = events[0];
+	event_t last = events[--events_nb];
+	uint32_t i = 0;
+	uint32_t child;
+
+	while((child = 2*i + 1) < events_nb)
+	{
+		if(child + 1 < events_nb && SIM_event_before(&events[child + 1], &events[child]))
+			child++;
+		if(!SIM_event_before(&events[child], &last))
+			break;
+		events[i] = events[child];
+		i = child;
+	}
+	events[i] = last;
+	return top;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Mdium radio
+
+static uint32_t SIM_airtime_us(uint8_t bitrate, uint8_t length)
+{
+	//prambule, adresse (5 octets), champ de contrle (9 bits), payload, CRC (2 octets)
+	switch(bitrate)
+	{
+		case 0:	/* NRF_ESB_BITRATE_2MBPS */
+		case 4:	/* NRF_ESB_BITRATE_2MBPS_BLE */
+			return (16 + 40 + 9 + 8*length + 16 + 1) / 2;
+		case 2:	/* NRF_ESB_BITRATE_250KBPS */
+			return (8 + 40 + 9 + 8*length + 16) * 4;
+		default:
+			return 8 + 40 + 9 + 8*length + 16;
+	}
+}
+
+//Niveau [-dBm] auquel receiver entend emitter
+static uint8_t SIM_rssi(uint32_t emitter, uint32_t receiver, int8_t tx_power)
+{
+	double distance;
+	double rssi = ESB_SIM_DEFAULT_RSSI;
+
+	if(config.area_m > 0)
+	{
+		distance = hypot(nodes[emitter].x - nodes[receiver].x, nodes[emitter].y - nodes[receiver].y);
+		rssi = 40 + 30*log10((distance < 1) ? 1 : distance);	//propagation en intrieur
+	}
+	rssi -= tx_power;
+	return (rssi < 20) ? 20 : (rssi > 127) ? 127 : (uint8_t)rssi;
+}
+
+static int32_t SIM_transmission_new(uint32_t emitter, esb_sim_air_frame_t const * frame, int32_t acked_node)
+{
+	uint32_t i;
+
+	for(i = 0; i < transmissions_size && transmissions[i].used; i++);
+	if(i == transmissions_size)
+	{
+		transmissions_size = transmissions_size ? 2*transmissions_size : 64;
+		transmissions = SIM_alloc(transmissions, transmissions_size * sizeof(transmission_t));
+		for(uint32_t j = i; j < transmissions_size; j++)
+		{
+			transmissions[j].used = false;
+			transmissions[j].listeners = SIM_alloc(NULL, ESB_SIM_MAX_NODES + 1);
+		}
+	}
+	transmissions[i].used = true;
+	transmissions[i].emitter = emitter;
+	transmissions[i].acked_node = acked_node;
+	transmissions[i].frame = *frame;
+	transmissions[i].collided = false;
+	return i;
+}
+
+static void SIM_radio_tx(uint32_t node, esb_sim_air_frame_t const * frame, uint32_t delay_us)
+{
+	SIM_event_add(now_us + delay_us, EVENT_TX_START, node, SIM_transmission_new(node, frame, -1));
+}
+
+static void SIM_tx_start(int32_t index)
+{
+	transmission_t * tx = &transmissions[index];
+	transmission_t * other;
+	node_t * emitter = &nodes[tx->emitter];
+
+	tx->start = now_us + ESB_SIM_RAMP_US;
+	tx->end = tx->start + SIM_airtime_us(tx->frame.bitrate, tx->frame.length);
+	emitter->tx_start = now_us;
+	emitter->tx_end = tx->end;
+	stats.airtime_us += tx->end - tx->start;
+
+	if(config.collisions)
+	{
+		for(uint32_t i = 0; i < transmissions_size; i++)
+		{
+			other = &transmissions[i];
+			if(i != (uint32_t)index && other->used && other->end > tx->start && other->start < tx->end && other->frame.channel == tx->frame.channel)
+				other->collided = tx->collided = true;
+		}
+	}
+	for(uint32_t j = 0; j < nodes_nb; j++)
+	{
+		tx->listeners[j] = (j != tx->emitter && (tx->acked_node < 0 || (uint32_t)tx->acked_node == j)
+				&& SIM_rssi(tx->emitter, j, tx->frame.tx_power) <= ESB_SIM_SENSITIVITY
+				&& nodes[j].tx_end <= now_us
+				&& (tx->acked_node >= 0 || nodes[j].api->radio_listening(tx->frame.channel, tx->frame.bitrate)));
+	}
+	SIM_event_add(tx->end + config.latency_us, EVENT_TX_END, tx->emitter, index);
+}
+
+//receiver a-t-il reu tx ? (compte les pertes)
+static bool SIM_received(transmission_t * tx, uint32_t receiver)
+{
+	if(!tx->listeners[receiver])
+		return false;
+	if(tx->collided)
+	{
+		stats.lost_collision_nb++;
+		return false;
+	}
+	if(nodes[receiver].tx_start < tx->end && nodes[receiver].tx_end > tx->start)
+	{
+		stats.lost_half_duplex_nb++;
+		return false;
+	}
+	if(SIM_random() < config.loss)
+	{
+		stats.lost_random_nb++;
+		return false;
+	}
+	return true;
+}
+
+static void SIM_tx_end(int32_t index)
+{
+	transmission_t * tx = &transmissions[index];
+	esb_sim_air_frame_t ack;
+	esb_sim_air_frame_t ack_to_send;
+	uint32_t ackers_nb = 0;
+	uint32_t acker = 0;
+	uint32_t emitter = tx->emitter;
+	int32_t ack_index;
+
+	tx->used = false;
+	if(tx->acked_node >= 0)
+	{
+		//fin d'un acquittement
+		stats.acks_nb++;
+		if(SIM_received(tx, tx->acked_node))
+			nodes[tx->acked_node].api->radio_tx_done(true, &tx->frame, SIM_rssi(emitter, tx->acked_node, tx->frame.tx_power));
+		else
+		{
+			stats.ack_lost_nb++;
+			nodes[tx->acked_node].api->radio_tx_done(false, NULL, 0);
+		}
+		return;
+	}
+
+	stats.frames_nb++;
+	for(uint32_t j = 0; j < nodes_nb; j++)
+	{
+		if(SIM_received(tx, j) && nodes[j].api->radio_rx(&tx->frame, SIM_rssi(emitter, j, tx->frame.tx_power), &ack) && !tx->frame.noack)
+		{
+			ackers_nb++;
+			acker = j;
+			ack_to_send = ack;
+		}
+	}
+
+	if(tx->frame.noack)
+		nodes[emitter].api->radio_tx_done(true, NULL, 0);
+	else if(ackers_nb == 1)
+	{
+		ack_index = SIM_transmission_new(acker, &ack_to_send, emitter);
+		SIM_event_add(now_us, EVENT_TX_START, acker, ack_index);
+	}
+	else
+	{
+		if(ackers_nb > 1)
+			stats.ack_conflict_nb++;	//plusieurs acquittements simultans : aucun n'est reu
+		SIM_event_add(now_us + ESB_SIM_ACK_TIMEOUT_US, EVENT_ACK_TIMEOUT, emitter, -1);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Trafic de mesure
+
+static void SIM_probe_datas(uint8_t * datas, uint32_t seq)
+{
+	datas[0] = ESB_SIM_PROBE_MARK;
+	for(uint8_t i = 0; i < 4; i++)
+	{
+		datas[1+i] = (seq >> (24-8*i)) & 0xFF;
+		datas[5+i] = ((uint32_t)now_us >> (24-8*i)) & 0xFF;
+	}
+}
+
+static uint32_t SIM_probe_new(uint32_t source, uint32_t destination)
+{
+	if(probes_nb == probes_size)
+	{
+		probes_size = probes_size ? 2*probes_size : 1024;
+		probes = SIM_alloc(probes, probes_size * sizeof(probe_t));
+	}
+	probes[probes_nb] = (probe_t){now_us, source, destination, false, 0};
+	return probes_nb++;
+}
+
+static uint64_t SIM_next_period(uint32_t period_ms)
+{
+	return (uint64_t)(period_ms * 1000.0 * (0.9 + 0.2*SIM_random()));
+}
+
+static void SIM_send_probe(uint32_t node)
+{
+	uint8_t datas[ESB_SIM_PROBE_SIZE];
+
+	SIM_probe_datas(datas, SIM_probe_new(node, 0));
+	nodes[node].api->send_probe(ESB_SIM_PROBE_SIZE, datas);
+	SIM_event_add(now_us + SIM_next_period(config.period_ms), EVENT_PROBE, node, -1);
+}
+
+//Message du serveur, donn  la station de base comme s'il arrivait sur son UART
+static void SIM_send_downlink(void)
+{
+	uint8_t msg[BYTE_POS_DATAS + ESB_SIM_PROBE_SIZE];
+	uint32_t object_id;
+
+	downlink_next = (downlink_next % config.objects_nb) + 1;
+	object_id = nodes[downlink_next].api->object_id;
+	for(uint8_t i = 0; i < 4; i++)
+	{
+		msg[i] = (object_id >> (24-8*i)) & 0xFF;
+		msg[4+i] = (ESB_SIM_SERVER_ID >> (24-8*i)) & 0xFF;
+	}
+	msg[8] = downlink_cnt++;
+	msg[9] = EVENT_OCCURED;
+	msg[10] = ESB_SIM_PROBE_SIZE;
+	SIM_probe_datas(&msg[BYTE_POS_DATAS], SIM_probe_new(0, downlink_next));
+	nodes[0].api->uart_rx(sizeof(msg), msg);
+	SIM_event_add(now_us + SIM_next_period(config.downlink_period_ms), EVENT_DOWNLINK, 0, -1);
+}
+
+//Message complet sur l'UART d'un noeud : [RECIPIENT(4) EMITTER(4) MSG_CNT MSG_ID DATASIZE DATAS]
+static void SIM_uart_msg(uint32_t node, uint8_t * msg, uint8_t size)
+{
+	uint32_t seq;
+	probe_t * probe;
+
+	if(size < BYTE_POS_DATAS + ESB_SIM_PROBE_SIZE || msg[9] != EVENT_OCCURED || msg[BYTE_POS_DATAS] != ESB_SIM_PROBE_MARK)
+		return;
+	seq = ((uint32_t)msg[BYTE_POS_DATAS+1] << 24) | ((uint32_t)msg[BYTE_POS_DATAS+2] << 16) | ((uint32_t)msg[BYTE_POS_DATAS+3] << 8) | msg[BYTE_POS_DATAS+4];
+	if(seq >= probes_nb || probes[seq].destination != node)
+		return;
+	probe = &probes[seq];
+	if(probe->received)
+	{
+		stats.duplicate_probes_nb++;
+		return;
+	}
+	probe->received = true;
+	probe->latency_us = now_us - probe->time;
+}
+
+static void SIM_uart_putc(uint32_t node, uint8_t c)
+{
+	node_t * n = &nodes[node];
+
+	switch(n->uart_state)
+	{
+		case UART_WAIT_SOH:
+			if(c == SOH)
+				n->uart_state = UART_SIZE;
+			break;
+		case UART_SIZE:
+			n->uart_size = c;
+			n->uart_index = 0;
+			n->uart_state = (c > 0 && c <= sizeof(n->uart)) ? UART_DATAS : UART_WAIT_SOH;
+			break;
+		case UART_DATAS:
+			n->uart[n->uart_index++] = c;
+			if(n->uart_index == n->uart_size)
+				n->uart_state = UART_WAIT_EOT;
+			break;
+		case UART_WAIT_EOT:
+			if(c == EOT)
+				SIM_uart_msg(node, n->uart, n->uart_size);
+			n->uart_state = UART_WAIT_SOH;
+			break;
+	}
+}
+
+static uint64_t SIM_get_time_us(void)
+{
+	return now_us;
+}
+
+static void SIM_log(uint32_t node, char const * s)
+{
+	printf("%10.6f [%3u] %s%s", now_us / 1e6, nodes[node].api ? nodes[node].api->object_id : node, s, (s[0] && s[strlen(s)-1] == '\n') ? "" : "\n");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static int SIM_compare_u32(void const * a, void const * b)
+{
+	uint32_t x = *(uint32_t const *)a;
+	uint32_t y = *(uint32_t const *)b;
+	return (x > y) - (x < y);
+}
+
+//Rsum d'un sens de trafic (uplink : vers la station). Renvoie le taux de livraison [%].
+static double SIM_report(char const * name, bool uplink)
+{
+	uint32_t * latencies = SIM_alloc(NULL, (probes_nb + 1) * sizeof(uint32_t));
+	uint32_t sent = 0;
+	uint32_t received = 0;
+	uint64_t sum = 0;
+	double ratio;
+
+	for(uint32_t i = 0; i < probes_nb; i++)
+	{
+		if((probes[i].destination == 0) != uplink)
+			continue;
+		if(now_us - probes[i].time < 1000000)
+			continue;	//moins d'une seconde avant la fin : ne compte pas
+		sent++;
+		if(probes[i].received)
+		{
+			latencies[received++] = probes[i].latency_us;
+			sum += probes[i].latency_us;
+		}
+	}
+	ratio = sent ? 100.0 * received / sent : 100.0;
+	if(sent)
+	{
+		printf("%-9s: %u sent, %u received (%.2f %%), %.1f msg/s", name, sent, received, ratio, received / (now_us / 1e6));
+		if(received)
+		{
+			qsort(latencies, received, sizeof(uint32_t), SIM_compare_u32);
+			printf(", latency [ms] min %.2f avg %.2f p50 %.2f p95 %.2f max %.2f", latencies[0] / 1e3, sum / 1e3 / received,
+					latencies[received/2] / 1e3, latencies[(uint32_t)(received*0.95)] / 1e3, latencies[received-1] / 1e3);
+		}
+		printf("\n");
+	}
+	free(latencies);
+	return ratio;
+}
+
+static bool SIM_load_node(uint32_t node, uint32_t object_id)
+{
+	char path[512];
+	esb_sim_node_entry_t entry;
+
+	snprintf(path, sizeof(path), "%s/node_%u.so", config.nodes_dir, object_id);
+	if(strchr(path, '/') == NULL || path[0] != '/')
+	{
+		//dlopen ne cherche dans le dossier courant que si le chemin contient un '/'
+		char relative[520];
+		snprintf(relative, sizeof(relative), "./%s", path);
+		strcpy(path, relative);
+	}
+	nodes[node].lib = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+	if(nodes[node].lib == NULL)
+	{
+		fprintf(stderr, "esb_sim: %s\n", dlerror());
+		return false;
+	}
+	entry = (esb_sim_node_entry_t)dlsym(nodes[node].lib, ESB_SIM_NODE_ENTRY);
+	if(entry == NULL || (nodes[node].api = entry()) == NULL || nodes[node].api->object_id != object_id)
+	{
+		fprintf(stderr, "esb_sim: %s: not a node library for OBJECT_ID %u\n", path, object_id);
+		return false;
+	}
+	return true;
+}
+
+static void SIM_bench_start(void)
+{
+	for(uint32_t i = 0; i < nodes_nb; i++)
+		nodes[i].api->bench_configure(&config.bench);
+}
+
+//Temps rseau de chaque objet compar  celui de la station, au mme instant simul.
+static void SIM_timebase_sample(void)
+{
+	esb_sim_timebase_report_t base;
+	esb_sim_timebase_report_t report;
+	uint32_t error;
+
+	if(!nodes[0].api->timebase_report(&base))
+		return;
+	for(uint32_t i = 1; i < nodes_nb; i++)
+	{
+		nodes[i].api->timebase_report(&report);
+		timebase_stats.samples_nb++;
+		if(!report.synchronized)
+			continue;
+		timebase_stats.synchronized_nb++;
+		error = (uint32_t)abs((int32_t)(report.time_us - base.time_us));
+		timebase_stats.error_sum += error;
+		if(error > timebase_stats.error_max)
+			timebase_stats.error_max = error;
+	}
+	SIM_event_add(now_us + ESB_SIM_TIMEBASE_PERIOD_US, EVENT_TIMEBASE, 0, -1);
+}
+
+//Rsum des relevs, et drive estime par chaque objet compare  la drive relle de son horloge (rien si la base de temps n'est pas compile).
+static void SIM_timebase_report(void)
+{
+	esb_sim_timebase_report_t report;
+	uint64_t steps_nb = 0;
+	double drift_error;
+	double drift_error_max = 0;
+
+	if(timebase_stats.samples_nb == 0)
+		return;
+	for(uint32_t i = 1; i < nodes_nb; i++)
+	{
+		nodes[i].api->timebase_report(&report);
+		steps_nb += report.steps_nb;
+		if(report.samples_nb < 2)
+			continue;
+		drift_error = fabs(report.drift_ppb + nodes[i].drift_ppb / (1 + nodes[i].drift_ppb / 1e9));	//temps rseau / temps local = 1 / (1 + drive)
+		if(drift_error > drift_error_max)
+			drift_error_max = drift_error;
+	}
+	printf("timebase : clocks +/-%.0f ppm, %.2f %% synchronized samples, error [us] avg %.1f max %u ; drift estimate error max %.3f ppm, %llu steps\n",
+			config.clock_ppm, 100.0 * timebase_stats.synchronized_nb / timebase_stats.samples_nb,
+			timebase_stats.synchronized_nb ? (double)timebase_stats.error_sum / timebase_stats.synchronized_nb : 0.0,
+			timebase_stats.error_max, drift_error_max / 1e3, (unsigned long long)steps_nb);
+}
+
+//Rsultats du banc de charge mesurs par la station. Renvoie le plus faible taux de livraison des classes actives [%].
+static double SIM_bench_report(uint64_t start_us)
+{
+	static char const * names[] = ESB_SIM_BENCH_CLASSES;
+	esb_sim_bench_report_t report;
+	double duration_s = (now_us - start_us) / 1e6;
+	double ratio;
+	double worst = 100;
+
+	for(uint8_t c = 0; nodes[0].api->bench_report(c, &report); c++)
+	{
+		if(report.sent_nb == 0)
+			continue;
+		ratio = 100.0 * report.received_nb / report.sent_nb;
+		if(ratio < worst)
+			worst = ratio;
+		printf("bench %-9s: %u sent, %u received (%.2f %%), %u lost, %.1f msg/s, %.2f kB/s", names[c], report.sent_nb, report.received_nb,
+				ratio, report.lost_nb, report.received_nb / duration_s, report.bytes_nb / duration_s / 1e3);
+		if(report.latency_nb)
+			printf(", latency [ms] avg %.2f p50 %.2f p99 %.2f max %.2f", report.latency_avg / 1e3, report.latency_p50 / 1e3,
+					report.latency_p99 / 1e3, report.latency_max / 1e3);
+		printf("\n");
+	}
+	return worst;
+}
+
+//Cot de la protection des trames, tous noeuds confondus (rien si elle n'est pas compile).
+static void SIM_secure_report(void)
+{
+	esb_sim_secure_report_t report;
+	uint64_t sealed_nb = 0, opened_nb = 0, unsealed_nb = 0, replay_nb = 0, unknown_nb = 0, mic_failed_nb = 0, ecb_blocks_nb = 0;
+
+	for(uint32_t i = 0; i < nodes_nb; i++)
+	{
+		if(!nodes[i].api->secure_report(&report))
+			return;
+		sealed_nb += report.sealed_nb;
+		opened_nb += report.opened_nb;
+		unsealed_nb += report.unsealed_nb;
+		replay_nb += report.replay_nb;
+		unknown_nb += report.unknown_nb;
+		mic_failed_nb += report.mic_failed_nb;
+		ecb_blocks_nb += report.ecb_blocks_nb;
+	}
+	printf("secure   : %llu frames sealed, %llu opened, %.1f AES blocks per frame ; rejected: unsealed %llu, replay %llu, unknown %llu, mic %llu\n",
+			(unsigned long long)sealed_nb, (unsigned long long)opened_nb,
+			(double)ecb_blocks_nb / ((sealed_nb + opened_nb + mic_failed_nb) ? (sealed_nb + opened_nb + mic_failed_nb) : 1),
+			(unsigned long long)unsealed_nb, (unsigned long long)replay_nb, (unsigned long long)unknown_nb, (unsigned long long)mic_failed_nb);
+}
+
+//"a" ou "a:b"
+static void SIM_parse_pair(char const * arg, uint32_t * a, uint8_t * b)
+{
+	char const * colon = strchr(arg, ':');
+
+	*a = atoi(arg);
+	if(colon != NULL)
+		*b = atoi(colon + 1);
+}
+
+static void SIM_usage(void)
+{
+	fprintf(stderr, "usage: esb_sim [-n objects] [-t duration_s] [-p period_ms] [-D downlink_period_ms] [-l loss_%%] [-L latency_us] [-C]\n"
+					"               [-a area_m] [-s seed] [-k step_us] [-r min_delivery_%%] [-T period_ms[:size]] [-B period_ms[:length]]\n"
+					"               [-A alert_period_ms] [-P poll_period_ms] [-K clock_ppm] [-N nodes_dir] [-v]\n");
+	exit(2);
+}
+
+int main(int argc, char ** argv)
+{
+	int opt;
+	uint64_t end_us;
+	uint64_t next_ms = 1000;
+	double ratio;
+	double bench_ratio = 100;
+	bool bench = false;
+	event_t e;
+
+	while((opt = getopt(argc, argv, "n:t:p:D:l:L:Ca:s:k:r:T:B:A:P:K:N:v")) != -1)
+	{
+		switch(opt)
+		{
+			case 'n':	config.objects_nb = atoi(optarg);				break;
+			case 't':	config.duration_s = atof(optarg);				break;
+			case 'p':	config.period_ms = atoi(optarg);				break;
+			case 'D':	config.downlink_period_ms = atoi(optarg);		break;
+			case 'l':	config.loss = atof(optarg) / 100;				break;
+			case 'L':	config.latency_us = atoi(optarg);				break;
+			case 'C':	config.collisions = false;						break;
+			case 'a':	config.area_m = atof(optarg);					break;
+			case 's':	config.seed = atoi(optarg);						break;
+			case 'k':	config.step_us = atoi(optarg);					break;
+			case 'r':	config.min_ratio = atof(optarg);				break;
+			case 'T':	SIM_parse_pair(optarg, &config.bench.telemetry_period, &config.bench.telemetry_size);	break;
+			case 'B':	SIM_parse_pair(optarg, &config.bench.burst_period, &config.bench.burst_length);			break;
+			case 'A':	config.bench.alert_period = atoi(optarg);		break;
+			case 'P':	config.bench.poll_period = atoi(optarg);		break;
+			case 'K':	config.clock_ppm = atof(optarg);				break;
+			case 'N':	config.nodes_dir = optarg;						break;
+			case 'v':	config.verbose = true;							break;
+			default:	SIM_usage();									break;
+		}
+	}
+	if(config.objects_nb < 1 || config.objects_nb >= ESB_SIM_MAX_NODES || config.step_us == 0)
+		SIM_usage();
+
+	random_state = 0x9E3779B97F4A7C15ULL ^ config.seed;
+	host.verbose = config.verbose;
+	nodes_nb = config.objects_nb + 1;
+	for(uint32_t i = 0; i < nodes_nb; i++)
+	{
+		if(!SIM_load_node(i, i))
+			return 2;
+		nodes[i].x = (i == 0) ? config.area_m / 2 : SIM_random() * config.area_m;
+		nodes[i].y = (i == 0) ? config.area_m / 2 : SIM_random() * config.area_m;
+	}
+	for(uint32_t i = 1; i < nodes_nb && config.clock_ppm > 0; i++)
+	{
+		nodes[i].drift_ppb = (int32_t)((2 * SIM_random() - 1) * config.clock_ppm * 1e3);
+		nodes[i].api->set_clock((uint64_t)(SIM_random() * 1e9), nodes[i].drift_ppb);	//horloges dmarres  des instants diffrents
+	}
+	for(uint32_t i = 0; i < nodes_nb; i++)
+		nodes[i].api->init(&host, i, 0x10000 + i);
+	for(uint32_t i = 1; i < nodes_nb && config.period_ms; i++)
+		SIM_event_add(SIM_next_period(config.period_ms) + 1000000, EVENT_PROBE, i, -1);	//aprs la jonction des objets
+	if(config.downlink_period_ms)
+		SIM_event_add(1000000, EVENT_DOWNLINK, 0, -1);
+	bench = config.bench.telemetry_period || config.bench.burst_period || config.bench.alert_period || config.bench.poll_period;
+	if(bench)
+		SIM_event_add(1000000, EVENT_BENCH_START, 0, -1);
+	SIM_event_add(1000000, EVENT_TIMEBASE, 0, -1);
+
+	end_us = (uint64_t)(config.duration_s * 1e6);
+	for(uint64_t t = 0; t <= end_us; t += config.step_us)
+	{
+		while(events_nb && events[0].time <= t)
+		{
+			e = SIM_event_pop();
+			now_us = e.time;
+			switch(e.type)
+			{
+				case EVENT_TX_START:	SIM_tx_start(e.tx);											break;
+				case EVENT_TX_END:		SIM_tx_end(e.tx);											break;
+				case EVENT_ACK_TIMEOUT:	nodes[e.node].api->radio_tx_done(false, NULL, 0);			break;
+				case EVENT_PROBE:		SIM_send_probe(e.node);										break;
+				case EVENT_DOWNLINK:	SIM_send_downlink();										break;
+				case EVENT_BENCH_START:	SIM_bench_start();											break;
+				case EVENT_TIMEBASE:	SIM_timebase_sample();										break;
+			}
+		}
+		now_us = t;
+		for(; next_ms <= t; next_ms += 1000)
+			for(uint32_t i = 0; i < nodes_nb; i++)
+				nodes[i].api->process_ms();
+		for(uint32_t i = 0; i < nodes_nb; i++)
+			nodes[i].api->process_main();
+	}
+
+	printf("esb_sim  : base station + %u objects, %.1f s, seed %u, loss %.1f %%, latency %u us, collisions %s, area %.0f m\n",
+			config.objects_nb, now_us / 1e6, config.seed, config.loss * 100, config.latency_us, config.collisions ? "on" : "off", config.area_m);
+	printf("air      : %llu frames, %llu acks, %.2f %% busy ; lost receptions: collision %llu, half-duplex %llu, random %llu ; acks lost %llu, in conflict %llu\n",
+			(unsigned long long)stats.frames_nb, (unsigned long long)stats.acks_nb, 100.0 * stats.airtime_us / (now_us ? now_us : 1),
+			(unsigned long long)stats.lost_collision_nb, (unsigned long long)stats.lost_half_duplex_nb, (unsigned long long)stats.lost_random_nb,
+			(unsigned long long)stats.ack_lost_nb, (unsigned long long)stats.ack_conflict_nb);
+	ratio = SIM_report("uplink", true);
+	SIM_report("downlink", false);
+	if(stats.duplicate_probes_nb)
+		printf("duplicates: %llu probes delivered more than once\n", (unsigned long long)stats.duplicate_probes_nb);
+	if(bench && now_us > 1000000)
+		bench_ratio = SIM_bench_report(1000000);
+	SIM_secure_report();
+	SIM_timebase_report();
+
+	return (config.min_ratio >= 0 && (ratio < config.min_ratio || bench_ratio < config.min_ratio)) ? 1 : 0;
+}
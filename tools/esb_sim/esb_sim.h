@@ -0,0 +1,124 @@
+/*
+ * esb_sim.h
+ *
+ *  Created on: 17 oct. 2026
+ *
+ * Interface entre le simulateur (esb_sim.c : mdium radio, horloge, trafic) et chaque noeud simul (sim_node.c compil
+ * avec appli/common dans une bibliothque par OBJECT_ID, charge par dlopen : chaque noeud a ainsi ses propres variables).
+ */
+
+#ifndef ESB_SIM_H_
+#define ESB_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ESB_SIM_MAX_PAYLOAD_LENGTH	32
+
+//Trame telle qu'elle passe dans l'air (donnes ou acquittement)
+typedef struct
+{
+	uint8_t channel;
+	uint8_t bitrate;			//nrf_esb_bitrate_t
+	uint32_t base_address;		//adresse de base (4 octets) du pipe d'mission
+	uint8_t prefix;				//prfixe du pipe d'mission
+	uint8_t pid;
+	bool noack;
+	int8_t tx_power;			//[dBm]
+	uint8_t length;
+	uint8_t data[ESB_SIM_MAX_PAYLOAD_LENGTH];
+}esb_sim_air_frame_t;
+
+//Recopies de rf_bench_config_t et rf_bench_report_t, que le simulateur ne peut pas inclure (elles dpendent d'OBJECT_ID)
+typedef struct
+{
+	uint32_t telemetry_period;	//[ms]
+	uint8_t telemetry_size;		//[octets]
+	uint32_t burst_period;		//[ms]
+	uint8_t burst_length;
+	uint32_t alert_period;		//[ms]
+	uint32_t poll_period;		//[ms]
+}esb_sim_bench_config_t;
+
+typedef struct
+{
+	uint32_t sent_nb;
+	uint32_t received_nb;
+	uint32_t lost_nb;
+	uint32_t bytes_nb;
+	uint32_t latency_nb;
+	uint32_t latency_avg;		//[us]
+	uint32_t latency_p50;		//[us]
+	uint32_t latency_p99;		//[us]
+	uint32_t latency_max;		//[us]
+}esb_sim_bench_report_t;
+
+#define ESB_SIM_BENCH_CLASSES	{"telemetry", "burst", "alert", "poll"}	//ordre de rf_bench_class_e
+
+//Compteurs de rf_secure_stats_t (protection des trames)
+typedef struct
+{
+	uint32_t sealed_nb;
+	uint32_t opened_nb;
+	uint32_t unsealed_nb;
+	uint32_t replay_nb;
+	uint32_t unknown_nb;
+	uint32_t mic_failed_nb;
+	uint32_t ecb_blocks_nb;
+}esb_sim_secure_report_t;
+
+//Base de temps commune (appli/common/timebase.h), releve  un instant donn
+typedef struct
+{
+	uint32_t time_us;			//temps rseau estim par le noeud
+	bool synchronized;
+	int32_t drift_ppb;			//drive estime de l'horloge rseau par rapport  l'horloge locale
+	uint32_t samples_nb;
+	uint32_t steps_nb;
+}esb_sim_timebase_report_t;
+
+//Services du simulateur, appels par un noeud
+typedef struct
+{
+	uint64_t (*get_time_us)(void);
+	//Dbut d'mission de frame dans delay_us. La fin est signale par esb_sim_node_t.radio_tx_done.
+	void (*radio_tx)(uint32_t node, esb_sim_air_frame_t const * frame, uint32_t delay_us);
+	void (*uart_putc)(uint32_t node, uint8_t c);
+	void (*log)(uint32_t node, char const * s);
+	uint8_t noise;				//[-dBm] niveau relev par une mesure RSSI hors trame
+	bool verbose;				//TRUE : debug_printf des noeuds transmis  log
+}esb_sim_host_t;
+
+//Points d'entre d'un noeud, appels par le simulateur
+typedef struct
+{
+	uint32_t object_id;
+	void (*init)(esb_sim_host_t const * host, uint32_t node, uint32_t device_id);
+	//Horloge locale (systick) = temps simul x (1 + drift_ppb/1e9) + offset_us.  appeler avant init (dfaut : temps simul).
+	void (*set_clock)(uint64_t offset_us, int32_t drift_ppb);
+	void (*process_ms)(void);				//"IT" systick,  chaque ms
+	void (*process_main)(void);				//un passage dans la tache de fond
+	//TRUE si la radio coute ce canal  ce dbit (condition pour recevoir une trame qui commence)
+	bool (*radio_listening)(uint8_t channel, uint8_t bitrate);
+	//Fin de rception de frame. Renvoie TRUE si la radio l'accepte (adresse d'un pipe ouvert) ; si la trame demande
+	//un acquittement, ack est alors rempli (length : taille de la payload d'acquittement).
+	bool (*radio_rx)(esb_sim_air_frame_t const * frame, uint8_t rssi, esb_sim_air_frame_t * ack);
+	//Fin d'une mission : acquitte (ack non NULL), non acquitte, ou sans acquittement demand (success TRUE, ack NULL).
+	void (*radio_tx_done)(bool success, esb_sim_air_frame_t const * ack, uint8_t rssi);
+	//Objet : message de mesure vers la station (EVENT_OCCURED). Station : message reu du serveur sur l'UART.
+	void (*send_probe)(uint8_t size, uint8_t * datas);
+	void (*uart_rx)(uint8_t size, uint8_t * datas);
+	//Banc de charge (appli/common/rf_bench.h) : trafic des objets, interrogations de la station ; priodes nulles : inactif.
+	void (*bench_configure)(esb_sim_bench_config_t const * config);
+	//Station : rsultats d'une classe de messages (rf_bench_class_e). Renvoie FALSE si la classe n'existe pas.
+	bool (*bench_report)(uint8_t bench_class, esb_sim_bench_report_t * report);
+	//Protection des trames (appli/common/rf_secure.h). Renvoie FALSE si elle n'est pas compile (USE_RF_SECURE).
+	bool (*secure_report)(esb_sim_secure_report_t * report);
+	//Base de temps commune. Renvoie FALSE si elle n'est pas compile (USE_TIMEBASE).
+	bool (*timebase_report)(esb_sim_timebase_report_t * report);
+}esb_sim_node_t;
+
+#define ESB_SIM_NODE_ENTRY	"ESB_SIM_NODE_entry"
+typedef esb_sim_node_t const * (*esb_sim_node_entry_t)(void);
+
+#endif /* ESB_SIM_H_ */
@@ -0,0 +1,11 @@
+//Simulateur : journal du SDK dsactiv (debug_printf est redirig vers le simulateur, voir sim_node.c)
+#ifndef ESB_SIM_NRF_LOG_H_
+#define ESB_SIM_NRF_LOG_H_
+
+#define NRF_LOG_INFO(...)
+#define NRF_LOG_DEBUG(...)
+#define NRF_LOG_WARNING(...)
+#define NRF_LOG_ERROR(...)
+#define NRF_LOG_FLUSH()
+
+#endif
@@ -0,0 +1 @@
+#include "components/libraries/log/nrf_log.h"
@@ -0,0 +1,17 @@
+//Simulateur : seules les macros du SDK utilises par appli/common
+#ifndef ESB_SIM_SDK_COMMON_H_
+#define ESB_SIM_SDK_COMMON_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "components/softdevice/s132/headers/nrf_error.h"
+
+#ifndef MIN
+	#define MIN(a,b)	((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+	#define MAX(a,b)	((a) > (b) ? (a) : (b))
+#endif
+
+#endif
@@ -0,0 +1 @@
+#include "components/libraries/util/sdk_common.h"
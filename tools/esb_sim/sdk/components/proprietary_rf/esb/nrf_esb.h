@@ -0,0 +1,157 @@
+/*
+ * nrf_esb.h
+ *
+ *  Created on: 17 oct. 2026
+ *
+ * Simulateur : mme API que le pilote ESB du SDK (et que appli/common/nrf_esb.c), implmente par sim_node.c
+ * au-dessus du mdium simul.
+ */
+
+#ifndef ESB_SIM_NRF_ESB_H_
+#define ESB_SIM_NRF_ESB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "components/libraries/util/sdk_common.h"	//MIN, MAX (app_util.h dans le SDK)
+
+#define NRF_ESB_MAX_PAYLOAD_LENGTH		32
+#define NRF_ESB_PIPE_COUNT				8
+#define NRF_ESB_TX_FIFO_SIZE			8
+#define NRF_ESB_RX_FIFO_SIZE			8
+
+#define NRF_ESB_ERROR_NOT_IN_RX_MODE	(0x8000 + 1)
+
+typedef enum
+{
+	NRF_ESB_PROTOCOL_ESB,
+	NRF_ESB_PROTOCOL_ESB_DPL
+}nrf_esb_protocol_t;
+
+typedef enum
+{
+	NRF_ESB_MODE_PTX,
+	NRF_ESB_MODE_PRX
+}nrf_esb_mode_t;
+
+typedef enum
+{
+	NRF_ESB_BITRATE_2MBPS,
+	NRF_ESB_BITRATE_1MBPS,
+	NRF_ESB_BITRATE_250KBPS,
+	NRF_ESB_BITRATE_1MBPS_BLE,
+	NRF_ESB_BITRATE_2MBPS_BLE
+}nrf_esb_bitrate_t;
+
+typedef enum
+{
+	NRF_ESB_CRC_16BIT = 2,
+	NRF_ESB_CRC_8BIT = 1,
+	NRF_ESB_CRC_OFF = 0
+}nrf_esb_crc_t;
+
+typedef enum
+{
+	NRF_ESB_TX_POWER_4DBM = 4,
+	NRF_ESB_TX_POWER_3DBM = 3,
+	NRF_ESB_TX_POWER_0DBM = 0,
+	NRF_ESB_TX_POWER_NEG4DBM = -4,
+	NRF_ESB_TX_POWER_NEG8DBM = -8,
+	NRF_ESB_TX_POWER_NEG12DBM = -12,
+	NRF_ESB_TX_POWER_NEG16DBM = -16,
+	NRF_ESB_TX_POWER_NEG20DBM = -20,
+	NRF_ESB_TX_POWER_NEG30DBM = -30,
+	NRF_ESB_TX_POWER_NEG40DBM = -40
+}nrf_esb_tx_power_t;
+
+typedef enum
+{
+	NRF_ESB_TXMODE_AUTO,
+	NRF_ESB_TXMODE_MANUAL,
+	NRF_ESB_TXMODE_MANUAL_START
+}nrf_esb_tx_mode_t;
+
+typedef enum
+{
+	NRF_ESB_EVENT_TX_SUCCESS,
+	NRF_ESB_EVENT_TX_FAILED,
+	NRF_ESB_EVENT_RX_RECEIVED
+}nrf_esb_evt_id_t;
+
+typedef struct
+{
+	uint8_t length;
+	uint8_t pipe;
+	int8_t rssi;
+	uint8_t noack;
+	uint8_t pid;
+	uint8_t data[NRF_ESB_MAX_PAYLOAD_LENGTH];
+}nrf_esb_payload_t;
+
+typedef struct
+{
+	nrf_esb_evt_id_t evt_id;
+	uint32_t tx_attempts;
+}nrf_esb_evt_t;
+
+typedef void (* nrf_esb_event_handler_t)(nrf_esb_evt_t const * p_event);
+
+typedef struct
+{
+	nrf_esb_protocol_t protocol;
+	nrf_esb_mode_t mode;
+	nrf_esb_event_handler_t event_handler;
+	nrf_esb_bitrate_t bitrate;
+	nrf_esb_crc_t crc;
+	nrf_esb_tx_power_t tx_output_power;
+	uint16_t retransmit_delay;
+	uint16_t retransmit_count;
+	nrf_esb_tx_mode_t tx_mode;
+	uint8_t radio_irq_priority;
+	uint8_t event_irq_priority;
+	uint8_t payload_length;
+	bool selective_auto_ack;
+}nrf_esb_config_t;
+
+//Mmes valeurs que le SDK
+#define NRF_ESB_DEFAULT_CONFIG {.protocol = NRF_ESB_PROTOCOL_ESB_DPL,	\
+								.mode = NRF_ESB_MODE_PTX,				\
+								.event_handler = 0,						\
+								.bitrate = NRF_ESB_BITRATE_2MBPS,		\
+								.crc = NRF_ESB_CRC_16BIT,				\
+								.tx_output_power = NRF_ESB_TX_POWER_0DBM,	\
+								.retransmit_delay = 250,				\
+								.retransmit_count = 3,					\
+								.tx_mode = NRF_ESB_TXMODE_AUTO,			\
+								.radio_irq_priority = 1,				\
+								.event_irq_priority = 2,				\
+								.payload_length = 32,					\
+								.selective_auto_ack = false}
+
+uint32_t nrf_esb_init(nrf_esb_config_t const * p_config);
+uint32_t nrf_esb_suspend(void);
+uint32_t nrf_esb_disable(void);
+bool nrf_esb_is_idle(void);
+uint32_t nrf_esb_write_payload(nrf_esb_payload_t const * p_payload);
+uint32_t nrf_esb_read_rx_payload(nrf_esb_payload_t * p_payload);
+uint32_t nrf_esb_start_tx(void);
+uint32_t nrf_esb_start_rx(void);
+uint32_t nrf_esb_stop_rx(void);
+uint32_t nrf_esb_flush_tx(void);
+uint32_t nrf_esb_pop_tx(void);
+uint32_t nrf_esb_skip_tx(void);
+uint32_t nrf_esb_flush_rx(void);
+uint32_t nrf_esb_set_address_length(uint8_t length);
+uint32_t nrf_esb_set_base_address_0(uint8_t const * p_addr);
+uint32_t nrf_esb_set_base_address_1(uint8_t const * p_addr);
+uint32_t nrf_esb_set_prefixes(uint8_t const * p_prefixes, uint8_t num_pipes);
+uint32_t nrf_esb_update_prefix(uint8_t pipe, uint8_t prefix);
+uint32_t nrf_esb_enable_pipes(uint8_t enable_mask);
+uint32_t nrf_esb_set_rf_channel(uint32_t channel);
+uint32_t nrf_esb_get_rf_channel(uint32_t * p_channel);
+uint32_t nrf_esb_set_tx_power(nrf_esb_tx_power_t tx_output_power);
+uint32_t nrf_esb_set_retransmit_delay(uint16_t delay);
+uint32_t nrf_esb_set_retransmit_count(uint16_t count);
+uint32_t nrf_esb_set_bitrate(nrf_esb_bitrate_t bitrate);
+uint32_t nrf_esb_reuse_pid(uint8_t pipe);
+
+#endif /* ESB_SIM_NRF_ESB_H_ */
@@ -0,0 +1,19 @@
+//Simulateur : codes d'erreur du SDK utiliss par appli/common et sim_node.c
+#ifndef ESB_SIM_NRF_ERROR_H_
+#define ESB_SIM_NRF_ERROR_H_
+
+#include <stdint.h>
+
+#define NRF_SUCCESS					(0)
+#define NRF_ERROR_NO_MEM			(4)
+#define NRF_ERROR_NOT_FOUND			(5)
+#define NRF_ERROR_INVALID_PARAM		(7)
+#define NRF_ERROR_INVALID_STATE		(8)
+#define NRF_ERROR_INVALID_LENGTH	(9)
+#define NRF_ERROR_NULL				(14)
+#define NRF_ERROR_BUSY				(17)
+#define NRF_ERROR_BUFFER_EMPTY		(19)
+
+typedef uint32_t ret_code_t;
+
+#endif
@@ -0,0 +1,2 @@
+//Simulateur : aucune broche
+#include <stdint.h>
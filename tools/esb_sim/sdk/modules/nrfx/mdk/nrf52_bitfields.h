@@ -0,0 +1 @@
+//Simulateur : aucun champ de registre utilis en dehors de ceux de nrf.h
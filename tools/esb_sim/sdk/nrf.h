@@ -0,0 +1,66 @@
+/*
+ * nrf.h
+ *
+ *  Created on: 17 oct. 2026
+ *
+ * Simulateur (tools/esb_sim) : remplaant, pour une compilation sur PC, des quelques registres et fonctions CMSIS
+ * utiliss par appli/common. Tout le code d'un noeud s'excute dans un seul fil : les sections critiques sont vides,
+ * et les "interruptions" (radio, systick) sont appeles par le simulateur entre deux passages dans la tache de fond.
+ */
+
+#ifndef ESB_SIM_NRF_H_
+#define ESB_SIM_NRF_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct
+{
+	uint32_t DEVICEID[2];
+	uint32_t DEVICEADDR[2];
+}NRF_FICR_Type;
+
+typedef struct
+{
+	volatile uint32_t TASKS_RSSISTART;
+	volatile uint32_t TASKS_RSSISTOP;
+	volatile uint32_t EVENTS_RSSIEND;
+	volatile uint32_t RSSISAMPLE;
+	volatile uint32_t STATE;
+}NRF_RADIO_Type;
+
+//ECBDATAPTR est assez grand pour une adresse du PC. Le bloc est chiffr (AES logiciel)  la lecture du registre qui suit TASKS_STARTECB.
+typedef struct
+{
+	volatile uint32_t TASKS_STARTECB;
+	volatile uint32_t TASKS_STOPECB;
+	volatile uint32_t EVENTS_ENDECB;
+	volatile uint32_t EVENTS_ERRORECB;
+	volatile uintptr_t ECBDATAPTR;
+}NRF_ECB_Type;
+
+//Propres  chaque noeud (voir sim_node.c)
+extern NRF_FICR_Type sim_ficr;
+extern NRF_RADIO_Type sim_radio;
+NRF_ECB_Type * SIM_NODE_ecb(void);
+#define NRF_FICR	(&sim_ficr)
+#define NRF_RADIO	(&sim_radio)
+#define NRF_ECB		(SIM_NODE_ecb())
+
+#define RADIO_STATE_STATE_RxIdle	(2)
+#define RADIO_STATE_STATE_Rx		(3)
+
+void NVIC_SystemReset(void);
+
+static inline void __disable_irq(void) {}
+static inline void __enable_irq(void) {}
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) { (void)primask; }
+static inline void __DMB(void) {}
+
+#ifndef __unused
+	#define __unused	__attribute__((unused))
+#endif
+
+#endif /* ESB_SIM_NRF_H_ */
@@ -0,0 +1,851 @@
+/*
+ * sim_node.c
+ *
+ *  Created on: 17 oct. 2026
+ *
+ * Noeud simul (voir esb_sim.c) : pilote ESB de mme API que appli/common/nrf_esb.c, au-dessus du mdium simul,
+ * et les quelques services du BSP utiliss par appli/common (systick, flash, UART, journal).
+ * Compil avec appli/common pour un OBJECT_ID donn ; seul ESB_SIM_NODE_entry est visible hors de la bibliothque.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "appli/config.h"
+#include "appli/common/secretary.h"
+#include "appli/common/rf_dialog.h"
+#include "appli/common/parameters.h"
+#include "appli/common/systick.h"
+#include "appli/common/flash.h"
+#include "appli/common/rf_bench.h"
+#include "appli/common/rf_secure.h"
+#include "appli/common/timebase.h"
+#include "esb_sim.h"
+
+#define SIM_NODE_EXPORT				__attribute__((visibility("default")))
+#define SIM_NODE_CALLBACKS_NB		8
+#define SIM_NODE_FLASH_SIZE			0x10000		//mme taille que la zone de flash.c
+#define SIM_NODE_PID_MAX			3
+
+NRF_FICR_Type sim_ficr;
+NRF_RADIO_Type sim_radio;
+
+static esb_sim_host_t const * host;
+static uint32_t node_index;
+static callback_fun_t callbacks[SIM_NODE_CALLBACKS_NB];
+static uint32_t flash[SIM_NODE_FLASH_SIZE/4];
+static uint64_t clock_offset_us = 0;
+static int32_t clock_drift_ppb = 0;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Pilote ESB
+
+typedef enum
+{
+	ESB_STATE_IDLE,
+	ESB_STATE_RX,
+	ESB_STATE_TX			//mission en cours, attente de l'acquittement comprise
+}esb_state_e;
+
+typedef struct
+{
+	bool valid;
+	uint8_t pid;
+	uint16_t crc;
+}esb_rx_pipe_info_t;
+
+static bool esb_initialized = false;
+static nrf_esb_config_t esb_config;
+static esb_state_e esb_state;
+static uint32_t base_addresses[2];
+static uint8_t prefixes[NRF_ESB_PIPE_COUNT];
+static uint8_t pipes_enabled;
+static uint8_t rf_channel;
+static uint8_t pids[NRF_ESB_PIPE_COUNT];
+static esb_rx_pipe_info_t rx_pipe_infos[NRF_ESB_PIPE_COUNT];
+static nrf_esb_payload_t tx_fifo[NRF_ESB_TX_FIFO_SIZE];
+static uint8_t tx_fifo_read;
+static uint8_t tx_fifo_nb;
+static nrf_esb_payload_t rx_fifo[NRF_ESB_RX_FIFO_SIZE];
+static uint8_t rx_fifo_read;
+static uint8_t rx_fifo_nb;
+static nrf_esb_payload_t ack_payloads[NRF_ESB_PIPE_COUNT];
+static uint32_t tx_attempts;
+static uint64_t tx_attempt_start;
+
+static void SIM_NODE_log(char const * format, ...)
+{
+	char s[160];
+	va_list args;
+
+	va_start(args, format);
+	vsnprintf(s, sizeof(s), format, args);
+	va_end(args);
+	host->log(node_index, s);
+}
+
+//Les fonctions de configuration du pilote exigent une radio au repos : un appel hors de cet tat est une erreur du firmware.
+static uint32_t SIM_NODE_esb_busy(char const * function)
+{
+	SIM_NODE_log("%s : radio occupee (etat %d)", function, esb_state);
+	return NRF_ERROR_BUSY;
+}
+
+static uint16_t SIM_NODE_crc(esb_sim_air_frame_t const * frame)
+{
+	uint8_t bytes[7 + ESB_SIM_MAX_PAYLOAD_LENGTH];
+	uint16_t crc = 0xFFFF;
+
+	bytes[0] = frame->base_address >> 24;
+	bytes[1] = frame->base_address >> 16;
+	bytes[2] = frame->base_address >> 8;
+	bytes[3] = frame->base_address;
+	bytes[4] = frame->prefix;
+	bytes[5] = frame->length;
+	bytes[6] = frame->pid;
+	memcpy(&bytes[7], frame->data, frame->length);
+	for(uint8_t i = 0; i < 7 + frame->length; i++)
+	{
+		crc ^= (uint16_t)bytes[i] << 8;
+		for(uint8_t b = 0; b < 8; b++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+	}
+	return crc;
+}
+
+static void SIM_NODE_esb_event(nrf_esb_evt_id_t evt_id, uint32_t attempts)
+{
+	nrf_esb_evt_t event;
+
+	event.evt_id = evt_id;
+	event.tx_attempts = attempts;
+	if(esb_config.event_handler != NULL)
+		esb_config.event_handler(&event);
+}
+
+//Nouvel essai d'mission de la trame en tte de la FIFO, dans delay_us.
+static void SIM_NODE_esb_start_attempt(uint32_t delay_us)
+{
+	esb_sim_air_frame_t frame;
+	nrf_esb_payload_t * payload = &tx_fifo[tx_fifo_read];
+
+	frame.channel = rf_channel;
+	frame.bitrate = esb_config.bitrate;
+	frame.base_address = base_addresses[(payload->pipe == 0) ? 0 : 1];
+	frame.prefix = prefixes[payload->pipe];
+	frame.pid = payload->pid;
+	frame.noack = (esb_config.selective_auto_ack && payload->noack) ? true : false;
+	frame.tx_power = (int8_t)esb_config.tx_output_power;
+	frame.length = payload->length;
+	memcpy(frame.data, payload->data, payload->length);
+
+	esb_state = ESB_STATE_TX;
+	tx_attempts++;
+	tx_attempt_start = host->get_time_us() + delay_us;
+	host->radio_tx(node_index, &frame, delay_us);
+}
+
+static void SIM_NODE_radio_tx_done(bool success, esb_sim_air_frame_t const * ack, uint8_t rssi)
+{
+	nrf_esb_payload_t * payload;
+	uint64_t elapsed;
+	uint32_t attempts;
+	bool ack_payload_received = false;
+
+	if(esb_state != ESB_STATE_TX)
+		return;
+	if(!success && tx_attempts <= esb_config.retransmit_count)
+	{
+		//retransmission, retransmit_delay aprs le dbut de l'essai prcdent
+		elapsed = host->get_time_us() - tx_attempt_start;
+		SIM_NODE_esb_start_attempt((elapsed < esb_config.retransmit_delay) ? esb_config.retransmit_delay - elapsed : 0);
+		return;
+	}
+
+	attempts = tx_attempts;
+	tx_attempts = 0;
+	esb_state = ESB_STATE_IDLE;
+	if(success)
+	{
+		if(ack != NULL && ack->length > 0 && rx_fifo_nb < NRF_ESB_RX_FIFO_SIZE)
+		{
+			payload = &rx_fifo[(rx_fifo_read + rx_fifo_nb) % NRF_ESB_RX_FIFO_SIZE];
+			payload->length = ack->length;
+			payload->pipe = tx_fifo[tx_fifo_read].pipe;
+			payload->rssi = rssi;
+			payload->pid = ack->pid;
+			payload->noack = 0;
+			memcpy(payload->data, ack->data, ack->length);
+			rx_fifo_nb++;
+			ack_payload_received = true;
+		}
+		tx_fifo_read = (tx_fifo_read + 1) % NRF_ESB_TX_FIFO_SIZE;
+		tx_fifo_nb--;
+		if(tx_fifo_nb > 0 && esb_config.tx_mode == NRF_ESB_TXMODE_AUTO)
+			SIM_NODE_esb_start_attempt(0);
+	}
+	//en cas d'chec, la trame reste en tte de la FIFO (comme avec le pilote du SDK)
+	SIM_NODE_esb_event(success ? NRF_ESB_EVENT_TX_SUCCESS : NRF_ESB_EVENT_TX_FAILED, attempts);
+	if(ack_payload_received)
+		SIM_NODE_esb_event(NRF_ESB_EVENT_RX_RECEIVED, attempts);
+}
+
+static bool SIM_NODE_radio_listening(uint8_t channel, uint8_t bitrate)
+{
+	return esb_initialized && esb_state == ESB_STATE_RX && rf_channel == channel && esb_config.bitrate == bitrate;
+}
+
+//Mme traitement que on_radio_disabled_rx() de appli/common/nrf_esb.c (hors payloads d'acquittement tires de la FIFO d'mission).
+static bool SIM_NODE_radio_rx(esb_sim_air_frame_t const * frame, uint8_t rssi, esb_sim_air_frame_t * ack)
+{
+	esb_rx_pipe_info_t * info;
+	nrf_esb_payload_t * payload;
+	bool retransmit;
+	uint16_t crc;
+	uint8_t pipe;
+
+	if(!SIM_NODE_radio_listening(frame->channel, frame->bitrate))
+		return false;
+	for(pipe = 0; pipe < NRF_ESB_PIPE_COUNT; pipe++)
+	{
+		if((pipes_enabled & (1 << pipe)) && base_addresses[(pipe == 0) ? 0 : 1] == frame->base_address && prefixes[pipe] == frame->prefix)
+			break;
+	}
+	if(pipe == NRF_ESB_PIPE_COUNT || rx_fifo_nb >= NRF_ESB_RX_FIFO_SIZE)
+		return false;
+
+	crc = SIM_NODE_crc(frame);
+	info = &rx_pipe_infos[pipe];
+	retransmit = (info->valid && info->pid == frame->pid && info->crc == crc) ? true : false;
+	info->valid = true;
+	info->pid = frame->pid;
+	info->crc = crc;
+
+	if(!frame->noack)
+	{
+		*ack = *frame;
+		ack->noack = true;
+		ack->tx_power = (int8_t)esb_config.tx_output_power;
+		ack->length = ack_payloads[pipe].length;
+		if(ack->length > 0)
+			memcpy(ack->data, ack_payloads[pipe].data, ack->length);	//rpte dans chaque acquittement, jusqu' son remplacement
+	}
+
+	if(!retransmit)
+	{
+		payload = &rx_fifo[(rx_fifo_read + rx_fifo_nb) % NRF_ESB_RX_FIFO_SIZE];
+		payload->length = frame->length;
+		payload->pipe = pipe;
+		payload->rssi = rssi;
+		payload->pid = frame->pid;
+		payload->noack = frame->noack;
+		memcpy(payload->data, frame->data, frame->length);
+		rx_fifo_nb++;
+		SIM_NODE_esb_event(NRF_ESB_EVENT_RX_RECEIVED, 0);
+	}
+	return true;
+}
+
+uint32_t nrf_esb_init(nrf_esb_config_t const * p_config)
+{
+	uint8_t default_prefixes[NRF_ESB_PIPE_COUNT] = {0xE7, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8};
+
+	if(p_config == NULL)
+		return NRF_ERROR_NULL;
+	esb_config = *p_config;
+	esb_state = ESB_STATE_IDLE;
+	base_addresses[0] = 0xE7E7E7E7;
+	base_addresses[1] = 0xC2C2C2C2;
+	memcpy(prefixes, default_prefixes, NRF_ESB_PIPE_COUNT);
+	pipes_enabled = 0xFF;
+	rf_channel = 2;
+	memset(pids, 0, sizeof(pids));
+	memset(rx_pipe_infos, 0, sizeof(rx_pipe_infos));
+	memset(ack_payloads, 0, sizeof(ack_payloads));
+	tx_fifo_read = tx_fifo_nb = 0;
+	rx_fifo_read = rx_fifo_nb = 0;
+	tx_attempts = 0;
+	esb_initialized = true;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_suspend(void)
+{
+	if(esb_state == ESB_STATE_TX)
+		return SIM_NODE_esb_busy(__func__);
+	esb_state = ESB_STATE_IDLE;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_disable(void)
+{
+	esb_state = ESB_STATE_IDLE;
+	esb_initialized = false;
+	return NRF_SUCCESS;
+}
+
+bool nrf_esb_is_idle(void)
+{
+	return esb_state == ESB_STATE_IDLE;
+}
+
+uint32_t nrf_esb_write_payload(nrf_esb_payload_t const * p_payload)
+{
+	nrf_esb_payload_t * payload;
+
+	if(!esb_initialized)
+		return NRF_ERROR_INVALID_STATE;
+	if(p_payload == NULL)
+		return NRF_ERROR_NULL;
+	if(p_payload->length == 0 || p_payload->length > NRF_ESB_MAX_PAYLOAD_LENGTH)
+		return NRF_ERROR_INVALID_LENGTH;
+	if(tx_fifo_nb >= NRF_ESB_TX_FIFO_SIZE)
+		return NRF_ERROR_NO_MEM;
+	if(p_payload->pipe >= NRF_ESB_PIPE_COUNT)
+		return NRF_ERROR_INVALID_PARAM;
+
+	payload = &tx_fifo[(tx_fifo_read + tx_fifo_nb) % NRF_ESB_TX_FIFO_SIZE];
+	*payload = *p_payload;
+	pids[p_payload->pipe] = (pids[p_payload->pipe] + 1) % (SIM_NODE_PID_MAX + 1);
+	payload->pid = pids[p_payload->pipe];
+	tx_fifo_nb++;
+
+	if(esb_config.mode == NRF_ESB_MODE_PTX && esb_config.tx_mode == NRF_ESB_TXMODE_AUTO && esb_state == ESB_STATE_IDLE)
+		SIM_NODE_esb_start_attempt(0);
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_set_ack_payload(uint8_t pipe, uint8_t const * p_data, uint8_t length)
+{
+	if(!esb_initialized)
+		return NRF_ERROR_INVALID_STATE;
+	if(pipe >= NRF_ESB_PIPE_COUNT)
+		return NRF_ERROR_INVALID_PARAM;
+	if(length > NRF_ESB_MAX_PAYLOAD_LENGTH)
+		return NRF_ERROR_INVALID_LENGTH;
+	if(length > 0)
+		memcpy(ack_payloads[pipe].data, p_data, length);
+	ack_payloads[pipe].length = length;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_read_rx_payload(nrf_esb_payload_t * p_payload)
+{
+	if(!esb_initialized)
+		return NRF_ERROR_INVALID_STATE;
+	if(p_payload == NULL)
+		return NRF_ERROR_NULL;
+	if(rx_fifo_nb == 0)
+		return NRF_ERROR_NOT_FOUND;
+	*p_payload = rx_fifo[rx_fifo_read];
+	rx_fifo_read = (rx_fifo_read + 1) % NRF_ESB_RX_FIFO_SIZE;
+	rx_fifo_nb--;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_start_tx(void)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return NRF_ERROR_BUSY;
+	if(tx_fifo_nb == 0)
+		return NRF_ERROR_BUFFER_EMPTY;
+	SIM_NODE_esb_start_attempt(0);
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_start_rx(void)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return NRF_ERROR_BUSY;
+	esb_state = ESB_STATE_RX;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_stop_rx(void)
+{
+	if(esb_state != ESB_STATE_RX)
+		return NRF_ESB_ERROR_NOT_IN_RX_MODE;
+	esb_state = ESB_STATE_IDLE;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_flush_tx(void)
+{
+	if(!esb_initialized)
+		return NRF_ERROR_INVALID_STATE;
+	tx_fifo_read = tx_fifo_nb = 0;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_pop_tx(void)
+{
+	if(!esb_initialized)
+		return NRF_ERROR_INVALID_STATE;
+	if(tx_fifo_nb == 0)
+		return NRF_ERROR_BUFFER_EMPTY;
+	tx_fifo_nb--;	//la dernire trame crite
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_skip_tx(void)
+{
+	if(!esb_initialized)
+		return NRF_ERROR_INVALID_STATE;
+	if(tx_fifo_nb == 0)
+		return NRF_ERROR_BUFFER_EMPTY;
+	tx_fifo_read = (tx_fifo_read + 1) % NRF_ESB_TX_FIFO_SIZE;
+	tx_fifo_nb--;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_flush_rx(void)
+{
+	if(!esb_initialized)
+		return NRF_ERROR_INVALID_STATE;
+	rx_fifo_read = rx_fifo_nb = 0;
+	memset(rx_pipe_infos, 0, sizeof(rx_pipe_infos));
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_set_address_length(uint8_t length)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return SIM_NODE_esb_busy(__func__);
+	return (length == 5) ? NRF_SUCCESS : NRF_ERROR_INVALID_PARAM;	//seule longueur simule : 4 octets de base + prfixe
+}
+
+uint32_t nrf_esb_set_base_address_0(uint8_t const * p_addr)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return SIM_NODE_esb_busy(__func__);
+	base_addresses[0] = U32FROMU8(p_addr[0], p_addr[1], p_addr[2], p_addr[3]);
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_set_base_address_1(uint8_t const * p_addr)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return SIM_NODE_esb_busy(__func__);
+	base_addresses[1] = U32FROMU8(p_addr[0], p_addr[1], p_addr[2], p_addr[3]);
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_set_prefixes(uint8_t const * p_prefixes, uint8_t num_pipes)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return SIM_NODE_esb_busy(__func__);
+	if(num_pipes > NRF_ESB_PIPE_COUNT)
+		return NRF_ERROR_INVALID_PARAM;
+	memcpy(prefixes, p_prefixes, num_pipes);
+	pipes_enabled = (uint8_t)((1 << num_pipes) - 1);
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_update_prefix(uint8_t pipe, uint8_t prefix)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return SIM_NODE_esb_busy(__func__);
+	if(pipe >= NRF_ESB_PIPE_COUNT)
+		return NRF_ERROR_INVALID_PARAM;
+	prefixes[pipe] = prefix;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_enable_pipes(uint8_t enable_mask)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return SIM_NODE_esb_busy(__func__);
+	pipes_enabled = enable_mask;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_set_rf_channel(uint32_t channel)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return SIM_NODE_esb_busy(__func__);
+	if(channel > 100)
+		return NRF_ERROR_INVALID_PARAM;
+	rf_channel = channel;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_get_rf_channel(uint32_t * p_channel)
+{
+	if(p_channel == NULL)
+		return NRF_ERROR_NULL;
+	*p_channel = rf_channel;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_set_tx_power(nrf_esb_tx_power_t tx_output_power)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return SIM_NODE_esb_busy(__func__);
+	esb_config.tx_output_power = tx_output_power;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_set_retransmit_delay(uint16_t delay)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return SIM_NODE_esb_busy(__func__);
+	esb_config.retransmit_delay = delay;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_set_retransmit_count(uint16_t count)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return SIM_NODE_esb_busy(__func__);
+	esb_config.retransmit_count = count;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_set_bitrate(nrf_esb_bitrate_t bitrate)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return SIM_NODE_esb_busy(__func__);
+	esb_config.bitrate = bitrate;
+	return NRF_SUCCESS;
+}
+
+uint32_t nrf_esb_reuse_pid(uint8_t pipe)
+{
+	if(esb_state != ESB_STATE_IDLE)
+		return SIM_NODE_esb_busy(__func__);
+	if(pipe >= NRF_ESB_PIPE_COUNT)
+		return NRF_ERROR_INVALID_PARAM;
+	pids[pipe] = (pids[pipe] + SIM_NODE_PID_MAX) % (SIM_NODE_PID_MAX + 1);
+	return NRF_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Priphrique ECB : AES-128 logiciel (FIPS-197), chiffrement seulement comme le priphrique
+
+static NRF_ECB_Type sim_ecb;
+
+static const uint8_t aes_sbox[256] =
+{
+	0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+	0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+	0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+	0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+	0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+	0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+	0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+	0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+	0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+	0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+	0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+	0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+	0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+	0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+	0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+	0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+static uint8_t SIM_NODE_aes_xtime(uint8_t x)
+{
+	return (x << 1) ^ ((x & 0x80) ? 0x1b : 0x00);
+}
+
+static void SIM_NODE_aes128(uint8_t const * key, uint8_t const * in, uint8_t * out)
+{
+	uint8_t round_key[176];
+	uint8_t s[16];
+	uint8_t t[16];
+	uint8_t rcon = 0x01;
+
+	//expansion de la cl
+	memcpy(round_key, key, 16);
+	for(int i = 16; i < 176; i += 4)
+	{
+		uint8_t w[4] = {round_key[i-4], round_key[i-3], round_key[i-2], round_key[i-1]};
+		if(i % 16 == 0)
+		{
+			uint8_t first = w[0];
+			w[0] = aes_sbox[w[1]] ^ rcon;
+			w[1] = aes_sbox[w[2]];
+			w[2] = aes_sbox[w[3]];
+			w[3] = aes_sbox[first];
+			rcon = SIM_NODE_aes_xtime(rcon);
+		}
+		for(int j = 0; j < 4; j++)
+			round_key[i+j] = round_key[i-16+j] ^ w[j];
+	}
+
+	for(int i = 0; i < 16; i++)
+		s[i] = in[i] ^ round_key[i];
+	for(int round = 1; round <= 10; round++)
+	{
+		//SubBytes et ShiftRows (tat rang colonne par colonne)
+		for(int i = 0; i < 16; i++)
+			t[i] = aes_sbox[s[(i + 4 * (i % 4)) % 16]];
+		//MixColumns, sauf au dernier tour
+		for(int c = 0; c < 4; c++)
+		{
+			uint8_t * col = &t[4*c];
+			if(round < 10)
+			{
+				uint8_t all = col[0] ^ col[1] ^ col[2] ^ col[3];
+				uint8_t first = col[0];
+				col[0] ^= all ^ SIM_NODE_aes_xtime(col[0] ^ col[1]);
+				col[1] ^= all ^ SIM_NODE_aes_xtime(col[1] ^ col[2]);
+				col[2] ^= all ^ SIM_NODE_aes_xtime(col[2] ^ col[3]);
+				col[3] ^= all ^ SIM_NODE_aes_xtime(col[3] ^ first);
+			}
+		}
+		for(int i = 0; i < 16; i++)
+			s[i] = t[i] ^ round_key[16 * round + i];
+	}
+	memcpy(out, s, 16);
+}
+
+//ECBDATAPTR pointe sur [CLE(16) CLAIR(16) CHIFFRE(16)]. Le chiffrement est instantan : ENDECB est lev ds la lecture suivante.
+NRF_ECB_Type * SIM_NODE_ecb(void)
+{
+	uint8_t * data;
+
+	if(sim_ecb.TASKS_STARTECB)
+	{
+		sim_ecb.TASKS_STARTECB = 0;
+		data = (uint8_t *)sim_ecb.ECBDATAPTR;
+		SIM_NODE_aes128(data, data + 16, data + 32);
+		sim_ecb.EVENTS_ENDECB = 1;
+	}
+	return &sim_ecb;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Services du BSP
+
+//Horloge du quartz du noeud, dcale et drivant par rapport au temps simul (voir esb_sim_node_t.set_clock)
+static uint64_t SIM_NODE_local_time_us(void)
+{
+	uint64_t t = host->get_time_us();
+	return t + clock_offset_us + (int64_t)t * clock_drift_ppb / 1000000000;
+}
+
+uint32_t SYSTICK_get_time_us(void)
+{
+	return (uint32_t)SIM_NODE_local_time_us();
+}
+
+uint32_t SYSTICK_get_time_ms(void)
+{
+	return (uint32_t)(SIM_NODE_local_time_us() / 1000);
+}
+
+bool_e Systick_add_callback_function(callback_fun_t func)
+{
+	for(uint8_t i = 0; i < SIM_NODE_CALLBACKS_NB; i++)
+	{
+		if(callbacks[i] == NULL)
+		{
+			callbacks[i] = func;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+bool_e Systick_remove_callback_function(callback_fun_t func)
+{
+	for(uint8_t i = 0; i < SIM_NODE_CALLBACKS_NB; i++)
+	{
+		if(callbacks[i] == func)
+		{
+			callbacks[i] = NULL;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+void FLASHWRITER_init(void)
+{
+}
+
+uint32_t FLASHWRITER_read(uint32_t address)
+{
+	return (address < SIM_NODE_FLASH_SIZE) ? flash[address/4] : 0;
+}
+
+running_e FLASHWRITER_write(uint32_t address, uint32_t value)
+{
+	if(address >= SIM_NODE_FLASH_SIZE)
+		return END_ERROR;
+	flash[address/4] = value;
+	return END_OK;
+}
+
+void FLASHWRITER_erase(uint32_t address)
+{
+	if(address < SIM_NODE_FLASH_SIZE)
+		flash[address/4] = 0xFFFFFFFF;
+}
+
+//Comme la flash : seuls des bits  1 peuvent passer  0
+running_e FLASHWRITER_program(uint32_t address, uint32_t value)
+{
+	if(address >= SIM_NODE_FLASH_SIZE)
+		return END_ERROR;
+	flash[address/4] &= value;
+	return (flash[address/4] == value) ? END_OK : END_ERROR;
+}
+
+void FLASHWRITER_erase_page(uint32_t address)
+{
+	if(address < SIM_NODE_FLASH_SIZE)
+		memset(&flash[(address & ~0xFFFu)/4], 0xFF, 0x1000);
+}
+
+void SERIAL_DIALOG_putc(char c)
+{
+	host->uart_putc(node_index, (uint8_t)c);
+}
+
+uint32_t debug_printf(char * format, ...)
+{
+	char s[160];
+	va_list args;
+	int n;
+
+	if(!host->verbose)
+		return 0;
+	va_start(args, format);
+	n = vsnprintf(s, sizeof(s), format, args);
+	va_end(args);
+	host->log(node_index, s);
+	return (n > 0) ? n : 0;
+}
+
+void NVIC_SystemReset(void)
+{
+	SIM_NODE_log("reset logiciel demande (ignore)");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Points d'entre
+
+static void SIM_NODE_init(esb_sim_host_t const * h, uint32_t node, uint32_t device_id)
+{
+	host = h;
+	node_index = node;
+	sim_ficr.DEVICEID[0] = device_id;
+	sim_radio.STATE = RADIO_STATE_STATE_Rx;
+	sim_radio.RSSISAMPLE = host->noise;
+	memset(flash, 0xFF, sizeof(flash));
+
+	//mme squence que main()
+	PARAMETERS_init();
+	SECRETARY_init();
+}
+
+static void SIM_NODE_set_clock(uint64_t offset_us, int32_t drift_ppb)
+{
+	clock_offset_us = offset_us;
+	clock_drift_ppb = drift_ppb;
+}
+
+static void SIM_NODE_process_ms(void)
+{
+	for(uint8_t i = 0; i < SIM_NODE_CALLBACKS_NB; i++)
+	{
+		if(callbacks[i] != NULL)
+			callbacks[i]();
+	}
+}
+
+static void SIM_NODE_process_main(void)
+{
+	sim_radio.EVENTS_RSSIEND = 1;	//une mesure RSSI se termine immdiatement
+	SECRETARY_process_main();
+}
+
+static void SIM_NODE_send_probe(uint8_t size, uint8_t * datas)
+{
+#if OBJECT_ID != OBJECT_BASE_STATION
+	RF_DIALOG_send_msg_id_to_basestation(EVENT_OCCURED, size, datas);
+#endif
+}
+
+static void SIM_NODE_uart_rx(uint8_t size, uint8_t * datas)
+{
+	SECRETARY_process_msg_from_uart(size, datas);
+}
+
+static void SIM_NODE_bench_configure(esb_sim_bench_config_t const * config)
+{
+#if USE_RF_BENCH
+	rf_bench_config_t bench_config = {config->telemetry_period, config->telemetry_size, config->burst_period, config->burst_length, config->alert_period, config->poll_period};
+	RF_BENCH_configure(&bench_config);
+	RF_BENCH_reset_stats();
+#endif
+}
+
+static bool SIM_NODE_bench_report(uint8_t bench_class, esb_sim_bench_report_t * report)
+{
+#if USE_RF_BENCH
+	rf_bench_report_t bench_report;
+
+	if(bench_class >= RF_BENCH_CLASS_NB)
+		return false;
+	RF_BENCH_get_report(bench_class, &bench_report);
+	*report = (esb_sim_bench_report_t){bench_report.sent_nb, bench_report.received_nb, bench_report.lost_nb, bench_report.bytes_nb,
+		bench_report.latency_nb, bench_report.latency_avg, bench_report.latency_p50, bench_report.latency_p99, bench_report.latency_max};
+	return true;
+#else
+	return false;
+#endif
+}
+
+static bool SIM_NODE_secure_report(esb_sim_secure_report_t * report)
+{
+#if USE_RF_SECURE
+	rf_secure_stats_t stats;
+
+	RF_SECURE_get_stats(&stats);
+	*report = (esb_sim_secure_report_t){stats.sealed_nb, stats.opened_nb, stats.unsealed_nb, stats.replay_nb, stats.unknown_nb,
+		stats.mic_failed_nb, stats.ecb_blocks_nb};
+	return true;
+#else
+	return false;
+#endif
+}
+
+static bool SIM_NODE_timebase_report(esb_sim_timebase_report_t * report)
+{
+#if USE_TIMEBASE
+	timebase_stats_t stats;
+
+	TIMEBASE_get_stats(&stats);
+	*report = (esb_sim_timebase_report_t){TIMEBASE_get_time_us(), TIMEBASE_is_synchronized(), TIMEBASE_get_drift_ppb(), stats.samples_nb, stats.steps_nb};
+	return true;
+#else
+	return false;
+#endif
+}
+
+static const esb_sim_node_t sim_node =
+{
+	.object_id = OBJECT_ID,
+	.init = SIM_NODE_init,
+	.set_clock = SIM_NODE_set_clock,
+	.process_ms = SIM_NODE_process_ms,
+	.process_main = SIM_NODE_process_main,
+	.radio_listening = SIM_NODE_radio_listening,
+	.radio_rx = SIM_NODE_radio_rx,
+	.radio_tx_done = SIM_NODE_radio_tx_done,
+	.send_probe = SIM_NODE_send_probe,
+	.uart_rx = SIM_NODE_uart_rx,
+	.bench_configure = SIM_NODE_bench_configure,
+	.bench_report = SIM_NODE_bench_report,
+	.secure_report = SIM_NODE_secure_report,
+	.timebase_report = SIM_NODE_timebase_report,
+};
+
+SIM_NODE_EXPORT esb_sim_node_t const * ESB_SIM_NODE_entry(void)
+{
+	return &sim_node;
+}
@@ -0,0 +1,251 @@
+/*
+ * sniffer_decode.c
+ *
+ *  Created on: 17 oct. 2026
+ *
+ * Dcodeur (ct PC, Linux) des captures du firmware sniffer (SNIFFER_MODE, voir appli/common/sniffer.h).
+ *
+ * Compilation :	gcc -O2 -Wall -o sniffer_decode sniffer_decode.c
+ * Capture :		stty -F /dev/ttyUSB0 1000000 raw -echo && cat /dev/ttyUSB0 > capture.bin
+ * Utilisation :	sniffer_decode [-w capture.pcap] [capture.bin]		(entre standard par dfaut, pour dcoder en direct)
+ *
+ * Sans -w, chaque trame est affiche sur une ligne : instant, cart avec la trame prcdente, canal, pipe, RSSI,
+ * puis l'entte dcod (complet sur le pipe 0, compact sur les autres) et les datas.
+ * Avec -w, les trames sont crites dans un fichier pcap (LINKTYPE_USER0 = 147), chaque paquet tant prcd d'un pseudo-entte
+ * [FLAGS CHANNEL RSSI] ; le journal texte n'est alors pas affich. Les pertes signales par le sniffer sont toujours rapportes sur stderr.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+//doit rester identique  appli/common/sniffer.h et appli/common/rf_dialog.h
+#define SNIFFER_SYNC			0xA5
+#define SNIFFER_FLAG_DROPPED	0x80
+#define SNIFFER_PIPE_MASK		0x07
+#define ESB_MAX_PAYLOAD_LENGTH	32
+#define LINKTYPE_USER0			147
+
+#define FULL_HEADER_SIZE		11	//[RECIPIENT(4) EMITTER(4) MSG_CNT MSG_ID DATASIZE]
+#define COMPACT_HEADER_SIZE		5	//[RECIPIENT EMITTER MSG_CNT MSG_ID DATASIZE]
+#define DATASIZE_FLAG_ACK_REQUEST	0x80
+#define DATASIZE_MASK			0x1F
+
+typedef struct
+{
+	uint8_t flags;
+	uint8_t channel;
+	uint8_t rssi;
+	uint32_t time_us;
+	uint8_t length;
+	uint8_t data[ESB_MAX_PAYLOAD_LENGTH];
+}record_t;
+
+static const char * msg_id_name(uint8_t msg_id)
+{
+	switch(msg_id)
+	{
+		case 0x02:	return "RECENT_RESET";
+		case 0x03:	return "ASK_FOR_SOFTWARE_RESET";
+		case 0x16:	return "PING";
+		case 0x06:	return "PONG";
+		case 0x07:	return "ACK";
+		case 0x08:	return "BEACON";
+		case 0x09:	return "FRAGMENT";
+		case 0x0A:	return "SHORT_ADDRESS_ASK";
+		case 0x0B:	return "SHORT_ADDRESS_IS";
+		case 0x0C:	return "SHORT_ADDRESS_REVOKED";
+		case 0x0D:	return "CHANNEL_SET";
+		case 0x0E:	return "LINK_TX_POWER";
+		case 0x0F:	return "STATS_ASK";
+		case 0x10:	return "STATS_IS";
+		case 0x30:	return "EVENT_OCCURED";
+		case 0x31:	return "PACKED_MSGS";
+		case 0x40:	return "PARAMETER_IS";
+		case 0x41:	return "PARAMETER_ASK";
+		case 0x42:	return "PARAMETER_WRITE";
+		case 0xFD:	return "I_HAVE_NO_SERVER_ID";
+		case 0xFE:	return "YOUR_SERVER_ID_IS";
+		default:	return "?";
+	}
+}
+
+static uint32_t u32_from_be(const uint8_t * p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+//Lit l'enregistrement suivant, en se resynchronisant sur SNIFFER_SYNC aprs un octet perdu ou une somme fausse.
+//Renvoie 0 en fin de fichier.
+static int read_record(FILE * in, record_t * record, unsigned long * skipped)
+{
+	uint8_t header[8];	//FLAGS CHANNEL RSSI TIME_US(4) LENGTH
+	uint8_t checksum;
+	int c;
+
+	while((c = fgetc(in)) != EOF)
+	{
+		if(c != SNIFFER_SYNC)
+		{
+			(*skipped)++;
+			continue;
+		}
+		if(fread(header, 1, sizeof(header), in) != sizeof(header))
+			return 0;
+		record->flags = header[0];
+		record->channel = header[1];
+		record->rssi = header[2];
+		record->time_us = u32_from_be(&header[3]);
+		record->length = header[7];
+		if(record->length > ESB_MAX_PAYLOAD_LENGTH)
+		{
+			(*skipped) += 1 + sizeof(header);	//pas un dbut d'enregistrement
+			continue;
+		}
+		if(fread(record->data, 1, record->length, in) != record->length || (c = fgetc(in)) == EOF)
+			return 0;
+		checksum = 0;
+		for(size_t i = 0; i < sizeof(header); i++)
+			checksum ^= header[i];
+		for(uint8_t i = 0; i < record->length; i++)
+			checksum ^= record->data[i];
+		if(checksum != (uint8_t)c)
+		{
+			(*skipped) += 1 + sizeof(header) + record->length + 1;
+			continue;
+		}
+		return 1;
+	}
+	return 0;
+}
+
+static void print_record(const record_t * record, double time_s, double delta_ms)
+{
+	const uint8_t * d = record->data;
+	uint8_t pipe = record->flags & SNIFFER_PIPE_MASK;
+	uint8_t header_size = (pipe == 0)?FULL_HEADER_SIZE:COMPACT_HEADER_SIZE;
+	uint8_t datasize;
+
+	printf("%12.6f  +%9.3fms  ch%3u  pipe%u  %4ddBm  len%2u  ", time_s, delta_ms, record->channel, pipe, -(int)record->rssi, record->length);
+	if(record->length < header_size)
+		printf("(trame trop courte)");
+	else
+	{
+		if(pipe == 0)
+			printf("R:%08X E:%08X ", u32_from_be(&d[0]), u32_from_be(&d[4]));
+		else
+			printf("R:short %-4u E:short %-4u ", d[0], d[1]);
+		datasize = d[header_size-1];
+		printf("cnt:%3u %-22s%s size:%2u |", d[header_size-3], msg_id_name(d[header_size-2]), (datasize & DATASIZE_FLAG_ACK_REQUEST)?" ack":"    ", datasize & DATASIZE_MASK);
+		for(uint8_t i = header_size; i < record->length; i++)
+			printf(" %02X", d[i]);
+	}
+	printf("\n");
+}
+
+static void pcap_write_u32(FILE * out, uint32_t v)
+{
+	fwrite(&v, 4, 1, out);	//pcap : ordre des octets de la machine, indiqu par le nombre magique
+}
+
+static void pcap_write_header(FILE * out)
+{
+	uint16_t version[2] = {2, 4};
+	pcap_write_u32(out, 0xA1B2C3D4);
+	fwrite(version, 2, 2, out);
+	pcap_write_u32(out, 0);			//dcalage horaire
+	pcap_write_u32(out, 0);			//prcision
+	pcap_write_u32(out, 3 + ESB_MAX_PAYLOAD_LENGTH);	//snaplen
+	pcap_write_u32(out, LINKTYPE_USER0);
+}
+
+static void pcap_write_record(FILE * out, const record_t * record, uint64_t time_us)
+{
+	uint8_t pseudo_header[3] = {record->flags, record->channel, record->rssi};
+	pcap_write_u32(out, time_us / 1000000);
+	pcap_write_u32(out, time_us % 1000000);
+	pcap_write_u32(out, 3 + record->length);
+	pcap_write_u32(out, 3 + record->length);
+	fwrite(pseudo_header, 1, sizeof(pseudo_header), out);
+	fwrite(record->data, 1, record->length, out);
+}
+
+int main(int argc, char ** argv)
+{
+	FILE * in = stdin;
+	FILE * pcap = NULL;
+	record_t record;
+	unsigned long skipped = 0;
+	unsigned long frames_nb = 0;
+	unsigned long dropped_nb = 0;
+	uint64_t time_us = 0;			//instants drouls sur 64 bits (TIME_US reboucle toutes les 71 minutes)
+	uint64_t previous_time_us = 0;
+	uint32_t last_raw_time_us = 0;
+	int first = 1;
+	int opt;
+
+	while((opt = getopt(argc, argv, "w:")) != -1)
+	{
+		if(opt == 'w')
+		{
+			pcap = fopen(optarg, "wb");
+			if(pcap == NULL)
+			{
+				perror(optarg);
+				return 1;
+			}
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [-w capture.pcap] [capture.bin]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(optind < argc && strcmp(argv[optind], "-"))
+	{
+		in = fopen(argv[optind], "rb");
+		if(in == NULL)
+		{
+			perror(argv[optind]);
+			return 1;
+		}
+	}
+	if(pcap != NULL)
+		pcap_write_header(pcap);
+
+	while(read_record(in, &record, &skipped))
+	{
+		if(first)
+			time_us = record.time_us;
+		else
+			time_us += (uint32_t)(record.time_us - last_raw_time_us);
+		last_raw_time_us = record.time_us;
+
+		if(record.flags & SNIFFER_FLAG_DROPPED)
+		{
+			if(record.length == 4)
+			{
+				dropped_nb += u32_from_be(record.data);
+				fprintf(stderr, "%12.6f  %u trame(s) perdue(s) par le sniffer\n", time_us/1e6, u32_from_be(record.data));
+			}
+			continue;
+		}
+
+		frames_nb++;
+		if(pcap != NULL)
+			pcap_write_record(pcap, &record, time_us);
+		else
+		{
+			print_record(&record, time_us/1e6, first?0.0:(time_us - previous_time_us)/1e3);
+			fflush(stdout);
+		}
+		previous_time_us = time_us;
+		first = 0;
+	}
+
+	fprintf(stderr, "%lu trames, %lu perdues par le sniffer, %lu octets ignors\n", frames_nb, dropped_nb, skipped);
+	if(pcap != NULL)
+		fclose(pcap);
+	return 0;
+}